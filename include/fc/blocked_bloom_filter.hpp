@@ -0,0 +1,162 @@
+#pragma once
+#include <fc/bloom_filter.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw_fwd.hpp>
+#include <fc/reflect/typename.hpp>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/endian/conversion.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fc {
+
+   /**
+    *  @class blocked_bloom_filter
+    *  @brief a bloom filter that confines the probes of a key to one cache line
+    *
+    *  Every key is hashed once with city_hash_crc_128. One half of the hash selects a
+    *  64 byte block, the other half generates the bit positions of the k probes inside of
+    *  the block by (enhanced) double hashing. A lookup therefore costs one hash and one cache miss
+    *  instead of k of each, the probe bits are tested with SIMD where the CPU supports it.
+    *
+    *  For the same number of bits the false positive rate is somewhat higher than the one of
+    *  bloom_filter, because the keys are not spread evenly over the blocks; see effective_fpp().
+    */
+   class blocked_bloom_filter
+   {
+      public:
+         /** one cache line */
+         struct alignas(64) block
+         {
+            uint64_t words[8];
+         };
+         static constexpr uint32_t block_bits = sizeof(block) * 8;
+         /** leads the serialized form, incremented when the layout or the hashing changes */
+         static constexpr uint8_t  format_version = 1;
+
+         typedef std::vector<block, boost::alignment::aligned_allocator<block, sizeof(block)>> table_type;
+
+         blocked_bloom_filter();
+         /** uses the table size and hash count computed by p.compute_optimal_parameters() */
+         explicit blocked_bloom_filter( const bloom_parameters& p );
+
+         bool operator!()const { return blocks_.empty(); }
+         bool operator==( const blocked_bloom_filter& f )const;
+         bool operator!=( const blocked_bloom_filter& f )const { return !( *this == f ); }
+
+         void clear();
+
+         void insert( const char* data, size_t length );
+         bool contains( const char* data, size_t length )const;
+
+         template<typename T>
+         void insert( const T& t )
+         {
+            // Note: T must be a C++ POD type.
+            insert( reinterpret_cast<const char*>( &t ), sizeof(T) );
+         }
+         void insert( const std::string& key ) { insert( key.data(), key.size() ); }
+
+         template<typename T>
+         bool contains( const T& t )const
+         {
+            return contains( reinterpret_cast<const char*>( &t ), sizeof(T) );
+         }
+         bool contains( const std::string& key )const { return contains( key.data(), key.size() ); }
+
+         /** @return the number of bits in the table */
+         uint64_t size()const { return uint64_t( blocks_.size() ) * block_bits; }
+         uint64_t element_count()const { return inserted_element_count_; }
+         uint32_t hash_count()const { return hash_count_; }
+         /** the expected false positive probability for the current number of elements */
+         double   effective_fpp()const;
+
+         /** union and intersection, filters of different size or seed are left unchanged */
+         blocked_bloom_filter& operator|=( const blocked_bloom_filter& f );
+         blocked_bloom_filter& operator&=( const blocked_bloom_filter& f );
+
+         bool compatible( const blocked_bloom_filter& f )const
+         {
+            return hash_count_ == f.hash_count_ && random_seed_ == f.random_seed_
+                   && blocks_.size() == f.blocks_.size();
+         }
+
+      protected:
+         friend class concurrent_bloom_filter;
+
+         /** sets the probe bits of a key in mask and returns the index of its block */
+         static size_t compute_mask( const char* data, size_t length, uint64_t random_seed,
+                                     uint32_t hash_count, size_t blocks, block& mask );
+
+      public:
+         table_type             blocks_;
+         uint32_t               hash_count_;
+         uint64_t               projected_element_count_;
+         uint64_t               inserted_element_count_;
+         uint64_t               random_seed_;
+   };
+
+   namespace raw {
+
+      // the words of the blocks are stored little-endian, copied in bulk where that is the native order
+
+      template<typename Stream>
+      inline void pack( Stream& s, const blocked_bloom_filter& f, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+      {
+         FC_ASSERT( _max_depth > 0 );
+         --_max_depth;
+         const uint8_t version = blocked_bloom_filter::format_version;
+         fc::raw::pack( s, version, _max_depth );
+         fc::raw::pack( s, f.hash_count_, _max_depth );
+         fc::raw::pack( s, f.projected_element_count_, _max_depth );
+         fc::raw::pack( s, f.inserted_element_count_, _max_depth );
+         fc::raw::pack( s, f.random_seed_, _max_depth );
+         fc::raw::pack( s, unsigned_int( f.blocks_.size() ), _max_depth );
+         if( detail::native_is_little_endian::value )
+         {
+            if( !f.blocks_.empty() )
+               s.write( reinterpret_cast<const char*>( f.blocks_.data() ), f.blocks_.size() * sizeof(blocked_bloom_filter::block) );
+            return;
+         }
+         for( const auto& b : f.blocks_ )
+            for( uint64_t word : b.words )
+            {
+               boost::endian::native_to_little_inplace( word );
+               s.write( reinterpret_cast<const char*>( &word ), sizeof(word) );
+            }
+      }
+
+      template<typename Stream>
+      inline void unpack( Stream& s, blocked_bloom_filter& f, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+      {
+         FC_ASSERT( _max_depth > 0 );
+         --_max_depth;
+         uint8_t version;
+         fc::raw::unpack( s, version, _max_depth );
+         FC_ASSERT( version == blocked_bloom_filter::format_version,
+                    "Unsupported blocked_bloom_filter format ${v}", ("v",version) );
+         fc::raw::unpack( s, f.hash_count_, _max_depth );
+         fc::raw::unpack( s, f.projected_element_count_, _max_depth );
+         fc::raw::unpack( s, f.inserted_element_count_, _max_depth );
+         fc::raw::unpack( s, f.random_seed_, _max_depth );
+         unsigned_int blocks;
+         fc::raw::unpack( s, blocks, _max_depth );
+         FC_ASSERT( blocks.value < MAX_ARRAY_ALLOC_SIZE / sizeof(blocked_bloom_filter::block) );
+         FC_ASSERT( f.hash_count_ > 0 && f.hash_count_ <= blocked_bloom_filter::block_bits );
+         f.blocks_.resize( blocks.value );
+         if( !f.blocks_.empty() )
+            s.read( reinterpret_cast<char*>( f.blocks_.data() ), f.blocks_.size() * sizeof(blocked_bloom_filter::block) );
+         if( !detail::native_is_little_endian::value )
+            for( auto& b : f.blocks_ )
+               for( uint64_t& word : b.words )
+                  boost::endian::little_to_native_inplace( word );
+      }
+
+   } // namespace raw
+
+} // namespace fc
+
+FC_REFLECT_TYPENAME( fc::blocked_bloom_filter )
@@ -1,10 +1,91 @@
 #pragma once
 
+#include <fc/io/iostream.hpp>
+
+#include <memory>
 #include <string>
 
 namespace fc 
 {
 
+/** compression levels, as in zlib, the levels in between trade speed for size */
+enum zlib_level
+{
+  zlib_no_compression      = 0,
+  zlib_best_speed          = 1,
+  zlib_default_compression = 6,
+  zlib_best_compression    = 9
+};
+
 std::string zlib_compress(const std::string& in);
 
+/** @throws fc::exception if in is not a complete zlib stream */
+std::string zlib_decompress(const std::string& in);
+
+/**
+ *  Produces the same output as zlib_compress, but keeps the deflate state between calls
+ *  and writes into a buffer of the caller, so compressing does not allocate.
+ *  Not thread safe.
+ */
+class zlib_compressor
+{
+  public:
+    zlib_compressor();
+    ~zlib_compressor();
+
+    /** replaces the contents of out with the compressed in */
+    void compress( const char* in, size_t size, std::string& out, int level = zlib_default_compression );
+
+  private:
+    friend class deflate_ostream;
+    class impl;
+    std::unique_ptr<impl> my;
+};
+
+/**
+ *  Compresses the data written to it into a zlib stream, which is written to the
+ *  underlying stream as the compressor produces it. flush() ends the pending deflate
+ *  block, so that everything written so far can be decompressed; close() finishes the
+ *  zlib stream and closes the underlying stream.
+ *
+ *  The deflate state takes about 300KB, streams which are opened often should share
+ *  a zlib_compressor. It must not be used by anything else until the stream is closed.
+ */
+class deflate_ostream : public virtual ostream
+{
+  public:
+    deflate_ostream( ostream_ptr out, int level = zlib_default_compression,
+                     std::shared_ptr<zlib_compressor> context = std::shared_ptr<zlib_compressor>() );
+    /** finishes the zlib stream, if it has not been closed */
+    ~deflate_ostream();
+
+    virtual size_t writesome( const char* buf, size_t len );
+    virtual size_t writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset );
+    virtual void   close();
+    virtual void   flush();
+
+  private:
+    class impl;
+    std::unique_ptr<impl> my;
+};
+
+/**
+ *  Decompresses a zlib stream read from the underlying stream. Throws fc::eof_exception
+ *  at the end of the zlib stream, and fc::exception if the stream is corrupt or the
+ *  underlying stream ends before it.
+ */
+class inflate_istream : public virtual istream
+{
+  public:
+    inflate_istream( istream_ptr in );
+    ~inflate_istream();
+
+    virtual size_t readsome( char* buf, size_t len );
+    virtual size_t readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset );
+
+  private:
+    class impl;
+    std::unique_ptr<impl> my;
+};
+
 } // namespace fc
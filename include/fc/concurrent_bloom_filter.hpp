@@ -0,0 +1,90 @@
+#pragma once
+#include <fc/blocked_bloom_filter.hpp>
+
+#include <atomic>
+
+namespace fc {
+
+   /**
+    *  @class concurrent_bloom_filter
+    *  @brief a blocked_bloom_filter that many threads can insert into and query at once
+    *
+    *  Uses the table layout and hashing of blocked_bloom_filter, but stores the table in
+    *  atomic 64 bit words. insert() sets the probe bits with fetch_or and skips the words that
+    *  already have them, contains() only loads and is wait-free. Neither orders other memory:
+    *  a key inserted by one thread is found by another one once they synchronized otherwise,
+    *  e.g. by joining a task.
+    *
+    *  element_count() is approximate while inserts are running, the count is split over
+    *  several counters so that the inserting threads do not contend for a single cache line.
+    *  clear(), operator|= and operator&= must not run concurrently with insert().
+    */
+   class concurrent_bloom_filter
+   {
+      public:
+         explicit concurrent_bloom_filter( const bloom_parameters& p );
+         /** starts out with the contents of f */
+         explicit concurrent_bloom_filter( const blocked_bloom_filter& f );
+         ~concurrent_bloom_filter();
+
+         concurrent_bloom_filter( const concurrent_bloom_filter& ) = delete;
+         concurrent_bloom_filter& operator=( const concurrent_bloom_filter& ) = delete;
+
+         void clear();
+
+         void insert( const char* data, size_t length );
+         bool contains( const char* data, size_t length )const;
+
+         template<typename T>
+         void insert( const T& t )
+         {
+            // Note: T must be a C++ POD type.
+            insert( reinterpret_cast<const char*>( &t ), sizeof(T) );
+         }
+         void insert( const std::string& key ) { insert( key.data(), key.size() ); }
+
+         template<typename T>
+         bool contains( const T& t )const
+         {
+            return contains( reinterpret_cast<const char*>( &t ), sizeof(T) );
+         }
+         bool contains( const std::string& key )const { return contains( key.data(), key.size() ); }
+
+         uint64_t size()const { return uint64_t( blocks_ ) * blocked_bloom_filter::block_bits; }
+         uint64_t element_count()const;
+         uint32_t hash_count()const { return hash_count_; }
+
+         /** union and intersection with the semantics of blocked_bloom_filter */
+         concurrent_bloom_filter& operator|=( const blocked_bloom_filter& f );
+         concurrent_bloom_filter& operator|=( const concurrent_bloom_filter& f );
+         concurrent_bloom_filter& operator&=( const blocked_bloom_filter& f );
+
+         /** @return a copy of the current contents, e.g. for serialization */
+         blocked_bloom_filter snapshot()const;
+
+      private:
+         struct alignas(64) atomic_block
+         {
+            std::atomic<uint64_t> words[8];
+         };
+         struct alignas(64) counter
+         {
+            std::atomic<uint64_t> value;
+         };
+         static constexpr size_t counter_count = 16;
+
+         void init( size_t blocks );
+         bool compatible( const blocked_bloom_filter& f )const
+         {
+            return hash_count_ == f.hash_count_ && random_seed_ == f.random_seed_ && blocks_ == f.blocks_.size();
+         }
+
+         atomic_block*  table_;
+         size_t         blocks_;
+         uint32_t       hash_count_;
+         uint64_t       projected_element_count_;
+         uint64_t       random_seed_;
+         counter        inserted_[counter_count];
+   };
+
+} // namespace fc
@@ -3,8 +3,10 @@
 #include <fc/crypto/sha512.hpp>
 #include <fc/crypto/sha256.hpp>
 #include <fc/fwd.hpp>
+#include <fc/io/iostream.hpp>
 #include <fc/uint128.hpp>
 
+#include <memory>
 #include <vector>
 
 namespace fc {
@@ -51,10 +53,51 @@ namespace fc {
      * the file / key prior to decryption. 
      */
     void              aes_save( const fc::path& file, const fc::sha512& key, std::vector<char> plain_text );
+    /** like above, encrypts the contents of plain_text_file in chunks without loading it into memory */
+    void              aes_save( const fc::path& file, const fc::sha512& key, const fc::path& plain_text_file );
 
     /**
      *  recovers the plain_text saved via aes_save()
      */
     std::vector<char> aes_load( const fc::path& file, const fc::sha512& key );
+    /** like above, verifies and decrypts the file in chunks and writes the plain text to plain_text */
+    void              aes_load( const fc::path& file, const fc::sha512& key, fc::ostream& plain_text );
+
+    /**
+     *  Encrypts everything written to it like aes_encrypt( key, ... ) and passes the cipher text
+     *  on to sink, in chunks of constant size. close() writes the final, padded block and closes
+     *  the sink; flush() cannot flush an incomplete block. The destructor writes the final block
+     *  if the stream has not been closed, but leaves the sink open.
+     */
+    class aes_ostream : public virtual ostream
+    {
+       public:
+         aes_ostream( ostream_ptr sink, const fc::sha512& key );
+         ~aes_ostream();
+
+         virtual size_t writesome( const char* buf, size_t len ) override;
+         virtual size_t writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset ) override;
+         virtual void   close() override;
+         virtual void   flush() override;
+
+       private:
+         class impl;
+         std::unique_ptr<impl> my;
+    };
+
+    /** decrypts the cipher text read from source, see aes_ostream */
+    class aes_istream : public virtual istream
+    {
+       public:
+         aes_istream( istream_ptr source, const fc::sha512& key );
+         ~aes_istream();
+
+         virtual size_t readsome( char* buf, size_t len ) override;
+         virtual size_t readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset ) override;
+
+       private:
+         class impl;
+         std::unique_ptr<impl> my;
+    };
 
 } // namespace fc 
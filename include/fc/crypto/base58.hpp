@@ -5,6 +5,10 @@
 namespace fc {
     std::string to_base58( const char* d, size_t s );
     std::string to_base58( const std::vector<char>& data );
+    /**
+     *  @return the number of characters written
+     */
+    size_t to_base58( const char* d, size_t s, char* out_data, size_t out_data_len );
     std::vector<char> from_base58( const std::string& base58_str );
     size_t from_base58( const std::string& base58_str, char* out_data, size_t out_data_len );
 }
@@ -6,4 +6,22 @@ std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_
 inline std::string base64_encode(char const* bytes_to_encode, unsigned int in_len) { return base64_encode( (unsigned char const*)bytes_to_encode, in_len); }
 std::string base64_encode( const std::string& enc );
 std::string base64_decode( const std::string& encoded_string);
+
+/** @return the length of the padded base64 encoding of in_len bytes */
+inline size_t base64_encoded_size( size_t in_len ) { return ( in_len + 2 ) / 3 * 4; }
+/** @return an upper bound for the number of bytes decoded from in_len characters */
+inline size_t base64_decoded_max_size( size_t in_len ) { return in_len / 4 * 3 + ( in_len % 4 > 1 ? in_len % 4 - 1 : 0 ); }
+
+/**
+ *  Writes the padded base64 encoding of in to out, which must have room for
+ *  base64_encoded_size( in_len ) characters.
+ *  @return the number of characters written
+ */
+size_t base64_encode( const char* in, size_t in_len, char* out, size_t out_len );
+/**
+ *  Decodes in up to the first padding or non-base64 character, like base64_decode( const std::string& ).
+ *  out must have room for base64_decoded_max_size( in_len ) bytes.
+ *  @return the number of bytes written
+ */
+size_t base64_decode( const char* in, size_t in_len, char* out, size_t out_len );
 }  // namespace fc
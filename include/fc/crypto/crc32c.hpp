@@ -0,0 +1,16 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace fc {
+
+    /**
+     *  Computes the CRC-32C (Castagnoli) checksum of len bytes at data, using the SSE4.2 crc32
+     *  instruction when the CPU supports it.
+     *
+     *  Checksums can be computed incrementally: passing the result of a previous call as crc
+     *  continues it, i.e. crc32c( b, lb, crc32c( a, la ) ) is the checksum of a followed by b.
+     */
+    uint32_t crc32c( const char* data, size_t len, uint32_t crc = 0 );
+
+} // namespace fc
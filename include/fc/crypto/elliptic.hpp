@@ -6,8 +6,10 @@
 #include <fc/crypto/sha512.hpp>
 #include <fc/fwd.hpp>
 #include <fc/io/raw_fwd.hpp>
+#include <fc/uint128.hpp>
 
 #include <array>
+#include <cstring>
 
 namespace fc {
 
@@ -40,6 +42,8 @@ namespace fc {
            ~public_key();
            public_key_data serialize()const;
            public_key_point_data serialize_ecc_point()const;
+           /** @return the stored compressed key without copying it, all zero for an invalid key */
+           const public_key_data& key_data()const;
 
            operator public_key_data()const { return serialize(); }
 
@@ -59,13 +63,11 @@ namespace fc {
            public_key& operator=( public_key&& pk );
            public_key& operator=( const public_key& pk );
 
-           inline friend bool operator==( const public_key& a, const public_key& b )
-           {
-            return a.serialize() == b.serialize();
-           }
+           /** compares in constant time */
+           friend bool operator==( const public_key& a, const public_key& b );
            inline friend bool operator!=( const public_key& a, const public_key& b )
            {
-            return a.serialize() != b.serialize();
+            return !( a == b );
            }
 
            /// Allows to convert current public key object into base58 number.
@@ -82,6 +84,69 @@ namespace fc {
           fc::fwd<detail::public_key_impl,33> my;
     };
 
+    /** compares two keys in time independent of their contents */
+    inline bool equal_key_data( const public_key_data& a, const public_key_data& b )
+    {
+       unsigned char diff = 0;
+       for( size_t i = 0; i < a.size(); ++i )
+          diff |= a[i] ^ b[i];
+       return diff == 0;
+    }
+
+    inline bool operator==( const public_key& a, const public_key& b )
+    {
+       return equal_key_data( a.key_data(), b.key_data() );
+    }
+
+    /**
+     *  Hashes the stored bytes of compressed keys. The hash is keyed with a random secret of
+     *  the process, so that nobody can create keys that collide in hash containers.
+     */
+    struct public_key_hash
+    {
+       typedef void is_transparent;
+
+       public_key_hash();
+
+       size_t operator()( const public_key_data& k )const
+       {
+          uint64_t w[4];
+          memcpy( w, k.data() + 1, sizeof(w) );
+          const uint128_t lo = uint128_t( w[0] ^ seed[0] ) * ( w[1] ^ seed[1] );
+          const uint128_t hi = uint128_t( w[2] ^ seed[2] ) * ( w[3] ^ seed[3] );
+          return size_t( ( uint128_lo64( lo ) ^ uint128_hi64( lo ) ^ uint128_lo64( hi ) ^ uint128_hi64( hi ) )
+                         + k[0] * 0x9e3779b97f4a7c15ull );
+       }
+       size_t operator()( const public_key& k )const { return (*this)( k.key_data() ); }
+
+       uint64_t seed[4];
+    };
+
+    /** equality of public_key and public_key_data, e.g. for heterogeneous lookups */
+    struct public_key_equal
+    {
+       typedef void is_transparent;
+
+       template<typename A, typename B>
+       bool operator()( const A& a, const B& b )const { return equal_key_data( data( a ), data( b ) ); }
+
+       static const public_key_data& data( const public_key_data& k ) { return k; }
+       static const public_key_data& data( const public_key& k ) { return k.key_data(); }
+    };
+
+    /** orders public_key and public_key_data by their bytes, e.g. in std::map<public_key,...,public_key_less> */
+    struct public_key_less
+    {
+       typedef void is_transparent;
+
+       template<typename A, typename B>
+       bool operator()( const A& a, const B& b )const
+       {
+          return memcmp( public_key_equal::data( a ).data(), public_key_equal::data( b ).data(),
+                         sizeof(public_key_data) ) < 0;
+       }
+    };
+
     /**
      *  @class private_key
      *  @brief an elliptic curve private key.
@@ -152,6 +217,11 @@ namespace fc {
 
             extended_public_key derive_child( int i ) const;
             extended_public_key derive_normal_child( int i ) const;
+            /**
+             *  Derives the children first ... first + count - 1 like derive_normal_child, sharing
+             *  the HMAC key schedule and the parsed parent key between them.
+             */
+            std::vector<extended_public_key> derive_children( int first, uint32_t count ) const;
 
             extended_key_data serialize_extended() const;
             static extended_public_key deserialize( const extended_key_data& data );
@@ -271,6 +341,16 @@ namespace fc {
   } // namespace raw
 
 } // namespace fc
+namespace std
+{
+    template<>
+    struct hash<fc::ecc::public_key>
+    {
+       size_t operator()( const fc::ecc::public_key& k )const { return h( k ); }
+       fc::ecc::public_key_hash h;
+    };
+}
+
 #include <fc/reflect/reflect.hpp>
 
 FC_REFLECT_TYPENAME( fc::ecc::private_key )
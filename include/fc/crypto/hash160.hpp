@@ -102,6 +102,8 @@ namespace raw {
       ds >> ep;
    }
 
+   template<> struct is_trivially_packable<hash160> : std::true_type {};
+
 }
 
    class variant;
@@ -8,8 +8,16 @@ namespace fc {
     std::string to_hex( const char* d, uint32_t s );
     std::string to_hex( const std::vector<char>& data );
 
+    /**
+     *  Writes the lower case hex encoding of the s bytes at d to out_data, which must have
+     *  room for 2*s characters.
+     *  @return the number of characters written
+     */
+    size_t to_hex( const char* d, size_t s, char* out_data, size_t out_data_len );
+
     /**
      *  @return the number of bytes decoded
      */
     size_t from_hex( const std::string& hex_str, char* out_data, size_t out_data_len );
+    size_t from_hex( const char* hex_str, size_t hex_len, char* out_data, size_t out_data_len );
 } 
@@ -0,0 +1,221 @@
+#pragma once
+#include <fc/crypto/elliptic.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <memory>
+#include <utility>
+
+namespace fc {
+
+   /**
+    *  @class key_map
+    *  @brief a hash map from compressed public keys to V for millions of entries
+    *
+    *  Open addressing with linear probing. Every slot has a control byte, which is zero for
+    *  free slots and otherwise holds 7 bits of the hash of its key, so most probes only touch
+    *  the densely packed control bytes and compare a key only when these match. Control
+    *  bytes, keys and values are kept in separate arrays, so that keys take 33 bytes without
+    *  padding. Erasing shifts the following entries of the probe sequence back, so that there
+    *  are no tombstones and lookups do not degrade after many erases.
+    *
+    *  The table grows by doubling when it is 7/8 full. Pointers to values are invalidated by
+    *  inserts that grow the table and by erase(). V must be default constructible and movable.
+    */
+   template<typename V>
+   class key_map
+   {
+      public:
+         typedef ecc::public_key_data key_type;
+         typedef V                    mapped_type;
+
+         explicit key_map( size_t expected_size = 0 ) { reserve( expected_size ); }
+
+         key_map( key_map&& m )
+            : hasher_( m.hasher_ ), control_( std::move( m.control_ ) ), keys_( std::move( m.keys_ ) ),
+              values_( std::move( m.values_ ) ), mask_( m.mask_ ), size_( m.size_ )
+         {
+            m.mask_ = 0;
+            m.size_ = 0;
+         }
+         key_map& operator=( key_map&& m )
+         {
+            if( this != &m )
+            {
+               hasher_  = m.hasher_;
+               control_ = std::move( m.control_ );
+               keys_    = std::move( m.keys_ );
+               values_  = std::move( m.values_ );
+               mask_    = m.mask_;
+               size_    = m.size_;
+               m.mask_  = 0;
+               m.size_  = 0;
+            }
+            return *this;
+         }
+
+         size_t size()const     { return size_; }
+         bool   empty()const    { return size_ == 0; }
+         /** @return the number of slots */
+         size_t capacity()const { return mask_ ? mask_ + 1 : 0; }
+
+         /** makes room for n entries without further growing */
+         void reserve( size_t n )
+         {
+            size_t slots = 16;
+            while( slots - slots / 8 < n )
+               slots *= 2;
+            if( slots > capacity() )
+               rehash( slots );
+         }
+
+         void clear()
+         {
+            for( size_t i = 0; i < capacity(); ++i )
+               if( control_[i] )
+               {
+                  control_[i] = 0;
+                  values_[i] = V();
+               }
+            size_ = 0;
+         }
+
+         V* find( const key_type& k )
+         {
+            if( !size_ )
+               return nullptr;
+            const size_t i = find_slot( k, hasher_( k ) );
+            return control_[i] ? &values_[i] : nullptr;
+         }
+         const V* find( const key_type& k )const { return const_cast<key_map*>( this )->find( k ); }
+         V*       find( const ecc::public_key& k )       { return find( k.key_data() ); }
+         const V* find( const ecc::public_key& k )const { return find( k.key_data() ); }
+
+         bool contains( const key_type& k )const { return find( k ) != nullptr; }
+         bool contains( const ecc::public_key& k )const { return find( k.key_data() ) != nullptr; }
+
+         V& at( const key_type& k )
+         {
+            V* v = find( k );
+            FC_ASSERT( v != nullptr, "Key not found" );
+            return *v;
+         }
+         const V& at( const key_type& k )const { return const_cast<key_map*>( this )->at( k ); }
+
+         /**
+          *  Inserts v unless k is present already.
+          *  @return the value stored for k and whether it was inserted
+          */
+         std::pair<V*, bool> insert( const key_type& k, V v )
+         {
+            if( size_ + 1 > capacity() - capacity() / 8 )
+               rehash( capacity() ? capacity() * 2 : 16 );
+            const size_t h = hasher_( k );
+            const size_t i = find_slot( k, h );
+            if( control_[i] )
+               return std::make_pair( &values_[i], false );
+            control_[i] = tag( h );
+            keys_[i] = k;
+            values_[i] = std::move( v );
+            ++size_;
+            return std::make_pair( &values_[i], true );
+         }
+         std::pair<V*, bool> insert( const ecc::public_key& k, V v ) { return insert( k.key_data(), std::move( v ) ); }
+
+         /** inserts a default constructed value if k is not present */
+         V& operator[]( const key_type& k ) { return *insert( k, V() ).first; }
+         V& operator[]( const ecc::public_key& k ) { return (*this)[ k.key_data() ]; }
+
+         /** @return true if k was present */
+         bool erase( const key_type& k )
+         {
+            if( !size_ )
+               return false;
+            size_t hole = find_slot( k, hasher_( k ) );
+            if( !control_[hole] )
+               return false;
+            // move back the entries that would not be found behind the hole anymore
+            for( size_t i = ( hole + 1 ) & mask_; control_[i]; i = ( i + 1 ) & mask_ )
+            {
+               const size_t home = hasher_( keys_[i] ) & mask_;
+               if( ( ( i - home ) & mask_ ) >= ( ( i - hole ) & mask_ ) )
+               {
+                  control_[hole] = control_[i];
+                  keys_[hole] = keys_[i];
+                  values_[hole] = std::move( values_[i] );
+                  hole = i;
+               }
+            }
+            control_[hole] = 0;
+            values_[hole] = V();
+            --size_;
+            return true;
+         }
+         bool erase( const ecc::public_key& k ) { return erase( k.key_data() ); }
+
+         /** calls f( const key_type&, V& ) for every entry, in no particular order */
+         template<typename F>
+         void for_each( F&& f )
+         {
+            for( size_t i = 0; i < capacity(); ++i )
+               if( control_[i] )
+                  f( const_cast<const key_type&>( keys_[i] ), values_[i] );
+         }
+         template<typename F>
+         void for_each( F&& f )const
+         {
+            for( size_t i = 0; i < capacity(); ++i )
+               if( control_[i] )
+                  f( keys_[i], values_[i] );
+         }
+
+         /** @return the bytes allocated for the table */
+         size_t memory_usage()const { return capacity() * ( sizeof(uint8_t) + sizeof(key_type) + sizeof(V) ); }
+
+      private:
+
+         static uint8_t tag( size_t h ) { return uint8_t( 0x80 | ( h >> ( sizeof(size_t) * 8 - 7 ) ) ); }
+
+         /** @return the slot holding k, or the free slot where it belongs */
+         size_t find_slot( const key_type& k, size_t h )const
+         {
+            const uint8_t t = tag( h );
+            for( size_t i = h & mask_; ; i = ( i + 1 ) & mask_ )
+            {
+               const uint8_t c = control_[i];
+               if( !c || ( c == t && ecc::equal_key_data( keys_[i], k ) ) )
+                  return i;
+            }
+         }
+
+         void rehash( size_t slots )
+         {
+            std::unique_ptr<uint8_t[]>  old_control = std::move( control_ );
+            std::unique_ptr<key_type[]> old_keys    = std::move( keys_ );
+            std::unique_ptr<V[]>        old_values  = std::move( values_ );
+            const size_t old_capacity = capacity();
+
+            control_.reset( new uint8_t[slots]() );
+            keys_.reset( new key_type[slots] );
+            values_.reset( new V[slots] );
+            mask_ = slots - 1;
+            for( size_t i = 0; i < old_capacity; ++i )
+               if( old_control[i] )
+               {
+                  size_t j = hasher_( old_keys[i] ) & mask_;
+                  while( control_[j] )
+                     j = ( j + 1 ) & mask_;
+                  control_[j] = old_control[i];
+                  keys_[j]    = old_keys[i];
+                  values_[j]  = std::move( old_values[i] );
+               }
+         }
+
+         ecc::public_key_hash         hasher_;
+         std::unique_ptr<uint8_t[]>   control_;
+         std::unique_ptr<key_type[]>  keys_;
+         std::unique_ptr<V[]>         values_;
+         size_t                       mask_ = 0;
+         size_t                       size_ = 0;
+   };
+
+} // namespace fc
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <cstddef>
+
 namespace fc {
 
-  /* provides access to the OpenSSL random number generator */
+  /**
+   *  Fills buf with cryptographically secure random bytes from a per-thread ChaCha20
+   *  generator, which is seeded from the OpenSSL random number generator. Unlike calls to
+   *  OpenSSL these do not contend for a global lock.
+   */
   void rand_bytes(char* buf, int count);
-} // namespace fc 
+  /** like rand_bytes, writes the key stream directly into buf, for large buffers */
+  void rand_fill(char* buf, size_t count);
+  /** provides direct access to the OpenSSL random number generator */
+  void rand_system_bytes(char* buf, int count);
+} // namespace fc
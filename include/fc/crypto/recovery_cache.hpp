@@ -0,0 +1,56 @@
+#pragma once
+#include <fc/crypto/elliptic.hpp>
+
+#include <memory>
+
+namespace fc { namespace ecc {
+
+   /**
+    *  @class recovery_cache
+    *  @brief remembers public keys recovered from compact signatures
+    *
+    *  Maps ( digest, compact_signature ) to the public key that
+    *  public_key( const compact_signature&, const fc::sha256&, bool ) recovered for it, so that
+    *  transactions which are verified again (mempool, block production, block application, fork
+    *  switches) skip the elliptic curve math.
+    *
+    *  The cache is opt-in: it is consulted only after it has been install()ed. It holds at most
+    *  the given number of entries in independently locked shards, each evicting with the CLOCK
+    *  algorithm. Entries are placed by a hash salted with a random secret, so that nobody can
+    *  craft signatures that collide in the cache, and lookups compare the full key. Only
+    *  successful recoveries are cached.
+    */
+   class recovery_cache
+   {
+      public:
+         struct stats
+         {
+            uint64_t hits      = 0;
+            uint64_t misses    = 0;
+            uint64_t evictions = 0;
+            uint64_t size      = 0;
+         };
+
+         recovery_cache( size_t capacity, size_t shards = 16 );
+         ~recovery_cache();
+
+         recovery_cache( const recovery_cache& ) = delete;
+         recovery_cache& operator=( const recovery_cache& ) = delete;
+
+         /** @return true and sets key if the recovered key for ( digest, sig ) is known */
+         bool  get( const fc::sha256& digest, const compact_signature& sig, public_key_data& key );
+         void  put( const fc::sha256& digest, const compact_signature& sig, const public_key_data& key );
+         void  clear();
+
+         stats get_stats()const;
+
+         /** Makes public key recovery use cache, nullptr disables caching */
+         static void install( std::shared_ptr<recovery_cache> cache );
+         static std::shared_ptr<recovery_cache> installed();
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+
+} } // fc::ecc
@@ -83,6 +83,8 @@ namespace raw {
       ds >> ep;
    }
 
+   template<> struct is_trivially_packable<ripemd160> : std::true_type {};
+
 }
 
   class variant;
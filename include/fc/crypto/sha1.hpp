@@ -1,6 +1,7 @@
 #pragma once
 #include <boost/endian/buffers.hpp>
 #include <fc/fwd.hpp>
+#include <fc/io/raw_fwd.hpp>
 
 #include <functional>
 #include <string>
@@ -80,6 +81,8 @@ namespace raw {
       ds >> ep;
    }
 
+   template<> struct is_trivially_packable<sha1> : std::true_type {};
+
 }
 
   class variant;
@@ -35,6 +35,10 @@ class sha512
         encoder();
         ~encoder();
 
+        /** copies the hash state, e.g. to hash several messages with a common prefix */
+        encoder( const encoder& e );
+        encoder& operator=( const encoder& e );
+
         void write( const char* d, uint32_t dlen );
         void put( char c ) { write( &c, 1 ); }
         void reset();
@@ -79,6 +83,8 @@ namespace raw {
       ds >> ep;
    }
 
+   template<> struct is_trivially_packable<sha512> : std::true_type {};
+
 }
 
   typedef fc::sha512 uint512;
@@ -356,7 +356,7 @@ namespace fc
 
 #define FC_CAPTURE_AND_THROW( EXCEPTION_TYPE, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-    throw EXCEPTION_TYPE( FC_LOG_MESSAGE( error, "", FC_FORMAT_ARG_PARAMS(__VA_ARGS__) ) ); \
+    throw EXCEPTION_TYPE( FC_LAZY_LOG_MESSAGE( error, "", FC_CAPTURE_ARG_PARAMS(__VA_ARGS__) ) ); \
   FC_MULTILINE_MACRO_END
 
 //#define FC_THROW( FORMAT, ... )
@@ -365,11 +365,11 @@ namespace fc
 #define FC_INDIRECT_EXPAND(MACRO, ARGS) MACRO ARGS
 #define FC_THROW(  ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-    throw fc::exception( FC_INDIRECT_EXPAND(FC_LOG_MESSAGE, ( error, __VA_ARGS__ )) );  \
+    throw fc::exception( FC_INDIRECT_EXPAND(FC_LAZY_LOG_MESSAGE, ( error, __VA_ARGS__ )) );  \
   FC_MULTILINE_MACRO_END
 
 #define FC_EXCEPTION( EXCEPTION_TYPE, FORMAT, ... ) \
-    EXCEPTION_TYPE( FC_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) )
+    EXCEPTION_TYPE( FC_LAZY_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) )
 /**
  *  @def FC_THROW_EXCEPTION( EXCEPTION, FORMAT, ... )
  *  @param EXCEPTION a class in the Phoenix::Athena::API namespace that inherits
@@ -378,7 +378,7 @@ namespace fc
  */
 #define FC_THROW_EXCEPTION( EXCEPTION, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-    throw EXCEPTION( FC_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) ); \
+    throw EXCEPTION( FC_LAZY_LOG_MESSAGE( error, FORMAT, __VA_ARGS__ ) ); \
   FC_MULTILINE_MACRO_END
 
 
@@ -388,7 +388,7 @@ namespace fc
  */
 #define FC_RETHROW_EXCEPTION( ER, LOG_LEVEL, FORMAT, ... ) \
   FC_MULTILINE_MACRO_BEGIN \
-    ER.append_log( FC_LOG_MESSAGE( LOG_LEVEL, FORMAT, __VA_ARGS__ ) ); \
+    ER.append_log( FC_LAZY_LOG_MESSAGE( LOG_LEVEL, FORMAT, __VA_ARGS__ ) ); \
     throw; \
   FC_MULTILINE_MACRO_END
 
@@ -466,28 +466,28 @@ namespace fc
       FC_RETHROW_EXCEPTION( er, LOG_LEVEL, FORMAT, __VA_ARGS__ ); \
    } catch( const std::exception& e ) {  \
       throw fc::exception( \
-                FC_LOG_MESSAGE( LOG_LEVEL, "${what}: " FORMAT,__VA_ARGS__("what",e.what())), \
+                FC_LAZY_LOG_MESSAGE( LOG_LEVEL, "${what}: " FORMAT,__VA_ARGS__("what",e.what())), \
                 fc::std_exception_code,\
                 typeid(e).name(), \
                 e.what() ) ;\
    } catch( ... ) {  \
       throw fc::unhandled_exception( \
-                FC_LOG_MESSAGE( LOG_LEVEL, FORMAT,__VA_ARGS__), \
+                FC_LAZY_LOG_MESSAGE( LOG_LEVEL, FORMAT,__VA_ARGS__), \
                 std::current_exception() ); \
    }
 
 #define FC_CAPTURE_AND_RETHROW( ... ) \
    catch( fc::exception& er ) { \
-      FC_RETHROW_EXCEPTION( er, warn, "", FC_FORMAT_ARG_PARAMS(__VA_ARGS__) ); \
+      FC_RETHROW_EXCEPTION( er, warn, "", FC_CAPTURE_ARG_PARAMS(__VA_ARGS__) ); \
    } catch( const std::exception& e ) {  \
       throw fc::exception( \
-                FC_LOG_MESSAGE( warn, "${what}: ",FC_FORMAT_ARG_PARAMS(__VA_ARGS__)("what",e.what())), \
+                FC_LAZY_LOG_MESSAGE( warn, "${what}: ",FC_CAPTURE_ARG_PARAMS(__VA_ARGS__)("what",e.what())), \
                 fc::std_exception_code,\
                 typeid(e).name(), \
                 e.what() ) ;\
    } catch( ... ) {  \
       throw fc::unhandled_exception( \
-                FC_LOG_MESSAGE( warn, "",FC_FORMAT_ARG_PARAMS(__VA_ARGS__)), \
+                FC_LAZY_LOG_MESSAGE( warn, "",FC_CAPTURE_ARG_PARAMS(__VA_ARGS__)), \
                 std::current_exception() ); \
    }
 
@@ -0,0 +1,143 @@
+#pragma once
+#include <fc/filesystem.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/io/raw.hpp>
+
+#include <iterator>
+#include <memory>
+
+namespace fc {
+
+  /**
+   *  Untyped storage behind mapped_log<T>: an append-only sequence of byte records kept in
+   *  fixed-size, memory-mapped segment files inside one directory.
+   *
+   *  Every record starts with an 8 byte header, the little-endian payload length followed by a
+   *  CRC32C over length and payload. Records never span segments, a new segment is started when
+   *  the next record does not fit into the current one. When the log is opened all segments are
+   *  scanned and an in-memory offset index is built, so that random reads are O(1). Everything
+   *  from the first damaged record onwards is discarded, which recovers from a crash during an
+   *  append.
+   *
+   *  Record views point directly into the mapped files and stay valid until the log is closed.
+   *  The class is not thread safe.
+   */
+  class mapped_log_base {
+    public:
+      /** A record payload inside the mapped file */
+      struct record_view {
+        const char* data;
+        uint32_t    size;
+      };
+
+      class const_iterator {
+        public:
+          typedef std::forward_iterator_tag iterator_category;
+          typedef record_view               value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef const record_view*        pointer;
+          typedef record_view               reference;
+
+          const_iterator( const mapped_log_base* log, uint64_t index ) : _log(log), _index(index) {}
+
+          record_view     operator*()const { return _log->view( _index ); }
+          uint64_t        index()const     { return _index; }
+          const_iterator& operator++()     { ++_index; return *this; }
+          const_iterator  operator++(int)  { const_iterator tmp(*this); ++_index; return tmp; }
+
+          friend bool operator==( const const_iterator& a, const const_iterator& b ) { return a._index == b._index; }
+          friend bool operator!=( const const_iterator& a, const const_iterator& b ) { return a._index != b._index; }
+        private:
+          const mapped_log_base* _log;
+          uint64_t               _index;
+      };
+
+      static constexpr uint32_t header_size = 8;
+      static constexpr uint32_t default_segment_size = 64 * 1024 * 1024;
+
+      /**
+       *  Opens the log stored in dir, creating the directory if necessary, and recovers from
+       *  damaged records. Newly created segments will be segment_size bytes long.
+       *
+       *  With read_only, the log must exist and is never modified, so that it can be read while
+       *  another process appends to it. The log then ends before the first invalid record, which
+       *  may be one the writer has not committed yet, and nothing can be appended.
+       */
+      mapped_log_base( const fc::path& dir, uint32_t segment_size = default_segment_size, mode_t mode = read_write );
+      ~mapped_log_base();
+
+      mapped_log_base( const mapped_log_base& ) = delete;
+      mapped_log_base& operator=( const mapped_log_base& ) = delete;
+
+      /** @return the number of records in the log */
+      uint64_t size()const;
+      bool     empty()const { return size() == 0; }
+
+      record_view view( uint64_t index )const;
+
+      const_iterator begin()const { return const_iterator( this, 0 ); }
+      const_iterator end()const   { return const_iterator( this, size() ); }
+
+      /**
+       *  Reserves space for a payload of size bytes and returns where to write it. The record
+       *  becomes part of the log when commit() is called; calling prepare() again without
+       *  commit() abandons it.
+       */
+      char*    prepare( uint32_t size );
+      /** Seals the prepared record and returns its index */
+      uint64_t commit();
+
+      uint64_t append( const char* data, uint32_t size );
+
+      /** Writes all modified pages back to disk */
+      void     flush();
+
+      /**
+       *  @return true if damaged records were discarded when the log was opened, or in read_only
+       *  mode, if invalid data follows the last record
+       */
+      bool     recovered()const;
+
+    private:
+      class impl;
+      std::unique_ptr<impl> my;
+  };
+
+  /**
+   *  Append-only log of raw-packed T records on top of mapped_log_base, see there for the
+   *  storage format and recovery rules. Records are packed directly into the mapped file.
+   */
+  template<typename T>
+  class mapped_log : public mapped_log_base {
+    public:
+      using mapped_log_base::mapped_log_base;
+      using mapped_log_base::append;
+
+      uint64_t append( const T& v ) {
+        const size_t size = fc::raw::pack_size( v );
+        FC_ASSERT( size <= UINT32_MAX, "Record is too large" );
+        datastream<char*> ds( prepare( size ), size );
+        fc::raw::pack( ds, v );
+        return commit();
+      }
+
+      T at( uint64_t index )const {
+        const record_view r = view( index );
+        return fc::raw::unpack<T>( r.data, r.size );
+      }
+
+      /** Calls visitor( index, const T& ) for every record in order */
+      template<typename Visitor>
+      void visit( Visitor&& visitor )const {
+        for( auto itr = begin(); itr != end(); ++itr ) {
+          const record_view r = *itr;
+          T tmp;
+          datastream<const char*> ds( r.data, r.size );
+          fc::raw::unpack( ds, tmp );
+          visitor( itr.index(), tmp );
+        }
+      }
+  };
+
+}
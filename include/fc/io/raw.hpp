@@ -192,26 +192,57 @@ namespace fc {
        v = std::make_shared<const T>(std::move(tmp));
     } FC_RETHROW_EXCEPTIONS( warn, "std::shared_ptr<const T>", ("type",fc::get_typename<T>::name()) ) }
 
+    namespace detail {
+
+      template<typename Stream>
+      inline void pack_unsigned_int( Stream& s, const unsigned_int& v ) {
+        char buf[fc::detail::max_packed_unsigned_int_size];
+        s.write( buf, fc::detail::encode_unsigned_int( v.value, buf ) );
+      }
+
+      // in-memory output is encoded in place when there is room for the longest form
+      inline void pack_unsigned_int( datastream<char*>& s, const unsigned_int& v ) {
+        if( s.remaining() >= fc::detail::max_packed_unsigned_int_size )
+           s.skip( fc::detail::encode_unsigned_int( v.value, s.pos() ) );
+        else
+           pack_unsigned_int<datastream<char*>>( s, v );
+      }
+
+      template<typename Stream>
+      inline void unpack_unsigned_int( Stream& s, unsigned_int& vi ) {
+        uint64_t v = 0; char b = 0; uint8_t by = 0;
+        do {
+            s.get(b);
+            if( by >= 64 || (by == 63 && uint8_t(b) > 1) )
+               FC_THROW_EXCEPTION( overflow_exception, "Invalid packed unsigned_int!" );
+            v |= uint64_t(uint8_t(b) & 0x7f) << by;
+            by += 7;
+        } while( uint8_t(b) & 0x80 );
+        vi.value = static_cast<uint64_t>(v);
+      }
+
+      // in-memory input can use the word-at-a-time decoder as long as 8 bytes remain
+      inline void unpack_unsigned_int( datastream<const char*>& s, unsigned_int& vi ) {
+        if( s.remaining() >= 8 )
+        {
+           const size_t len = fc::detail::decode_unsigned_int( s.pos(), vi.value );
+           if( len )
+           {
+              s.skip( len );
+              return;
+           }
+        }
+        unpack_unsigned_int<datastream<const char*>>( s, vi );
+      }
+
+    } // namespace detail
+
     template<typename Stream> inline void pack( Stream& s, const unsigned_int& v, uint32_t _max_depth ) {
-      uint64_t val = v.value;
-      do {
-        uint8_t b = uint8_t(val) & 0x7f;
-        val >>= 7;
-        b |= ((val > 0) << 7);
-        s.write((char*)&b,1);//.put(b);
-      }while( val );
+      detail::pack_unsigned_int( s, v );
     }
 
     template<typename Stream> inline void unpack( Stream& s, unsigned_int& vi, uint32_t _max_depth ) {
-      uint64_t v = 0; char b = 0; uint8_t by = 0;
-      do {
-          s.get(b);
-          if( by >= 64 || (by == 63 && uint8_t(b) > 1) )
-             FC_THROW_EXCEPTION( overflow_exception, "Invalid packed unsigned_int!" );
-          v |= uint64_t(uint8_t(b) & 0x7f) << by;
-          by += 7;
-      } while( uint8_t(b) & 0x80 );
-      vi.value = static_cast<uint64_t>(v);
+      detail::unpack_unsigned_int( s, vi );
     }
 
     template<typename Stream, typename T> inline void unpack( Stream& s, const T& vi, uint32_t _max_depth )
@@ -674,17 +705,84 @@ namespace fc {
        }
     }
 
+    namespace detail {
+
+      template<typename Stream, typename T>
+      inline void pack_vector_elements( Stream& s, const std::vector<T>& value, uint32_t _max_depth,
+                                        std::false_type )
+      {
+         auto itr = value.begin();
+         auto end = value.end();
+         while( itr != end ) {
+            fc::raw::pack( s, *itr, _max_depth );
+            ++itr;
+         }
+      }
+
+      template<typename Stream, typename T>
+      inline void pack_vector_elements( Stream& s, const std::vector<T>& value, uint32_t _max_depth,
+                                        std::true_type )
+      {
+         if( value.size() )
+            s.write( (const char*)value.data(), value.size() * sizeof(T) );
+      }
+
+      template<typename Stream, typename T>
+      inline void unpack_vector_elements( Stream& s, std::vector<T>& value, uint64_t size, uint32_t _max_depth,
+                                          std::false_type )
+      {
+         value.resize( std::min( size, static_cast<uint64_t>(FC_MAX_PREALLOC_SIZE) ) );
+         for( uint64_t i = 0; i < size; i++ )
+         {
+            if( i >= value.size() )
+               value.resize( std::min( static_cast<uint64_t>(2*value.size()), size ) );
+            fc::raw::unpack( s, value[i], _max_depth );
+         }
+      }
+
+      template<typename Stream, typename T>
+      inline void unpack_vector_elements( Stream& s, std::vector<T>& value, uint64_t size, uint32_t _max_depth,
+                                          std::true_type )
+      {
+         // grow in steps like the element-wise version, so that a bogus size cannot force a huge allocation
+         value.resize( std::min( size, static_cast<uint64_t>(FC_MAX_PREALLOC_SIZE) ) );
+         uint64_t done = 0;
+         while( done < size )
+         {
+            if( done >= value.size() )
+               value.resize( std::min( static_cast<uint64_t>(2*value.size()), size ) );
+            s.read( (char*)(value.data() + done), (value.size() - done) * sizeof(T) );
+            done = value.size();
+         }
+      }
+
+      inline void unpack_vector_elements( datastream<const char*>& s, std::vector<unsigned_int>& value,
+                                          uint64_t size, uint32_t _max_depth, std::false_type )
+      {
+         value.resize( std::min( size, static_cast<uint64_t>(FC_MAX_PREALLOC_SIZE) ) );
+         uint64_t done = 0;
+         while( done < size )
+         {
+            if( done >= value.size() )
+               value.resize( std::min( static_cast<uint64_t>(2*value.size()), size ) );
+            const char* pos = s.pos();
+            done += fc::detail::decode_unsigned_ints( pos, pos + s.remaining(), value.data() + done,
+                                                      value.size() - done );
+            s.skip( pos - s.pos() );
+            // the batch decoder leaves long values and the last few bytes to the checked decoder
+            if( done < value.size() )
+               unpack_unsigned_int( s, value[done++] );
+         }
+      }
+
+    } // namespace detail
+
     template<typename Stream, typename T>
     inline void pack( Stream& s, const std::vector<T>& value, uint32_t _max_depth ) {
        FC_ASSERT( _max_depth > 0 );
        --_max_depth;
        fc::raw::pack( s, unsigned_int(value.size()), _max_depth );
-       auto itr = value.begin();
-       auto end = value.end();
-       while( itr != end ) {
-          fc::raw::pack( s, *itr, _max_depth );
-          ++itr;
-       }
+       detail::pack_vector_elements( s, value, _max_depth, is_trivially_packable<T>() );
     }
 
     template<typename Stream, typename T>
@@ -692,13 +790,7 @@ namespace fc {
        FC_ASSERT( _max_depth > 0 );
        --_max_depth;
        unsigned_int size; fc::raw::unpack( s, size, _max_depth );
-       value.resize( std::min( size.value, static_cast<uint64_t>(FC_MAX_PREALLOC_SIZE) ) );
-       for( uint64_t i = 0; i < size; i++ )
-       {
-          if( i >= value.size() )
-             value.resize( std::min( static_cast<uint64_t>(2*value.size()), size.value ) );
-          unpack( s, value[i], _max_depth );
-       }
+       detail::unpack_vector_elements( s, value, size.value, _max_depth, is_trivially_packable<T>() );
     }
 
     template<typename Stream, typename T>
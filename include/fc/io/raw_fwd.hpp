@@ -15,6 +15,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
+#include <type_traits>
 
 #define MAX_ARRAY_ALLOC_SIZE (1024*1024*10)
 
@@ -37,6 +38,27 @@ namespace fc {
    namespace ecc { class public_key; class private_key; }
 
    namespace raw {
+    /**
+     *  Types whose packed representation is identical to their in-memory representation.
+     *  Contiguous containers of such types are packed and unpacked with a single bulk
+     *  write/read instead of element by element. Specialize this for fixed-layout types.
+     */
+    template<typename T> struct is_trivially_packable : std::false_type {};
+
+    namespace detail {
+       using native_is_little_endian = std::integral_constant< bool,
+                                       boost::endian::order::native == boost::endian::order::little >;
+    }
+
+    template<> struct is_trivially_packable<int8_t>   : std::true_type {};
+    template<> struct is_trivially_packable<uint8_t>  : std::true_type {};
+    template<> struct is_trivially_packable<int16_t>  : detail::native_is_little_endian {};
+    template<> struct is_trivially_packable<uint16_t> : detail::native_is_little_endian {};
+    template<> struct is_trivially_packable<int32_t>  : detail::native_is_little_endian {};
+    template<> struct is_trivially_packable<uint32_t> : detail::native_is_little_endian {};
+    template<> struct is_trivially_packable<int64_t>  : detail::native_is_little_endian {};
+    template<> struct is_trivially_packable<uint64_t> : detail::native_is_little_endian {};
+
     template<typename T>
     inline size_t pack_size(  const T& v );
 
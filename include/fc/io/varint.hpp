@@ -1,5 +1,12 @@
 #pragma once
 #include <stdint.h>
+#include <string.h>
+
+#include <boost/endian/conversion.hpp>
+
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace fc {
 
@@ -46,6 +53,156 @@ class variant;
 void to_variant( const unsigned_int& var, variant& vo, uint32_t max_depth = 1 );
 void from_variant( const variant& var, unsigned_int& vo, uint32_t max_depth = 1 );
 
+/**
+ *  Word-at-a-time kernels for the 7-bit varint encoding used by fc::raw for unsigned_int.
+ *  Values below 2^56 take at most 8 bytes, which lets them be encoded and decoded with a
+ *  single 64-bit load or store plus a few mask operations instead of one branch per byte.
+ *  With BMI2 the bit (de-)interleaving is done by PDEP/PEXT.
+ */
+namespace detail {
+
+   /** Maximum length of a packed unsigned_int */
+   constexpr size_t max_packed_unsigned_int_size = 10;
+
+   constexpr uint64_t varint_payload_bits  = 0x7f7f7f7f7f7f7f7fULL;
+   constexpr uint64_t varint_continue_bits = 0x8080808080808080ULL;
+
+   inline unsigned varint_ctz( uint64_t v )
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_ctzll( v );
+#else
+      unsigned n = 0;
+      while( !( v & 1 ) ) { v >>= 1; ++n; }
+      return n;
+#endif
+   }
+
+   inline unsigned varint_bit_width( uint64_t v )
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      return 64 - __builtin_clzll( v | 1 );
+#else
+      unsigned n = 1;
+      while( v >>= 1 ) ++n;
+      return n;
+#endif
+   }
+
+   inline uint64_t varint_load( const char* in )
+   {
+      uint64_t w;
+      memcpy( &w, in, sizeof(w) );
+      return boost::endian::little_to_native( w );
+   }
+
+   /** Spreads the low 56 bits of v into the low 7 bits of each byte */
+   inline uint64_t varint_spread( uint64_t v )
+   {
+#if defined(__BMI2__) && defined(__x86_64__)
+      return _pdep_u64( v, varint_payload_bits );
+#else
+      v = ( v & 0x000000000fffffffULL ) | ( ( v & 0x00fffffff0000000ULL ) << 4 );
+      v = ( v & 0x00003fff00003fffULL ) | ( ( v & 0x0fffc0000fffc000ULL ) << 2 );
+      return ( v & 0x007f007f007f007fULL ) | ( ( v & 0x3f803f803f803f80ULL ) << 1 );
+#endif
+   }
+
+   /** Inverse of varint_spread, ignores the top bit of each byte */
+   inline uint64_t varint_compact( uint64_t w )
+   {
+#if defined(__BMI2__) && defined(__x86_64__)
+      return _pext_u64( w, varint_payload_bits );
+#else
+      w &= varint_payload_bits;
+      w = ( w & 0x007f007f007f007fULL ) | ( ( w & 0x7f007f007f007f00ULL ) >> 1 );
+      w = ( w & 0x00003fff00003fffULL ) | ( ( w & 0x3fff00003fff0000ULL ) >> 2 );
+      return ( w & 0x000000000fffffffULL ) | ( ( w & 0x0fffffff00000000ULL ) >> 4 );
+#endif
+   }
+
+   /**
+    *  Writes the packed form of v to out, which must have room for max_packed_unsigned_int_size
+    *  bytes. Bytes past the returned length may be overwritten.
+    *  @return the number of bytes of the packed form
+    */
+   inline size_t encode_unsigned_int( uint64_t v, char* out )
+   {
+      if( v < 0x80 ) // by far the most common case, e.g. container sizes
+      {
+         out[0] = char(v);
+         return 1;
+      }
+      const size_t len = ( varint_bit_width( v ) + 6 ) / 7;
+      if( len <= 8 )
+      {
+         const uint64_t more = varint_continue_bits & ( ( uint64_t(1) << ( 8 * ( len - 1 ) ) ) - 1 );
+         const uint64_t w = boost::endian::native_to_little( varint_spread( v ) | more );
+         memcpy( out, &w, sizeof(w) );
+         return len;
+      }
+      size_t n = 0;
+      while( v >= 0x80 )
+      {
+         out[n++] = char( uint8_t(v) | 0x80 );
+         v >>= 7;
+      }
+      out[n++] = char(v);
+      return n;
+   }
+
+   /**
+    *  Decodes a packed unsigned_int of at most 8 bytes. The caller must guarantee that 8 bytes
+    *  are readable at in.
+    *  @return the number of bytes consumed, or 0 if the packed form is longer than 8 bytes
+    */
+   inline size_t decode_unsigned_int( const char* in, uint64_t& v )
+   {
+      if( !( uint8_t(in[0]) & 0x80 ) )
+      {
+         v = uint8_t(in[0]);
+         return 1;
+      }
+      const uint64_t w = varint_load( in );
+      const uint64_t stop = ~w & varint_continue_bits;
+      if( !stop )
+         return 0;
+      const uint64_t last = stop & ( 0 - stop );
+      v = varint_compact( w & ( ( last << 1 ) - 1 ) );
+      return ( varint_ctz( stop ) >> 3 ) + 1;
+   }
+
+   /**
+    *  Decodes up to count packed unsigned_ints from [in, end) into out and advances in past them.
+    *  Runs of eight single-byte values are decoded with one load. Stops early when fewer than
+    *  8 bytes remain or a packed value is longer than 8 bytes; the caller must handle those.
+    *  @return the number of values decoded
+    */
+   inline size_t decode_unsigned_ints( const char*& in, const char* end, unsigned_int* out, size_t count )
+   {
+      size_t i = 0;
+      while( i < count && end - in >= 8 )
+      {
+         const uint64_t w = varint_load( in );
+         if( !( w & varint_continue_bits ) && count - i >= 8 )
+         {
+            for( unsigned k = 0; k < 8; ++k )
+               out[i + k].value = uint8_t( w >> ( 8 * k ) );
+            in += 8;
+            i += 8;
+            continue;
+         }
+         const size_t n = decode_unsigned_int( in, out[i].value );
+         if( !n )
+            break;
+         in += n;
+         ++i;
+      }
+      return i;
+   }
+
+} // namespace detail
+
 }  // namespace fc
 
 #include <unordered_map>
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <fc/filesystem.hpp>
+#include <fc/interprocess/mapped_log.hpp>
+#include <fc/log/appender.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/time.hpp>
+
+#include <functional>
+
+namespace fc
+{
+   namespace binary_log
+   {
+      /** a call site, written before the first event which refers to it */
+      struct format_definition
+      {
+         unsigned_int              id;
+         uint8_t                   level = 0;
+         std::string               format;
+         std::string               file;
+         uint64_t                  line = 0;
+         std::string               method;
+         std::vector<std::string>  arg_names;
+      };
+
+      /** a thread name or logger context, written before the first event which refers to it */
+      struct name_definition
+      {
+         unsigned_int  id;
+         std::string   name;
+      };
+
+      /** a log message, its args are the values of the arg_names of its format */
+      struct event
+      {
+         time_point    timestamp;
+         unsigned_int  format;
+         unsigned_int  thread_name;
+         unsigned_int  context;
+         variants      args;
+      };
+
+      typedef static_variant<format_definition, name_definition, event> record;
+
+      /**
+       *  Reads a log written by binary_appender, including its rotated logs in order, and
+       *  calls f with the log_message of every event.
+       */
+      void read( const fc::path& directory, const std::function<void( const log_message& )>& f );
+   }
+
+   /**
+    *  Writes log messages as raw-packed binary_log::record into an fc::mapped_log, without
+    *  formatting them. Each message is an event, which refers to the format, file, line and
+    *  argument names of its call site and to its thread name by ids. These are defined by
+    *  records written before the first event using them, so an event costs about as much
+    *  as copying its arguments. Doubles, which fc::raw does not pack, are written as strings.
+    *
+    *  With rotate, a new log is started in a subdirectory named after the start time every
+    *  rotation_interval, and logs older than rotation_limit are removed. Every log defines
+    *  the ids it uses. Use binary_log::read() or the decode_binary_log program to turn the
+    *  records back into messages.
+    */
+   class binary_appender : public appender
+   {
+      public:
+         struct config
+         {
+            config( const fc::path& p = "log" );
+
+            fc::path       directory;
+            uint32_t       segment_size = mapped_log_base::default_segment_size;
+            bool           flush = false;
+            bool           rotate = false;
+            microseconds   rotation_interval;
+            microseconds   rotation_limit;
+         };
+
+         binary_appender( const variant& args );
+         binary_appender( const config& cfg );
+         ~binary_appender();
+         virtual void log( const log_message& m )override;
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+} // namespace fc
+
+#include <fc/reflect/reflect.hpp>
+FC_REFLECT( fc::binary_log::format_definition, (id)(level)(format)(file)(line)(method)(arg_names) )
+FC_REFLECT( fc::binary_log::name_definition, (id)(name) )
+FC_REFLECT( fc::binary_log::event, (timestamp)(format)(thread_name)(context)(args) )
+FC_REFLECT( fc::binary_appender::config,
+            (directory)(segment_size)(flush)(rotate)(rotation_interval)(rotation_limit) )
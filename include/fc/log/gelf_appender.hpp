@@ -16,11 +16,23 @@ namespace fc
       string endpoint = "127.0.0.1:12201";
       string host = "fc"; // the name of the host, source or application that sent this message (just passed through to GELF server)
       uint32_t max_object_depth = FC_MAX_LOG_OBJECT_DEPTH;
+      bool batch = false; // compress and send the messages on a background thread, several datagrams per system call
+      uint32_t queue_size = 4096; // in batch mode, messages waiting to be sent before further messages are dropped
+      uint32_t batch_size = 64; // in batch mode, datagrams collected before they are sent
+    };
+
+    struct statistics
+    {
+      uint64_t sent = 0;      // messages sent
+      uint64_t datagrams = 0; // datagrams sent, a message is split into several if it is large
+      uint64_t dropped = 0;   // messages lost because the queue was full or sending failed
+      uint64_t backlog = 0;   // messages waiting to be sent
     };
 
     gelf_appender(const variant& args);
     ~gelf_appender();
     virtual void log(const log_message& m) override;
+    statistics get_statistics() const;
 
   private:
     class impl;
@@ -30,4 +42,6 @@ namespace fc
 
 #include <fc/reflect/reflect.hpp>
 FC_REFLECT(fc::gelf_appender::config,
-           (endpoint)(host)(max_object_depth))
+           (endpoint)(host)(max_object_depth)(batch)(queue_size)(batch_size))
+FC_REFLECT(fc::gelf_appender::statistics,
+           (sent)(datagrams)(dropped)(backlog))
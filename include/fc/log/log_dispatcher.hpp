@@ -0,0 +1,55 @@
+#pragma once
+#include <fc/log/log_message.hpp>
+#include <cstddef>
+
+namespace fc
+{
+   class logger;
+
+   /**
+    *  @brief passes log messages to the appenders on a dedicated thread
+    *
+    *  While the dispatcher runs, logger::log() only moves the message into a single producer,
+    *  single consumer ring buffer of the calling thread, so that threads which log do not
+    *  contend for the locks of the appenders. The dispatcher thread takes the messages from
+    *  the buffers of all threads, earliest timestamp first, and passes them to the appenders.
+    *  The messages of a thread keep their order, those of different threads are ordered by
+    *  time as far as they are queued at the same time.
+    *
+    *  A thread which logs a message of the flush level or above waits until the message and
+    *  all messages it logged before have been passed to the appenders. The dispatcher is also
+    *  flushed when it is stopped and at exit. std::terminate waits for it at most 300ms, in case
+    *  the dispatcher is stuck in an appender. A thread whose buffer is full
+    *  waits for the dispatcher.
+    *
+    *  Exceptions thrown by appenders on the dispatcher thread are ignored.
+    */
+   class log_dispatcher
+   {
+      public:
+         /**
+          *  Starts the dispatcher thread, does nothing if it runs already.
+          *  @param buffer_size - messages queued per thread, rounded up to a power of two
+          *  @param flush_level - the level of messages which are not returned from before they are passed on
+          */
+         static void start( size_t buffer_size = 4096, log_level flush_level = log_level::error );
+
+         /** passes the queued messages to the appenders and stops the dispatcher thread */
+         static void stop();
+
+         /** returns when the messages logged before have been passed to the appenders */
+         static void flush();
+
+         static bool is_running();
+   };
+
+   namespace detail
+   {
+      /**
+       *  Queues m for the dispatcher, if it runs and this is not the dispatcher thread.
+       *  @return false if the message has to be passed on by the caller
+       */
+      bool dispatch_later( const logger& l, log_message& m );
+   }
+
+} // namespace fc
@@ -6,8 +6,11 @@
 #include <fc/config.hpp>
 #include <fc/time.hpp>
 #include <fc/variant_object.hpp>
+#include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace fc
 {
@@ -56,11 +59,25 @@ namespace fc
    class log_context
    {
       public:
+        /** marks file and method as strings which live as long as the program, see FC_LOG_CONTEXT */
+        struct static_source {};
+
         log_context();
+        /** copies file and method */
         log_context( log_level ll,
                      const char* file,
                      uint64_t line,
                      const char* method );
+        /**
+         *  Keeps pointers to file and method instead of copying them.
+         *  @param file - a string which lives as long as the program, usually __FILE__
+         *  @param method - a string which lives as long as the program, usually __func__
+         */
+        log_context( log_level ll,
+                     const char* file,
+                     uint64_t line,
+                     const char* method,
+                     static_source );
         ~log_context();
         explicit log_context( const variant& v, uint32_t max_depth );
         variant to_variant( uint32_t max_depth )const;
@@ -75,9 +92,20 @@ namespace fc
         log_level     get_log_level()const;
         std::string   get_context()const;
 
+        /** get_file() and get_method() without copying, valid as long as the context */
+        const char*   get_file_c_str()const;
+        const char*   get_method_c_str()const;
+
         void          append_context( const std::string& c );
 
         std::string   to_string()const;
+
+        /**
+         *  Takes the timestamps of new contexts from a clock which is cheaper to read, but
+         *  only has a resolution of a few milliseconds (CLOCK_REALTIME_COARSE). Ignored on
+         *  platforms without such a clock.
+         */
+        static void   set_coarse_timestamps( bool enable );
       private:
         std::shared_ptr<detail::log_context_impl> my;
    };
@@ -85,6 +113,124 @@ namespace fc
    void to_variant( const log_context& l, variant& v, uint32_t max_depth );
    void from_variant( const variant& l, log_context& c, uint32_t max_depth );
 
+   namespace detail
+   {
+      /** an argument of a log message, added to the data of the message when it is needed */
+      class log_arg
+      {
+         public:
+            virtual ~log_arg(){}
+            virtual void add_to( limited_mutable_variant_object& data )const = 0;
+      };
+
+      template<typename T>
+      class log_arg_value : public log_arg
+      {
+         public:
+            template<typename V>
+            log_arg_value( std::string&& k, V&& v ):key( std::move(k) ),value( std::forward<V>(v) ){}
+
+            virtual void add_to( limited_mutable_variant_object& data )const override { data( key, value ); }
+
+            std::string key;
+            T           value;
+      };
+
+      class log_arg_object : public log_arg
+      {
+         public:
+            log_arg_object( variant_object&& o ):obj( std::move(o) ){}
+
+            virtual void add_to( limited_mutable_variant_object& data )const override { data( obj ); }
+
+            variant_object obj;
+      };
+
+      /** the type in which an argument of type T is kept, character strings are copied */
+      template<typename T> struct log_arg_type                { typedef typename std::decay<T>::type type; };
+      template<typename T> struct log_arg_type<T&>            : log_arg_type<T> {};
+      template<typename T> struct log_arg_type<T&&>           : log_arg_type<T> {};
+      template<typename T> struct log_arg_type<const T>       : log_arg_type<T> {};
+      template<> struct log_arg_type<char*>                   { typedef std::string type; };
+      template<> struct log_arg_type<const char*>             { typedef std::string type; };
+      template<size_t N> struct log_arg_type<char[N]>         { typedef std::string type; };
+
+      /**
+       *  Whether an argument of type T may be copied and converted to a variant later. This is
+       *  not the case for types which refer to data they do not own, or which may be sliced.
+       */
+      template<typename T> struct is_lazy_log_arg
+         : std::integral_constant<bool, std::is_copy_constructible<T>::value && !std::is_polymorphic<T>::value> {};
+      template<typename T> struct is_lazy_log_arg<T*>                     : std::false_type {};
+      template<typename T> struct is_lazy_log_arg<std::shared_ptr<T>>     : std::false_type {};
+      template<typename T> struct is_lazy_log_arg<std::weak_ptr<T>>       : std::false_type {};
+      template<typename T> struct is_lazy_log_arg<std::reference_wrapper<T>> : std::false_type {};
+   }
+
+   /**
+    *  @brief the arguments of a log message, which are converted to variants only when the
+    *  message is formatted or serialized.
+    *
+    *  Arguments are copied, so that they may be converted after the caller has gone out of scope,
+    *  character strings are copied into a std::string. Arguments which cannot be copied safely
+    *  are converted right away. The conversion has the semantics of
+    *  limited_mutable_variant_object( FC_MAX_LOG_OBJECT_DEPTH, true ).
+    *
+    *  @see FC_LAZY_LOG_MESSAGE
+    */
+   class log_args
+   {
+      public:
+         log_args(){}
+         log_args( log_args&& ) = default;
+         log_args& operator=( log_args&& ) = default;
+
+         template<typename T>
+         log_args& operator()( std::string key, T&& value )&
+         {
+            typedef typename detail::log_arg_type<T>::type value_type;
+            add( std::move(key), std::forward<T>(value), detail::is_lazy_log_arg<value_type>() );
+            return *this;
+         }
+         template<typename T>
+         log_args&& operator()( std::string key, T&& value )&&
+         {
+            return std::move( (*this)( std::move(key), std::forward<T>(value) ) );
+         }
+
+         log_args& operator()( variant_object vo )&
+         {
+            _args.emplace_back( new detail::log_arg_object( std::move(vo) ) );
+            return *this;
+         }
+         log_args&& operator()( variant_object vo )&&
+         {
+            return std::move( (*this)( std::move(vo) ) );
+         }
+
+         bool empty()const { return _args.empty(); }
+
+         /** converts the arguments */
+         variant_object to_variant_object()const;
+
+      private:
+         template<typename T>
+         void add( std::string&& key, T&& value, std::true_type /* lazy */ )
+         {
+            typedef typename detail::log_arg_type<T>::type value_type;
+            _args.emplace_back( new detail::log_arg_value<value_type>( std::move(key), std::forward<T>(value) ) );
+         }
+         template<typename T>
+         void add( std::string&& key, T&& value, std::false_type /* lazy */ )
+         {
+            limited_mutable_variant_object o( FC_MAX_LOG_OBJECT_DEPTH, true );
+            o( std::move(key), std::forward<T>(value) );
+            _args.emplace_back( new detail::log_arg_object( std::move(o) ) );
+         }
+
+         std::vector<std::unique_ptr<detail::log_arg>> _args;
+   };
+
    /**
     *  @brief aggregates a message along with the context and associated meta-information.
     *  @ingroup AthenaSerializable
@@ -113,6 +259,8 @@ namespace fc
           *  @param args - the arguments
           */
          log_message( log_context ctx, std::string format, variant_object args = variant_object() );
+         /** the arguments are converted when the data or the message is requested for the first time */
+         log_message( log_context ctx, std::string format, log_args&& args );
          ~log_message();
 
          log_message( const variant& v, uint32_t max_depth );
@@ -121,7 +269,7 @@ namespace fc
          std::string    get_message()const;
 
          log_context    get_context()const;
-         std::string    get_format()const;
+         const std::string& get_format()const;
          variant_object get_data()const;
 
       private:
@@ -149,7 +297,8 @@ FC_REFLECT_TYPENAME( fc::log_message );
  * @param LOG_LEVEL - a valid log_level::Enum name.
  */
 #define FC_LOG_CONTEXT(LOG_LEVEL) \
-   fc::log_context( fc::log_level::LOG_LEVEL, (const char*)__FILE__, __LINE__, (const char*)__func__ )
+   fc::log_context( fc::log_level::LOG_LEVEL, (const char*)__FILE__, __LINE__, (const char*)__func__, \
+                    fc::log_context::static_source() )
 
 /**
  * @def FC_LOG_MESSAGE(LOG_LEVEL,FORMAT,...)
@@ -165,3 +314,16 @@ FC_REFLECT_TYPENAME( fc::log_message );
                     FORMAT, \
                     fc::limited_mutable_variant_object( FC_MAX_LOG_OBJECT_DEPTH, true )__VA_ARGS__ )
 
+/**
+ * @def FC_LAZY_LOG_MESSAGE(LOG_LEVEL,FORMAT,...)
+ *
+ * @brief Like FC_LOG_MESSAGE, but converts the arguments only when the message is used.
+ *
+ * Used for the messages of exceptions, which are often caught and handled without ever
+ * being formatted. The arguments are copied, see fc::log_args.
+ */
+#define FC_LAZY_LOG_MESSAGE( LOG_LEVEL, FORMAT, ... ) \
+   fc::log_message( FC_LOG_CONTEXT(LOG_LEVEL), \
+                    FORMAT, \
+                    fc::log_args()__VA_ARGS__ )
+
@@ -154,6 +154,13 @@ namespace fc
 #define FC_FORMAT_ARG_PARAMS( ... )\
     BOOST_PP_SEQ_FOR_EACH( FC_FORMAT_ARGS, v, __VA_ARGS__ )
 
+// like FC_FORMAT_ARG_PARAMS, but passes the values themselves, for FC_LAZY_LOG_MESSAGE
+#define FC_CAPTURE_ARGS(r, unused, base) \
+  BOOST_PP_LPAREN() BOOST_PP_STRINGIZE(base),base BOOST_PP_RPAREN()
+
+#define FC_CAPTURE_ARG_PARAMS( ... )\
+    BOOST_PP_SEQ_FOR_EACH( FC_CAPTURE_ARGS, v, __VA_ARGS__ )
+
 #define FC_DUMP_FORMAT_ARG_NAME(r, unused, base) \
    "(" BOOST_PP_STRINGIZE(base) ")"
 
@@ -1,5 +1,7 @@
 #pragma once
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace fc {
   namespace ip {
@@ -24,6 +26,11 @@ namespace fc {
       size_t receive_from( const std::shared_ptr<char>& b, size_t l, fc::ip::endpoint& from );
       size_t send_to( const char* b, size_t l, const fc::ip::endpoint& to ); 
       size_t send_to( const std::shared_ptr<const char>& b, size_t l, const fc::ip::endpoint& to ); 
+      /**
+       *  Sends each buffer as a datagram, several per system call where sendmmsg is available.
+       *  @return the number of datagrams sent
+       */
+      size_t send_to( const std::vector<std::pair<const char*, size_t>>& datagrams, const fc::ip::endpoint& to );
       void   close();
 
       void   set_multicast_enable_loopback( bool );
@@ -46,21 +46,36 @@ namespace fc
    {
       public:
          from_variant_visitor( const variant_object& _vo, T& v, uint32_t max_depth )
-         :vo(_vo),val(v),_max_depth(max_depth - 1) {
+         :vo(_vo),val(v),_max_depth(max_depth - 1),next(_vo.begin()),in_order(true) {
             _FC_ASSERT( max_depth > 0, "Recursion depth exceeded!" );
          }
 
+         /**
+          *  Objects created by to_variant have their entries in the order the members are
+          *  visited, so the entry after the previous match is checked first. While every
+          *  entry before it has been matched by another member, it is also the first entry
+          *  with this key, as find() would return.
+          */
          template<typename Member, class Class, Member (Class::*member)>
          void operator()( const char* name )const
          {
-            auto itr = vo.find(name);
-            if( itr != vo.end() )
-               from_variant( itr->value(), val.*member, _max_depth );
+            auto itr = next;
+            if( !( in_order && itr != vo.end() && itr->key() == name ) )
+            {
+               itr = vo.find(name);
+               if( itr == vo.end() )
+                  return;
+               in_order = false;
+            }
+            next = itr + 1;
+            from_variant( itr->value(), val.*member, _max_depth );
          }
 
          const variant_object& vo;
          T& val;
          const uint32_t _max_depth;
+         mutable variant_object::iterator next;
+         mutable bool in_order;
    };
 
    template<typename T, typename Dummy = void>
@@ -376,7 +376,7 @@ template<typename... Types> class static_variant<typelist::list<Types...>> : pub
    template<typename... T> void from_variant( const fc::variant& v, fc::static_variant<T...>& s, uint32_t max_depth )
    {
       FC_ASSERT( max_depth > 0 );
-      auto ar = v.get_array();
+      const variants& ar = v.get_array();
       if( ar.size() < 2 ) return;
       s.set_which( ar[0].as_uint64() );
       s.visit( to_static_variant(ar[1], max_depth - 1) );
@@ -24,6 +24,9 @@ namespace fc
   typedef fc::optional<std::string> ostring;
   class variant_object;
   std::string format_string( const std::string&, const variant_object&, uint32_t max_object_depth = 200 );
+  /** appends the formatted string to out, which can be reused for the next message */
+  void format_string( const std::string& format, const variant_object& args, std::string& out,
+                      uint32_t max_object_depth = 200 );
   std::string trim( const std::string& );
   std::string to_lower( const std::string& );
   string trim_and_normalize_spaces( const string& s );
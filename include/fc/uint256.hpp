@@ -0,0 +1,129 @@
+#pragma once
+
+#include <fc/crypto/bigint.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw_fwd.hpp>
+#include <fc/reflect/typename.hpp>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include <string.h>
+
+namespace fc {
+
+/**
+ *  Fixed width integers for difficulty, price and share calculations. Unlike bigint they live
+ *  on the stack and need neither heap allocations nor a BN_CTX. Addition, subtraction,
+ *  multiplication, shifts and comparisons are constexpr. Arithmetic wraps like that of the
+ *  built in unsigned types, the signed types hold a sign and a magnitude of the full width.
+ */
+using boost::multiprecision::int256_t;
+using boost::multiprecision::uint256_t;
+using boost::multiprecision::int512_t;
+using boost::multiprecision::uint512_t;
+
+template<> struct get_typename<int256_t>  { static const char* name() { return "int256_t";  } };
+template<> struct get_typename<uint256_t> { static const char* name() { return "uint256_t"; } };
+template<> struct get_typename<int512_t>  { static const char* name() { return "int512_t";  } };
+template<> struct get_typename<uint512_t> { static const char* name() { return "uint512_t"; } };
+
+/** conversions from and to bigint, converting a bigint that does not fit throws */
+bigint to_bigint( const uint256_t& v );
+bigint to_bigint( const int256_t& v );
+bigint to_bigint( const uint512_t& v );
+bigint to_bigint( const int512_t& v );
+void from_bigint( const bigint& b, uint256_t& v );
+void from_bigint( const bigint& b, int256_t& v );
+void from_bigint( const bigint& b, uint512_t& v );
+void from_bigint( const bigint& b, int512_t& v );
+
+class variant;
+/** encodes the value as decimal string, like uint128_t */
+void to_variant( const uint256_t& v, variant& vo, uint32_t max_depth = 1 );
+void to_variant( const int256_t& v, variant& vo, uint32_t max_depth = 1 );
+void to_variant( const uint512_t& v, variant& vo, uint32_t max_depth = 1 );
+void to_variant( const int512_t& v, variant& vo, uint32_t max_depth = 1 );
+/** decodes a decimal or 0x prefixed hex string, or a number */
+void from_variant( const variant& var, uint256_t& vo, uint32_t max_depth = 1 );
+void from_variant( const variant& var, int256_t& vo, uint32_t max_depth = 1 );
+void from_variant( const variant& var, uint512_t& vo, uint32_t max_depth = 1 );
+void from_variant( const variant& var, int512_t& vo, uint32_t max_depth = 1 );
+
+namespace detail {
+   /** negates signed values, unsigned ones are never negative and stay unchanged */
+   template<typename T>
+   T negate( const T& v, std::true_type /* is_signed */ ) { return -v; }
+   template<typename T>
+   T negate( const T& v, std::false_type /* is_signed */ ) { return v; }
+
+   /**
+    *  Writes v to out as Bits/8 bytes of big endian two's complement, which for non-negative
+    *  values are the bytes of the bigint padded with zeros.
+    */
+   template<unsigned Bits, boost::multiprecision::cpp_integer_type Sign>
+   void to_fixed_bytes( const boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                              Bits, Bits, Sign, boost::multiprecision::unchecked, void>>& v,
+                        unsigned char* out )
+   {
+      typedef boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                 Bits, Bits, boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>> unsigned_type;
+      const unsigned_type limit = unsigned_type(1) << ( Bits - 1 );
+      FC_ASSERT( v < 0 ? unsigned_type( abs( v ) ) <= limit
+                       : Sign == boost::multiprecision::unsigned_magnitude || unsigned_type( v ) < limit,
+                 "Value does not fit into ${b} bits of two's complement", ("b",Bits) );
+      // unsigned arithmetic wraps, which makes negation two's complement
+      const unsigned_type u = v < 0 ? unsigned_type(0) - unsigned_type( abs( v ) ) : unsigned_type( v );
+      memset( out, 0, Bits / 8 );
+      unsigned char buf[Bits / 8];
+      unsigned char* end = boost::multiprecision::export_bits( u, buf, 8 );
+      const size_t len = end - buf;
+      memcpy( out + Bits / 8 - len, buf, len );
+   }
+
+   template<unsigned Bits, boost::multiprecision::cpp_integer_type Sign>
+   void from_fixed_bytes( const unsigned char* in,
+                          boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                              Bits, Bits, Sign, boost::multiprecision::unchecked, void>>& v )
+   {
+      typedef boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                 Bits, Bits, boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>> unsigned_type;
+      typedef typename std::decay<decltype(v)>::type value_type;
+      typedef std::integral_constant<bool, Sign == boost::multiprecision::signed_magnitude> is_signed;
+      unsigned_type u;
+      boost::multiprecision::import_bits( u, in, in + Bits / 8 );
+      if( is_signed::value && ( in[0] & 0x80 ) )
+         v = negate( value_type( unsigned_type(0) - u ), is_signed() );
+      else
+         v = value_type( u );
+   }
+} // namespace detail
+
+namespace raw {
+
+   /**
+    *  Packed as fixed size big endian two's complement. Like the other overloads outside of
+    *  raw.hpp, these must be declared before fc/io/raw.hpp is included.
+    */
+   template<typename Stream, unsigned Bits, boost::multiprecision::cpp_integer_type Sign>
+   inline void pack( Stream& s, const boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                                   Bits, Bits, Sign, boost::multiprecision::unchecked, void>>& v,
+                     uint32_t _max_depth = FC_PACK_MAX_DEPTH )
+   {
+      unsigned char bytes[Bits / 8];
+      fc::detail::to_fixed_bytes( v, bytes );
+      s.write( (const char*)bytes, sizeof(bytes) );
+   }
+
+   template<typename Stream, unsigned Bits, boost::multiprecision::cpp_integer_type Sign>
+   inline void unpack( Stream& s, boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+                                     Bits, Bits, Sign, boost::multiprecision::unchecked, void>>& v,
+                       uint32_t _max_depth = FC_PACK_MAX_DEPTH )
+   {
+      unsigned char bytes[Bits / 8];
+      s.read( (char*)bytes, sizeof(bytes) );
+      fc::detail::from_fixed_bytes( bytes, v );
+   }
+
+} // namespace raw
+
+} // namespace fc
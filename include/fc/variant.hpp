@@ -18,6 +18,7 @@
 #include <fc/crypto/hex.hpp>
 #include <boost/endian/buffers.hpp>
 #include <boost/multi_index_container_fwd.hpp>
+#include <boost/utility/string_view.hpp>
 
 #ifdef FC_ASSERT
 #define _FC_ASSERT(...) FC_ASSERT( __VA_ARGS__ )
@@ -191,7 +192,8 @@ namespace fc
     *        and variant_object's.  
     *
     * variant's allocate everything but strings, arrays, and objects on the
-    * stack and are 'move aware' for values allocated on the heap.
+    * stack and are 'move aware' for values allocated on the heap. Strings of
+    * up to sizeof(variant) - 2 bytes are stored inside the variant as well.
     *
     * Memory usage on 64 bit systems is 16 bytes and 12 bytes on 32 bit systems.
     */
@@ -300,7 +302,11 @@ namespace fc
         std::string                 as_string()const;
 
         /// @pre  get_type() == string_type
-        const std::string&          get_string()const;
+        /// @return a copy, short strings are not stored as std::string
+        std::string                 get_string()const;
+        /// @pre  get_type() == string_type
+        /// @return the characters of the string, valid until the variant is modified or destroyed
+        boost::string_view          get_string_view()const;
                                     
         /// @throw if get_type() != array_type | null_type
         variants&                   get_array();
@@ -1,10 +1,16 @@
 #pragma once
 #include <fc/variant.hpp>
+#include <atomic>
 #include <memory>
 
 namespace fc
 {
    class mutable_variant_object;
+   namespace detail
+   {
+      class variant_object_index;
+      struct variant_object_index_deleter { void operator()( variant_object_index* index )const; };
+   }
    
    /**
     *  @ingroup Serializable
@@ -14,8 +20,8 @@ namespace fc
     *  Keys are kept in the order they are inserted.
     *  This dictionary implements copy-on-write
     *
-    *  @note This class is not optimized for random-access on large
-    *        sets of key-value pairs.
+    *  Objects with more than index_threshold entries build a hash index of
+    *  their keys on the first find(), smaller ones are searched linearly.
     */
    class variant_object
    {
@@ -84,8 +90,16 @@ namespace fc
       variant_object& operator=( mutable_variant_object&& );
       variant_object& operator=( const mutable_variant_object& );
 
+     ~variant_object();
+
+      /** objects with more entries than this are searched through a hash index */
+      static const size_t index_threshold = 16;
+
    private:
       std::shared_ptr< std::vector< entry > > _key_value;
+      /** built by the first find() of a large object, owned by this object */
+      mutable std::atomic< const detail::variant_object_index* > _index{ nullptr };
+      void reset_index( const detail::variant_object_index* index = nullptr );
       friend class mutable_variant_object;
    };
    /** @ingroup Serializable */
@@ -102,8 +116,9 @@ namespace fc
    *  Keys are kept in the order they are inserted.
    *  This dictionary implements copy-on-write
    *
-   *  @note This class is not optimized for random-access on large
-   *        sets of key-value pairs.
+   *  Large objects are indexed like variant_object once they are searched
+   *  through the mutable interface, e.g. by set(). Keys must not be changed
+   *  by assigning entries through iterators.
    */
    class mutable_variant_object
    {
@@ -214,6 +229,9 @@ namespace fc
       mutable_variant_object& operator=( const variant_object& );
    private:
       std::unique_ptr< std::vector< entry > > _key_value;
+      /** built by the mutable interface, kept up to date by appends and dropped by erase() */
+      std::unique_ptr< detail::variant_object_index, detail::variant_object_index_deleter > _index;
+      void append( entry e );
       friend class variant_object;
    };
 
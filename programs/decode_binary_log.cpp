@@ -0,0 +1,63 @@
+#include <fc/io/json.hpp>
+#include <fc/log/binary_appender.hpp>
+#include <fc/variant.hpp>
+
+#include <cstring>
+#include <iostream>
+
+/**
+ *  Prints the messages of a log written by fc::binary_appender, as text in the default format
+ *  of fc::file_appender or as one JSON object per line.
+ */
+int main( int argc, char** argv )
+{
+   const char* const usage = "usage: decode_binary_log [--json] <directory>\n";
+   bool json = false;
+   const char* directory = nullptr;
+   for( int i = 1; i < argc; ++i )
+   {
+      if( !strcmp( argv[i], "--json" ) )
+         json = true;
+      else if( !directory && argv[i][0] != '-' )
+         directory = argv[i];
+      else
+      {
+         std::cerr << usage;
+         return 1;
+      }
+   }
+   if( !directory )
+   {
+      std::cerr << usage;
+      return 1;
+   }
+
+   try
+   {
+      const std::string format = "${timestamp} ${thread_name} ${context} ${file}:${line} ${method} ${level}]  ${message}";
+      fc::binary_log::read( directory, [&]( const fc::log_message& m ) {
+         if( json )
+         {
+            std::cout << fc::json::to_string( fc::variant( m, FC_MAX_LOG_OBJECT_DEPTH ) ) << "\n";
+            return;
+         }
+         const fc::log_context context = m.get_context();
+         fc::mutable_variant_object line;
+         line( "timestamp",   std::string( context.get_timestamp() ) )
+             ( "thread_name", context.get_thread_name() )
+             ( "context",     context.get_context() )
+             ( "file",        context.get_file() )
+             ( "line",        context.get_line_number() )
+             ( "method",      context.get_method() )
+             ( "level",       fc::variant( context.get_log_level(), 1 ) )
+             ( "message",     m.get_message() );
+         std::cout << fc::format_string( format, line ) << "\n";
+      } );
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,179 @@
+#include <fc/blocked_bloom_filter.hpp>
+#include <fc/crypto/city.hpp>
+
+#include "crypto/_cpu_features.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef FC_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace fc {
+
+   namespace {
+      typedef blocked_bloom_filter::block block;
+
+      /** @return true if every bit of mask is set in b */
+      typedef bool (*test_kernel)( const block& b, const block& mask );
+
+      bool test_scalar( const block& b, const block& mask )
+      {
+         uint64_t missing = 0;
+         for( int i = 0; i < 8; ++i )
+            missing |= mask.words[i] & ~b.words[i];
+         return missing == 0;
+      }
+
+#ifdef FC_X86_SIMD
+      // an AVX2 variant was several times slower in bloom_benchmark, the mask is written
+      // with 64 bit stores right before it is loaded
+      __attribute__((target("sse4.2")))
+      bool test_sse4( const block& b, const block& mask )
+      {
+         const __m128i* bv = reinterpret_cast<const __m128i*>( b.words );
+         const __m128i* mv = reinterpret_cast<const __m128i*>( mask.words );
+         return _mm_testc_si128( _mm_load_si128( bv ),     _mm_load_si128( mv ) )
+              & _mm_testc_si128( _mm_load_si128( bv + 1 ), _mm_load_si128( mv + 1 ) )
+              & _mm_testc_si128( _mm_load_si128( bv + 2 ), _mm_load_si128( mv + 2 ) )
+              & _mm_testc_si128( _mm_load_si128( bv + 3 ), _mm_load_si128( mv + 3 ) );
+      }
+#endif
+
+      test_kernel get_test_kernel()
+      {
+         static const test_kernel kernel = [] {
+#ifdef FC_X86_SIMD
+            const auto& cpu = detail::get_cpu_features();
+            if( cpu.sse4_2 )
+               return test_sse4;
+#endif
+            return test_scalar;
+         }();
+         return kernel;
+      }
+   } // anonymous namespace
+
+   constexpr uint32_t blocked_bloom_filter::block_bits;
+   constexpr uint8_t  blocked_bloom_filter::format_version;
+
+   blocked_bloom_filter::blocked_bloom_filter()
+   : hash_count_(0),
+     projected_element_count_(0),
+     inserted_element_count_(0),
+     random_seed_(0)
+   {}
+
+   blocked_bloom_filter::blocked_bloom_filter( const bloom_parameters& p )
+   : hash_count_( std::max( 1u, std::min( p.optimal_parameters.number_of_hashes, block_bits ) ) ),
+     projected_element_count_( p.projected_element_count ),
+     inserted_element_count_(0),
+     random_seed_( ( p.random_seed * 0xA5A5A5A5 ) + 1 )
+   {
+      const uint64_t blocks = ( p.optimal_parameters.table_size + block_bits - 1 ) / block_bits;
+      blocks_.resize( std::max<uint64_t>( blocks, 1 ) );
+      clear();
+   }
+
+   bool blocked_bloom_filter::operator==( const blocked_bloom_filter& f )const
+   {
+      return compatible( f )
+             && projected_element_count_ == f.projected_element_count_
+             && inserted_element_count_ == f.inserted_element_count_
+             && ( blocks_.empty() || memcmp( blocks_.data(), f.blocks_.data(), blocks_.size() * sizeof(block) ) == 0 );
+   }
+
+   void blocked_bloom_filter::clear()
+   {
+      if( !blocks_.empty() )
+         memset( blocks_.data(), 0, blocks_.size() * sizeof(block) );
+      inserted_element_count_ = 0;
+   }
+
+   size_t blocked_bloom_filter::compute_mask( const char* data, size_t length, uint64_t random_seed,
+                                              uint32_t hash_count, size_t blocks, block& mask )
+   {
+      const uint128_t h = city_hash_crc_128( data, length );
+      const uint64_t h1 = uint128_lo64( h ) ^ random_seed;
+      const uint64_t h2 = uint128_hi64( h ) ^ ( random_seed >> 32 | random_seed << 32 );
+
+      memset( mask.words, 0, sizeof(mask.words) );
+      // the top 9 bits of a + i * b + i * ( i - 1 ) / 2 * c pick the bit of the i-th probe. The
+      // quadratic term keeps keys with close ( a, b ) apart, plain double hashing over only
+      // 512 bits roughly doubles the false positive rate.
+      uint64_t a = h2;
+      uint64_t b = h2 >> 32 | h2 << 32;
+      for( uint32_t i = 0; i < hash_count; ++i )
+      {
+         const uint32_t bit = uint32_t( a >> 55 );
+         mask.words[bit >> 6] |= uint64_t(1) << ( bit & 63 );
+         a += b;
+         b += 0x9E3779B97F4A7C15ULL;
+      }
+      // maps h1 to [0, blocks) without a division
+      return uint128_hi64( uint128_t( h1 ) * blocks );
+   }
+
+   void blocked_bloom_filter::insert( const char* data, size_t length )
+   {
+      FC_ASSERT( !blocks_.empty(), "Insert into an uninitialized bloom filter" );
+      block mask;
+      block& b = blocks_[ compute_mask( data, length, random_seed_, hash_count_, blocks_.size(), mask ) ];
+      for( int i = 0; i < 8; ++i )
+         b.words[i] |= mask.words[i];
+      ++inserted_element_count_;
+   }
+
+   bool blocked_bloom_filter::contains( const char* data, size_t length )const
+   {
+      if( blocks_.empty() )
+         return false;
+      block mask;
+      const block& b = blocks_[ compute_mask( data, length, random_seed_, hash_count_, blocks_.size(), mask ) ];
+      return get_test_kernel()( b, mask );
+   }
+
+   double blocked_bloom_filter::effective_fpp()const
+   {
+      if( blocks_.empty() )
+         return 1.0;
+      if( inserted_element_count_ == 0 )
+         return 0.0;
+      // the number of keys in a block is Poisson distributed, sum up the false positive
+      // probability of a standard bloom filter of one block for every possible count
+      const double lambda = double( inserted_element_count_ ) / blocks_.size();
+      const double k      = hash_count_;
+      const double end    = lambda + 10 * std::sqrt( lambda ) + 10;
+      double fpp = 0.0;
+      for( double j = 0; j <= end; ++j )
+      {
+         const double p = std::exp( j * std::log( lambda ) - lambda - std::lgamma( j + 1 ) );
+         fpp += p * std::pow( 1.0 - std::pow( 1.0 - 1.0 / block_bits, k * j ), k );
+      }
+      return fpp;
+   }
+
+   blocked_bloom_filter& blocked_bloom_filter::operator|=( const blocked_bloom_filter& f )
+   {
+      if( compatible( f ) )
+      {
+         for( size_t i = 0; i < blocks_.size(); ++i )
+            for( int w = 0; w < 8; ++w )
+               blocks_[i].words[w] |= f.blocks_[i].words[w];
+      }
+      return *this;
+   }
+
+   blocked_bloom_filter& blocked_bloom_filter::operator&=( const blocked_bloom_filter& f )
+   {
+      if( compatible( f ) )
+      {
+         for( size_t i = 0; i < blocks_.size(); ++i )
+            for( int w = 0; w < 8; ++w )
+               blocks_[i].words[w] &= f.blocks_[i].words[w];
+      }
+      return *this;
+   }
+
+} // namespace fc
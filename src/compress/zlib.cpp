@@ -1,9 +1,29 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
 
 #include "miniz.c"
+// miniz defines the zlib names as macros
+#undef compress
+
+#include <vector>
 
 namespace fc
 {
+  namespace
+  {
+    mz_uint deflate_flags( int level )
+    {
+      FC_ASSERT( level >= zlib_no_compression && level <= zlib_best_compression, "Invalid compression level ${l}", ("l",level) );
+      return tdefl_create_comp_flags_from_zip_params( level, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY );
+    }
+
+    mz_bool append_to_string( const void* data, int length, void* out )
+    {
+      static_cast<std::string*>( out )->append( static_cast<const char*>( data ), length );
+      return MZ_TRUE;
+    }
+  }
+
   std::string zlib_compress(const std::string& in)
   {
     size_t compressed_message_length;
@@ -12,4 +32,169 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  std::string zlib_decompress(const std::string& in)
+  {
+    std::string result;
+    size_t in_size = in.size();
+    // a stream without output is valid, so success can only be told from the status
+    FC_ASSERT( tinfl_decompress_mem_to_callback( in.c_str(), &in_size, &append_to_string, &result,
+                                                 TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32 ) == 1,
+               "Invalid zlib stream" );
+    return result;
+  }
+
+  class zlib_compressor::impl
+  {
+    public:
+      tdefl_compressor state;
+  };
+
+  zlib_compressor::zlib_compressor() : my( new impl() ) {}
+
+  zlib_compressor::~zlib_compressor() {}
+
+  void zlib_compressor::compress( const char* in, size_t size, std::string& out, int level )
+  {
+    out.clear();
+    tdefl_init( &my->state, &append_to_string, &out, deflate_flags( level ) );
+    FC_ASSERT( tdefl_compress_buffer( &my->state, in, size, TDEFL_FINISH ) == TDEFL_STATUS_DONE );
+  }
+
+  class deflate_ostream::impl
+  {
+    public:
+      /** compresses buf with the given flush mode and writes the output to the underlying stream */
+      void deflate( const char* buf, size_t len, tdefl_flush flush )
+      {
+        FC_ASSERT( !finished, "The zlib stream has been closed" );
+        tdefl_status status = tdefl_compress_buffer( &context->my->state, buf, len, flush );
+        FC_ASSERT( status == TDEFL_STATUS_OKAY || status == TDEFL_STATUS_DONE, "Deflate failed" );
+        finished = ( status == TDEFL_STATUS_DONE );
+        if( !output.empty() )
+        {
+          out->write( output.data(), output.size() );
+          output.clear();
+        }
+      }
+
+      ostream_ptr                      out;
+      std::shared_ptr<zlib_compressor> context;
+      /** what the compressor produced during the current call */
+      std::string                      output;
+      bool                             finished = false;
+  };
+
+  deflate_ostream::deflate_ostream( ostream_ptr out, int level, std::shared_ptr<zlib_compressor> context )
+  :my( new impl() )
+  {
+    my->out = std::move( out );
+    my->context = context ? std::move( context ) : std::make_shared<zlib_compressor>();
+    tdefl_init( &my->context->my->state, &append_to_string, &my->output, deflate_flags( level ) );
+  }
+
+  deflate_ostream::~deflate_ostream()
+  {
+    try
+    {
+      if( !my->finished )
+        my->deflate( nullptr, 0, TDEFL_FINISH );
+    }
+    catch( ... )
+    {
+    }
+  }
+
+  size_t deflate_ostream::writesome( const char* buf, size_t len )
+  {
+    my->deflate( buf, len, TDEFL_NO_FLUSH );
+    return len;
+  }
+
+  size_t deflate_ostream::writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset )
+  {
+    return writesome( buf.get() + offset, len );
+  }
+
+  void deflate_ostream::flush()
+  {
+    if( !my->finished )
+      my->deflate( nullptr, 0, TDEFL_SYNC_FLUSH );
+    my->out->flush();
+  }
+
+  void deflate_ostream::close()
+  {
+    if( !my->finished )
+      my->deflate( nullptr, 0, TDEFL_FINISH );
+    my->out->close();
+  }
+
+  class inflate_istream::impl
+  {
+    public:
+      istream_ptr       in;
+      tinfl_decompressor state;
+      tinfl_status      status = TINFL_STATUS_NEEDS_MORE_INPUT;
+      /** the decompressor writes into this window, which holds the data it refers back to */
+      std::vector<char> window = std::vector<char>( TINFL_LZ_DICT_SIZE );
+      size_t            window_offset = 0;
+      /** decompressed data in the window, which has not been read */
+      size_t            pending_begin = 0;
+      size_t            pending_end = 0;
+      std::vector<char> input = std::vector<char>( 64 * 1024 );
+      size_t            input_begin = 0;
+      size_t            input_end = 0;
+  };
+
+  inflate_istream::inflate_istream( istream_ptr in )
+  :my( new impl() )
+  {
+    my->in = std::move( in );
+    tinfl_init( &my->state );
+  }
+
+  inflate_istream::~inflate_istream() {}
+
+  size_t inflate_istream::readsome( char* buf, size_t len )
+  {
+    while( my->pending_begin == my->pending_end )
+    {
+      if( my->status == TINFL_STATUS_DONE )
+        FC_THROW_EXCEPTION( eof_exception, "" );
+      if( my->status == TINFL_STATUS_NEEDS_MORE_INPUT && my->input_begin == my->input_end )
+      {
+        try
+        {
+          my->input_end = my->in->readsome( my->input.data(), my->input.size() );
+          my->input_begin = 0;
+        }
+        catch( const eof_exception& )
+        {
+          FC_THROW( "The zlib stream is incomplete" );
+        }
+      }
+
+      size_t in_bytes = my->input_end - my->input_begin;
+      size_t out_bytes = my->window.size() - my->window_offset;
+      my->status = tinfl_decompress( &my->state, (const mz_uint8*)my->input.data() + my->input_begin, &in_bytes,
+                                     (mz_uint8*)my->window.data(), (mz_uint8*)my->window.data() + my->window_offset, &out_bytes,
+                                     TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32 | TINFL_FLAG_HAS_MORE_INPUT );
+      FC_ASSERT( my->status >= TINFL_STATUS_DONE, "Invalid zlib stream" );
+      my->input_begin += in_bytes;
+      my->pending_begin = my->window_offset;
+      my->pending_end = my->window_offset + out_bytes;
+      my->window_offset = ( my->window_offset + out_bytes ) & ( my->window.size() - 1 );
+    }
+
+    const size_t n = std::min( len, my->pending_end - my->pending_begin );
+    memcpy( buf, my->window.data() + my->pending_begin, n );
+    my->pending_begin += n;
+    return n;
+  }
+
+  size_t inflate_istream::readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset )
+  {
+    return readsome( buf.get() + offset, len );
+  }
 }
@@ -0,0 +1,146 @@
+#include <fc/concurrent_bloom_filter.hpp>
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <new>
+
+namespace fc {
+
+   namespace {
+      const auto relaxed = std::memory_order_relaxed;
+   }
+
+   concurrent_bloom_filter::concurrent_bloom_filter( const bloom_parameters& p )
+   {
+      const blocked_bloom_filter shape( p );
+      hash_count_              = shape.hash_count_;
+      projected_element_count_ = shape.projected_element_count_;
+      random_seed_             = shape.random_seed_;
+      init( shape.blocks_.size() );
+   }
+
+   concurrent_bloom_filter::concurrent_bloom_filter( const blocked_bloom_filter& f )
+   {
+      FC_ASSERT( !!f, "Uninitialized bloom filter" );
+      hash_count_              = f.hash_count_;
+      projected_element_count_ = f.projected_element_count_;
+      random_seed_             = f.random_seed_;
+      init( f.blocks_.size() );
+      *this |= f;
+      inserted_[0].value.store( f.inserted_element_count_, relaxed );
+   }
+
+   concurrent_bloom_filter::~concurrent_bloom_filter()
+   {
+      boost::alignment::aligned_free( table_ );
+   }
+
+   void concurrent_bloom_filter::init( size_t blocks )
+   {
+      blocks_ = blocks;
+      table_  = static_cast<atomic_block*>( boost::alignment::aligned_alloc( alignof(atomic_block),
+                                                                             blocks * sizeof(atomic_block) ) );
+      if( !table_ )
+         throw std::bad_alloc();
+      for( size_t i = 0; i < blocks; ++i )
+         new( table_ + i ) atomic_block;
+      clear();
+   }
+
+   void concurrent_bloom_filter::clear()
+   {
+      for( size_t i = 0; i < blocks_; ++i )
+         for( auto& w : table_[i].words )
+            w.store( 0, relaxed );
+      for( auto& c : inserted_ )
+         c.value.store( 0, relaxed );
+   }
+
+   void concurrent_bloom_filter::insert( const char* data, size_t length )
+   {
+      blocked_bloom_filter::block mask;
+      const size_t index = blocked_bloom_filter::compute_mask( data, length, random_seed_, hash_count_,
+                                                               blocks_, mask );
+      atomic_block& b = table_[index];
+      for( int i = 0; i < 8; ++i )
+      {
+         // a plain load is much cheaper than a locked instruction, and the bits of frequent
+         // keys are usually set already
+         if( mask.words[i] && ( b.words[i].load( relaxed ) & mask.words[i] ) != mask.words[i] )
+            b.words[i].fetch_or( mask.words[i], relaxed );
+      }
+      inserted_[ index % counter_count ].value.fetch_add( 1, relaxed );
+   }
+
+   bool concurrent_bloom_filter::contains( const char* data, size_t length )const
+   {
+      blocked_bloom_filter::block mask;
+      const atomic_block& b = table_[ blocked_bloom_filter::compute_mask( data, length, random_seed_,
+                                                                         hash_count_, blocks_, mask ) ];
+      for( int i = 0; i < 8; ++i )
+         if( ( b.words[i].load( relaxed ) & mask.words[i] ) != mask.words[i] )
+            return false;
+      return true;
+   }
+
+   uint64_t concurrent_bloom_filter::element_count()const
+   {
+      uint64_t count = 0;
+      for( const auto& c : inserted_ )
+         count += c.value.load( relaxed );
+      return count;
+   }
+
+   concurrent_bloom_filter& concurrent_bloom_filter::operator|=( const blocked_bloom_filter& f )
+   {
+      if( compatible( f ) )
+      {
+         for( size_t i = 0; i < blocks_; ++i )
+            for( int w = 0; w < 8; ++w )
+               if( f.blocks_[i].words[w] )
+                  table_[i].words[w].fetch_or( f.blocks_[i].words[w], relaxed );
+      }
+      return *this;
+   }
+
+   concurrent_bloom_filter& concurrent_bloom_filter::operator|=( const concurrent_bloom_filter& f )
+   {
+      if( this != &f && hash_count_ == f.hash_count_ && random_seed_ == f.random_seed_ && blocks_ == f.blocks_ )
+      {
+         for( size_t i = 0; i < blocks_; ++i )
+            for( int w = 0; w < 8; ++w )
+            {
+               const uint64_t bits = f.table_[i].words[w].load( relaxed );
+               if( bits )
+                  table_[i].words[w].fetch_or( bits, relaxed );
+            }
+      }
+      return *this;
+   }
+
+   concurrent_bloom_filter& concurrent_bloom_filter::operator&=( const blocked_bloom_filter& f )
+   {
+      if( compatible( f ) )
+      {
+         for( size_t i = 0; i < blocks_; ++i )
+            for( int w = 0; w < 8; ++w )
+               table_[i].words[w].fetch_and( f.blocks_[i].words[w], relaxed );
+      }
+      return *this;
+   }
+
+   blocked_bloom_filter concurrent_bloom_filter::snapshot()const
+   {
+      blocked_bloom_filter result;
+      result.hash_count_              = hash_count_;
+      result.projected_element_count_ = projected_element_count_;
+      result.inserted_element_count_  = element_count();
+      result.random_seed_             = random_seed_;
+      result.blocks_.resize( blocks_ );
+      for( size_t i = 0; i < blocks_; ++i )
+         for( int w = 0; w < 8; ++w )
+            result.blocks_[i].words[w] = table_[i].words[w].load( relaxed );
+      return result;
+   }
+
+} // namespace fc
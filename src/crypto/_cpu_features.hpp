@@ -0,0 +1,32 @@
+#pragma once
+
+/* Runtime detection of the x86 instruction set extensions used by the
+ * vectorized code paths. Kernels are compiled with function level target
+ * attributes, so the library itself does not require any -m flags.
+ */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FC_X86_SIMD 1
+#endif
+
+namespace fc { namespace detail {
+    struct cpu_features {
+        bool ssse3  = false;
+        bool sse4_2 = false;
+        bool avx2   = false;
+    };
+
+    inline const cpu_features& get_cpu_features()
+    {
+        static const cpu_features features = [] {
+            cpu_features f;
+#ifdef FC_X86_SIMD
+            __builtin_cpu_init();
+            f.ssse3  = __builtin_cpu_supports( "ssse3" );
+            f.sse4_2 = __builtin_cpu_supports( "sse4.2" );
+            f.avx2   = __builtin_cpu_supports( "avx2" );
+#endif
+            return f;
+        }();
+        return features;
+    }
+}}
@@ -1,6 +1,7 @@
 #include <fc/crypto/aes.hpp>
 #include <fc/crypto/openssl.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
 #include <fc/fwd_impl.hpp>
 
 #include <fc/io/fstream.hpp>
@@ -9,7 +10,9 @@
 
 #include <fc/thread/thread.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/io/varint.hpp>
 #include <boost/endian/buffers.hpp>
+#include <boost/filesystem/fstream.hpp>
 #include <boost/thread/mutex.hpp>
 #include <openssl/opensslconf.h>
 #ifndef OPENSSL_THREADS
@@ -21,11 +24,119 @@
 # include <windows.h>
 #endif
 
+#include <algorithm>
+#include <functional>
+
 namespace fc {
 
+namespace {
+   /** plain and cipher text are processed in chunks of this size, independent of the total */
+   const size_t chunk_size = 64 * 1024;
+
+   /**
+    *  Cipher contexts are allocated once and reused by the thread that released them, so that
+    *  neither acquiring nor releasing one takes a lock.
+    */
+   class cipher_ctx_pool
+   {
+      public:
+         ~cipher_ctx_pool()
+         {
+            for( EVP_CIPHER_CTX* ctx : free_contexts )
+               EVP_CIPHER_CTX_free( ctx );
+            destroyed() = true;
+         }
+
+         EVP_CIPHER_CTX* acquire()
+         {
+            if( free_contexts.empty() )
+            {
+               EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+               if( !ctx )
+                  FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
+                                      ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+               return ctx;
+            }
+            EVP_CIPHER_CTX* ctx = free_contexts.back();
+            free_contexts.pop_back();
+            return ctx;
+         }
+
+         void release( EVP_CIPHER_CTX* ctx )
+         {
+            if( free_contexts.size() >= max_free_contexts )
+            {
+               EVP_CIPHER_CTX_free( ctx );
+               return;
+            }
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+            EVP_CIPHER_CTX_reset( ctx );
+#else
+            EVP_CIPHER_CTX_cleanup( ctx );
+#endif
+            free_contexts.push_back( ctx );
+         }
+
+         /** contexts released by objects that outlive the pool of their thread are freed */
+         static bool& destroyed()
+         {
+            static thread_local bool d = false;
+            return d;
+         }
+
+         static cipher_ctx_pool& current()
+         {
+            static thread_local cipher_ctx_pool pool;
+            return pool;
+         }
+
+      private:
+         static const size_t           max_free_contexts = 8;
+         std::vector<EVP_CIPHER_CTX*>  free_contexts;
+   };
+
+   /**
+    *  With OpenSSL 3 the EVP_aes_256_cbc() object is looked up in the providers at every
+    *  initialization, which costs more than encrypting a short message. Fetching it once avoids that.
+    */
+   const EVP_CIPHER* aes_256_cbc()
+   {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+      static const EVP_CIPHER* cipher = [] {
+         const EVP_CIPHER* c = EVP_CIPHER_fetch( nullptr, "AES-256-CBC", nullptr );
+         return c ? c : EVP_aes_256_cbc();
+      }();
+      return cipher;
+#else
+      return EVP_aes_256_cbc();
+#endif
+   }
+
+   /** a cipher context borrowed from the pool of the current thread */
+   class pooled_cipher_ctx
+   {
+      public:
+         pooled_cipher_ctx() : ctx( cipher_ctx_pool::current().acquire() ) {}
+         ~pooled_cipher_ctx()
+         {
+            if( cipher_ctx_pool::destroyed() )
+               EVP_CIPHER_CTX_free( ctx );
+            else
+               cipher_ctx_pool::current().release( ctx );
+         }
+         pooled_cipher_ctx( const pooled_cipher_ctx& ) = delete;
+         pooled_cipher_ctx& operator=( const pooled_cipher_ctx& ) = delete;
+
+         operator EVP_CIPHER_CTX*()const { return ctx; }
+
+      private:
+         EVP_CIPHER_CTX* ctx;
+   };
+} // anonymous namespace
+
 struct aes_encoder::impl 
 {
-   evp_cipher_ctx ctx;
+   std::unique_ptr<pooled_cipher_ctx> ctx;
 };
 
 aes_encoder::aes_encoder()
@@ -40,13 +151,9 @@ aes_encoder::~aes_encoder()
 
 void aes_encoder::init( const fc::sha256& key, const uint128_t& init_value )
 {
-    my->ctx.obj = EVP_CIPHER_CTX_new();
-    /* Create and initialise the context */
-    if(!my->ctx)
-    {
-        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
-                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
-    }
+    /* Create the context, initializing again reuses it */
+    if( !my->ctx )
+        my->ctx.reset( new pooled_cipher_ctx() );
 
     /* Initialise the encryption operation. IMPORTANT - ensure you use a key
     *    and IV size appropriate for your cipher
@@ -56,12 +163,12 @@ void aes_encoder::init( const fc::sha256& key, const uint128_t& init_value )
     boost::endian::little_uint64_buf_t iv[2];
     iv[0] = uint128_hi64( init_value );
     iv[1] = uint128_lo64( init_value );
-    if(1 != EVP_EncryptInit_ex(my->ctx, EVP_aes_256_cbc(), NULL, (unsigned char*)&key, (const unsigned char*)iv[0].data()))
+    if(1 != EVP_EncryptInit_ex(*my->ctx, aes_256_cbc(), NULL, (unsigned char*)&key, (const unsigned char*)iv[0].data()))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc encryption init", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
     }
-    EVP_CIPHER_CTX_set_padding( my->ctx, 0 );
+    EVP_CIPHER_CTX_set_padding( *my->ctx, 0 );
 }
 
 uint32_t aes_encoder::encode( const char* plaintxt, uint32_t plaintext_len, char* ciphertxt )
@@ -70,7 +177,7 @@ uint32_t aes_encoder::encode( const char* plaintxt, uint32_t plaintext_len, char
     /* Provide the message to be encrypted, and obtain the encrypted output.
     *    * EVP_EncryptUpdate can be called multiple times if necessary
     *       */
-    if(1 != EVP_EncryptUpdate(my->ctx, (unsigned char*)ciphertxt, &ciphertext_len, (const unsigned char*)plaintxt, plaintext_len))
+    if(1 != EVP_EncryptUpdate(*my->ctx, (unsigned char*)ciphertxt, &ciphertext_len, (const unsigned char*)plaintxt, plaintext_len))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc encryption update", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -85,7 +192,7 @@ uint32_t aes_encoder::final_encode( char* ciphertxt )
     /* Finalise the encryption. Further ciphertext bytes may be written at
     *    * this stage.
     *       */
-    if(1 != EVP_EncryptFinal_ex(my->ctx, (unsigned char*)ciphertxt, &ciphertext_len)) 
+    if(1 != EVP_EncryptFinal_ex(*my->ctx, (unsigned char*)ciphertxt, &ciphertext_len)) 
     {
         FC_THROW_EXCEPTION( exception, "error during aes 256 cbc encryption final", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -97,7 +204,7 @@ uint32_t aes_encoder::final_encode( char* ciphertxt )
 
 struct aes_decoder::impl 
 {
-   evp_cipher_ctx ctx;
+   std::unique_ptr<pooled_cipher_ctx> ctx;
 };
 
 aes_decoder::aes_decoder()
@@ -108,13 +215,9 @@ aes_decoder::aes_decoder()
 
 void aes_decoder::init( const fc::sha256& key, const uint128_t& init_value )
 {
-    my->ctx.obj = EVP_CIPHER_CTX_new();
-    /* Create and initialise the context */
-    if(!my->ctx)
-    {
-        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
-                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
-    }
+    /* Create the context, initializing again reuses it */
+    if( !my->ctx )
+        my->ctx.reset( new pooled_cipher_ctx() );
 
     /* Initialise the encryption operation. IMPORTANT - ensure you use a key
     *    and IV size appropriate for your cipher
@@ -124,12 +227,12 @@ void aes_decoder::init( const fc::sha256& key, const uint128_t& init_value )
     boost::endian::little_uint64_buf_t iv[2];
     iv[0] = uint128_hi64( init_value );
     iv[1] = uint128_lo64( init_value );
-    if(1 != EVP_DecryptInit_ex(my->ctx, EVP_aes_256_cbc(), NULL, (unsigned char*)&key, (const unsigned char*)iv[0].data()))
+    if(1 != EVP_DecryptInit_ex(*my->ctx, aes_256_cbc(), NULL, (unsigned char*)&key, (const unsigned char*)iv[0].data()))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc encryption init", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
     }
-    EVP_CIPHER_CTX_set_padding( my->ctx, 0 );
+    EVP_CIPHER_CTX_set_padding( *my->ctx, 0 );
 }
 aes_decoder::~aes_decoder()
 {
@@ -141,7 +244,7 @@ uint32_t aes_decoder::decode( const char* ciphertxt, uint32_t ciphertxt_len, cha
     /* Provide the message to be decrypted, and obtain the decrypted output.
     *    * EVP_DecryptUpdate can be called multiple times if necessary
     *       */
-	if (1 != EVP_DecryptUpdate(my->ctx, (unsigned char*)plaintext, &plaintext_len, (const unsigned char*)ciphertxt, ciphertxt_len))
+	if (1 != EVP_DecryptUpdate(*my->ctx, (unsigned char*)plaintext, &plaintext_len, (const unsigned char*)ciphertxt, ciphertxt_len))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc decryption update", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -157,7 +260,7 @@ uint32_t aes_decoder::final_decode( char* plaintext )
     /* Finalise the encryption. Further ciphertext bytes may be written at
     *    * this stage.
     *       */
-    if(1 != EVP_DecryptFinal_ex(my->ctx, (unsigned char*)plaintext, &ciphertext_len)) 
+    if(1 != EVP_DecryptFinal_ex(*my->ctx, (unsigned char*)plaintext, &ciphertext_len)) 
     {
         FC_THROW_EXCEPTION( exception, "error during aes 256 cbc encryption final", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -181,24 +284,17 @@ uint32_t aes_decoder::final_decode( char* plaintext )
 unsigned aes_encrypt(unsigned char *plaintext, int plaintext_len, unsigned char *key,
                      unsigned char *iv, unsigned char *ciphertext)
 {
-    evp_cipher_ctx ctx( EVP_CIPHER_CTX_new() );
+    pooled_cipher_ctx ctx;
 
     int len = 0;
     unsigned ciphertext_len = 0;
 
-    /* Create and initialise the context */
-    if(!ctx)
-    {
-        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
-                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
-    }
-
     /* Initialise the encryption operation. IMPORTANT - ensure you use a key
     *    and IV size appropriate for your cipher
     *    In this example we are using 256 bit AES (i.e. a 256 bit key). The
     *    IV size for *most* modes is the same as the block size. For AES this
     *    is 128 bits */
-    if(1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv))
+    if(1 != EVP_EncryptInit_ex(ctx, aes_256_cbc(), NULL, key, iv))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc encryption init", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -230,23 +326,16 @@ unsigned aes_encrypt(unsigned char *plaintext, int plaintext_len, unsigned char
 unsigned aes_decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned char *key,
                      unsigned char *iv, unsigned char *plaintext)
 {
-    evp_cipher_ctx ctx( EVP_CIPHER_CTX_new() );
+    pooled_cipher_ctx ctx;
     int len = 0;
     unsigned plaintext_len = 0;
 
-    /* Create and initialise the context */
-    if(!ctx) 
-    {
-        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
-                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
-    }
-
     /* Initialise the decryption operation. IMPORTANT - ensure you use a key
     *    * and IV size appropriate for your cipher
     *       * In this example we are using 256 bit AES (i.e. a 256 bit key). The
     *          * IV size for *most* modes is the same as the block size. For AES this
     *             * is 128 bits */
-    if(1 != EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv))
+    if(1 != EVP_DecryptInit_ex(ctx, aes_256_cbc(), NULL, key, iv))
     {
         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc decrypt init", 
                            ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
@@ -279,17 +368,10 @@ unsigned aes_decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned cha
 unsigned aes_cfb_decrypt(unsigned char *ciphertext, int ciphertext_len, unsigned char *key,
                          unsigned char *iv, unsigned char *plaintext)
 {
-    evp_cipher_ctx ctx( EVP_CIPHER_CTX_new() );
+    pooled_cipher_ctx ctx;
     int len = 0;
     unsigned plaintext_len = 0;
 
-    /* Create and initialise the context */
-    if(!ctx)
-    {
-        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context",
-                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
-    }
-
     /* Initialise the decryption operation. IMPORTANT - ensure you use a key
     *    * and IV size appropriate for your cipher
     *       * In this example we are using 256 bit AES (i.e. a 256 bit key). The
@@ -347,44 +429,316 @@ std::vector<char> aes_decrypt( const fc::sha512& key, const std::vector<char>& c
 }
 
 
+namespace {
+   /** calls consume with the data in chunks of at most chunk_size */
+   typedef std::function<void( const char*, size_t )> chunk_consumer;
+   /** calls its argument with all of the plain text */
+   typedef std::function<void( const chunk_consumer& )> chunk_source;
+
+   void init_cipher( EVP_CIPHER_CTX* ctx, const fc::sha512& key, bool encrypt )
+   {
+      const unsigned char* k = (const unsigned char*)&key;
+      if( 1 != EVP_CipherInit_ex( ctx, aes_256_cbc(), nullptr, k, k + 32, encrypt ? 1 : 0 ) )
+         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc init",
+                             ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+   }
+
+   /** @return the number of bytes written to out, which needs room for len + 16 bytes */
+   size_t cipher_update( EVP_CIPHER_CTX* ctx, const char* data, size_t len, char* out )
+   {
+      int out_len = 0;
+      if( 1 != EVP_CipherUpdate( ctx, (unsigned char*)out, &out_len, (const unsigned char*)data, len ) )
+         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc update",
+                             ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+      return out_len;
+   }
+
+   /** @return the number of bytes written to out, which needs room for 16 bytes */
+   size_t cipher_final( EVP_CIPHER_CTX* ctx, char* out )
+   {
+      int out_len = 0;
+      if( 1 != EVP_CipherFinal_ex( ctx, (unsigned char*)out, &out_len ) )
+         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 cbc final",
+                             ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+      return out_len;
+   }
+
+   /** runs data through the cipher in chunks and hands the output to consume */
+   void cipher_chunks( EVP_CIPHER_CTX* ctx, const char* data, size_t len, std::vector<char>& buffer,
+                       const chunk_consumer& consume )
+   {
+      buffer.resize( chunk_size + 16 );
+      while( len > 0 )
+      {
+         const size_t n = std::min( len, chunk_size );
+         const size_t out = cipher_update( ctx, data, n, buffer.data() );
+         if( out > 0 )
+            consume( buffer.data(), out );
+         data += n;
+         len  -= n;
+      }
+   }
+
+   void cipher_final_chunk( EVP_CIPHER_CTX* ctx, std::vector<char>& buffer, const chunk_consumer& consume )
+   {
+      buffer.resize( chunk_size + 16 );
+      const size_t out = cipher_final( ctx, buffer.data() );
+      if( out > 0 )
+         consume( buffer.data(), out );
+   }
+
+   /** encrypts everything that source produces */
+   void encrypt_chunks( const fc::sha512& key, const chunk_source& source, const chunk_consumer& consume )
+   {
+      pooled_cipher_ctx ctx;
+      init_cipher( ctx, key, true );
+      std::vector<char> buffer;
+      source( [&]( const char* data, size_t len ) { cipher_chunks( ctx, data, len, buffer, consume ); } );
+      cipher_final_chunk( ctx, buffer, consume );
+   }
+
+   /**
+    *  Writes the format of aes_save: the checksum of the key and the cipher text, followed by
+    *  the packed cipher text. The plain text is encrypted once into file.tmp behind a zeroed
+    *  checksum, which is filled in afterwards. Only a complete file replaces file.
+    */
+   void save_chunks( const fc::path& file, const fc::sha512& key, uint64_t plain_size, const chunk_source& source )
+   {
+      const uint64_t cipher_size = ( plain_size / 16 + 1 ) * 16;
+      FC_ASSERT( cipher_size < 0x100000000ULL, "too large for aes_save" );
+      const std::vector<char> packed_size = fc::raw::pack( unsigned_int( cipher_size ) );
+
+      fc::sha512::encoder check_enc;
+      fc::raw::pack( check_enc, key );
+      check_enc.write( packed_size.data(), packed_size.size() );
+
+      const fc::path tmp = file.generic_string() + ".tmp";
+      try {
+         boost::filesystem::fstream out( boost::filesystem::path( tmp ),
+                                         std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+         FC_ASSERT( out.is_open(), "unable to create ${f}", ("f",tmp) );
+         const fc::sha512 placeholder;
+         out.write( placeholder.data(), placeholder.data_size() );
+         out.write( packed_size.data(), packed_size.size() );
+
+         uint64_t written = 0;
+         encrypt_chunks( key, source, [&]( const char* data, size_t len ) {
+            check_enc.write( data, len );
+            out.write( data, len );
+            written += len;
+         } );
+         FC_ASSERT( written == cipher_size, "plain text changed size while it was saved" );
+
+         const fc::sha512 check = check_enc.result();
+         out.seekp( 0 );
+         out.write( check.data(), check.data_size() );
+         out.close();
+         FC_ASSERT( !out.fail(), "unable to write ${f}", ("f",tmp) );
+      } catch( ... ) {
+         try { fc::remove( tmp ); } catch( ... ) {}
+         throw;
+      }
+      fc::rename( tmp, file );
+   }
+
+   /** checks the checksum of a file written by aes_save, then decrypts it in chunks */
+   void load_chunks( const fc::path& file, const fc::sha512& key, const std::function<void( uint64_t )>& on_size,
+                     const chunk_consumer& consume )
+   {
+      FC_ASSERT( fc::exists( file ) );
+
+      fc::ifstream in( file, fc::ifstream::binary );
+      fc::sha512 check;
+      unsigned_int cipher_size;
+      fc::raw::unpack( in, check );
+      fc::raw::unpack( in, cipher_size );
+      const size_t header_size = sizeof(check) + fc::raw::pack_size( cipher_size );
+
+      std::vector<char> chunk( chunk_size );
+      auto read_cipher = [&]( const chunk_consumer& c ) {
+         for( uint64_t left = cipher_size.value; left > 0; )
+         {
+            const size_t n = std::min<uint64_t>( left, chunk_size );
+            in.read( chunk.data(), n );
+            c( chunk.data(), n );
+            left -= n;
+         }
+      };
+
+      fc::sha512::encoder check_enc;
+      fc::raw::pack( check_enc, key );
+      fc::raw::pack( check_enc, cipher_size );
+      read_cipher( [&]( const char* data, size_t len ) { check_enc.write( data, len ); } );
+      FC_ASSERT( check_enc.result() == check );
+
+      on_size( cipher_size.value );
+      in.seekg( header_size );
+      pooled_cipher_ctx ctx;
+      init_cipher( ctx, key, false );
+      std::vector<char> buffer;
+      read_cipher( [&]( const char* data, size_t len ) { cipher_chunks( ctx, data, len, buffer, consume ); } );
+      cipher_final_chunk( ctx, buffer, consume );
+   }
+} // anonymous namespace
+
 /** encrypts plain_text and then includes a checksum that enables us to verify the integrety of
  * the file / key prior to decryption. 
  */
 void              aes_save( const fc::path& file, const fc::sha512& key, std::vector<char> plain_text )
 { try {
-   auto cipher = aes_encrypt( key, plain_text );
-   fc::sha512::encoder check_enc;
-   fc::raw::pack( check_enc, key );
-   fc::raw::pack( check_enc, cipher );
-   auto check = check_enc.result();
-
-   fc::ofstream out(file);
-   fc::raw::pack( out, check );
-   fc::raw::pack( out, cipher );
+   save_chunks( file, key, plain_text.size(), [&]( const chunk_consumer& consume ) {
+      if( !plain_text.empty() )
+         consume( plain_text.data(), plain_text.size() );
+   } );
 } FC_RETHROW_EXCEPTIONS( warn, "", ("file",file) ) }
 
+void              aes_save( const fc::path& file, const fc::sha512& key, const fc::path& plain_text_file )
+{ try {
+   FC_ASSERT( fc::exists( plain_text_file ) );
+   const uint64_t plain_size = fc::file_size( plain_text_file );
+   std::vector<char> chunk( chunk_size );
+   save_chunks( file, key, plain_size, [&]( const chunk_consumer& consume ) {
+      fc::ifstream in( plain_text_file, fc::ifstream::binary );
+      for( uint64_t left = plain_size; left > 0; )
+      {
+         const size_t n = std::min<uint64_t>( left, chunk_size );
+         in.read( chunk.data(), n );
+         consume( chunk.data(), n );
+         left -= n;
+      }
+   } );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("file",file)("plain_text_file",plain_text_file) ) }
+
 /**
  *  recovers the plain_text saved via aes_save()
  */
 std::vector<char> aes_load( const fc::path& file, const fc::sha512& key )
 { try {
-   FC_ASSERT( fc::exists( file ) );
+   std::vector<char> plain_text;
+   load_chunks( file, key,
+                [&]( uint64_t cipher_size ) { plain_text.reserve( cipher_size ); },
+                [&]( const char* data, size_t len ) { plain_text.insert( plain_text.end(), data, data + len ); } );
+   return plain_text;
+} FC_RETHROW_EXCEPTIONS( warn, "", ("file",file) ) }
 
-   fc::ifstream in( file, fc::ifstream::binary );
-   fc::sha512 check;
-   std::vector<char> cipher;
+void              aes_load( const fc::path& file, const fc::sha512& key, fc::ostream& plain_text )
+{ try {
+   load_chunks( file, key, []( uint64_t ) {},
+                [&]( const char* data, size_t len ) { plain_text.write( data, len ); } );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("file",file) ) }
 
-   fc::raw::unpack( in, check );
-   fc::raw::unpack( in, cipher );
 
-   fc::sha512::encoder check_enc;
-   fc::raw::pack( check_enc, key );
-   fc::raw::pack( check_enc, cipher );
+class aes_ostream::impl
+{
+   public:
+      ostream_ptr       sink;
+      pooled_cipher_ctx ctx;
+      std::vector<char> buffer;
+      bool              closed = false;
+};
 
-   FC_ASSERT( check_enc.result() == check );
+aes_ostream::aes_ostream( ostream_ptr sink, const fc::sha512& key )
+: my( new impl )
+{
+   FC_ASSERT( sink );
+   my->sink = std::move( sink );
+   init_cipher( my->ctx, key, true );
+}
 
-   return aes_decrypt( key, cipher );
-} FC_RETHROW_EXCEPTIONS( warn, "", ("file",file) ) }
+aes_ostream::~aes_ostream()
+{
+   // without the final block the cipher text could not be decrypted
+   try
+   {
+      if( !my->closed )
+      {
+         my->closed = true;
+         cipher_final_chunk( my->ctx, my->buffer, [this]( const char* data, size_t n ) { my->sink->write( data, n ); } );
+      }
+   }
+   catch( ... )
+   {
+   }
+}
+
+size_t aes_ostream::writesome( const char* buf, size_t len )
+{
+   FC_ASSERT( !my->closed, "aes_ostream is closed" );
+   len = std::min( len, chunk_size );
+   cipher_chunks( my->ctx, buf, len, my->buffer, [this]( const char* data, size_t n ) { my->sink->write( data, n ); } );
+   return len;
+}
+
+size_t aes_ostream::writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset )
+{
+   return writesome( buf.get() + offset, len );
+}
+
+void aes_ostream::close()
+{
+   if( my->closed )
+      return;
+   my->closed = true;
+   cipher_final_chunk( my->ctx, my->buffer, [this]( const char* data, size_t n ) { my->sink->write( data, n ); } );
+   my->sink->close();
+}
+
+void aes_ostream::flush()
+{
+   my->sink->flush();
+}
+
+
+class aes_istream::impl
+{
+   public:
+      istream_ptr       source;
+      pooled_cipher_ctx ctx;
+      std::vector<char> input;
+      std::vector<char> output;
+      size_t            pos      = 0;
+      size_t            end      = 0;
+      bool              finished = false;
+};
+
+aes_istream::aes_istream( istream_ptr source, const fc::sha512& key )
+: my( new impl )
+{
+   FC_ASSERT( source );
+   my->source = std::move( source );
+   my->input.resize( chunk_size );
+   my->output.resize( chunk_size + 16 );
+   init_cipher( my->ctx, key, false );
+}
+
+aes_istream::~aes_istream() {}
+
+size_t aes_istream::readsome( char* buf, size_t len )
+{
+   while( my->pos == my->end )
+   {
+      if( my->finished )
+         FC_THROW_EXCEPTION( eof_exception, "aes_istream" );
+      my->pos = 0;
+      try {
+         const size_t n = my->source->readsome( my->input.data(), my->input.size() );
+         my->end = cipher_update( my->ctx, my->input.data(), n, my->output.data() );
+      } catch( const eof_exception& ) {
+         // the cipher holds back the last block until it knows that it is the last one
+         my->finished = true;
+         my->end = cipher_final( my->ctx, my->output.data() );
+      }
+   }
+   len = std::min( len, my->end - my->pos );
+   memcpy( buf, my->output.data() + my->pos, len );
+   my->pos += len;
+   return len;
+}
+
+size_t aes_istream::readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset )
+{
+   return readsome( buf.get() + offset, len );
+}
 
 /* This stuff has to go somewhere, I guess this is as good a place as any...
   OpenSSL isn't thread-safe unless you give it access to some mutexes,
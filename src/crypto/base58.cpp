@@ -12,605 +12,193 @@
 // - E-mail usually won't line-break if there's no punctuation to break at.
 // - Doubleclicking selects the whole number as one word if it's all alphanumeric.
 //
-#ifndef BITCOIN_BASE58_H
-#define BITCOIN_BASE58_H
-
-#include <string>
-#include <vector>
-#include <limits>
-#include <algorithm>
-#include <string.h>
-
-#include <fc/log/logger.hpp>
+#include <fc/crypto/base58.hpp>
 #include <fc/exception/exception.hpp>
 
-#include <stdexcept>
-#include <vector>
-#include <openssl/bn.h>
+#include <ctype.h>
+#include <string.h>
 
 namespace fc { namespace detail {
 
-/** Errors thrown by the bignum class */
-class bignum_error : public std::runtime_error
-{
-public:
-    explicit bignum_error(const std::string& str) : std::runtime_error(str) {}
-};
-
-
-/** RAII encapsulated BN_CTX (OpenSSL bignum context) */
-class CAutoBN_CTX
-{
-protected:
-    BN_CTX* pctx;
-    BN_CTX* operator=(BN_CTX* pnew) { return pctx = pnew; }
-
-public:
-    CAutoBN_CTX()
-    {
-        pctx = BN_CTX_new();
-        if (pctx == NULL)
-            throw bignum_error("CAutoBN_CTX : BN_CTX_new() returned NULL");
-    }
+static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
-    ~CAutoBN_CTX()
+/** The value of every base58 digit, -1 for all other characters */
+struct base58_values {
+    int8_t v[256];
+    base58_values()
     {
-        if (pctx != NULL)
-            BN_CTX_free(pctx);
+        memset( v, -1, sizeof(v) );
+        for( int8_t i = 0; i < 58; ++i )
+            v[uint8_t(pszBase58[i])] = i;
     }
-
-    operator BN_CTX*() { return pctx; }
-    BN_CTX& operator*() { return *pctx; }
-    BN_CTX** operator&() { return &pctx; }
-    bool operator!() { return (pctx == NULL); }
 };
 
-
-/** C++ wrapper for BIGNUM (OpenSSL bignum) */
-class CBigNum
+static const base58_values& base58_value_table()
 {
-    BIGNUM* bn;
-public:
-    CBigNum()
-       : bn(BN_new()) {}
-
-    CBigNum(const CBigNum& b)
-       : CBigNum()
-    {
-        if (!BN_copy(bn, b.bn))
-        {
-            BN_clear_free(bn);
-            throw bignum_error("CBigNum::CBigNum(const CBigNum&) : BN_copy failed");
-        }
-    }
-
-    CBigNum& operator=(const CBigNum& b)
-    {
-        if (!BN_copy(bn, b.bn))
-            throw bignum_error("CBigNum::operator= : BN_copy failed");
-        return (*this);
-    }
-
-    ~CBigNum()
-    {
-        BN_clear_free(bn);
-    }
-
-    //CBigNum(char n) is not portable.  Use 'signed char' or 'unsigned char'.
-    CBigNum(signed char n)      :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(short n)            :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(int n)              :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(int64_t n)          :CBigNum() { setint64(n); }
-    CBigNum(unsigned char n)    :CBigNum() { setulong(n); }
-    CBigNum(unsigned short n)   :CBigNum() { setulong(n); }
-    CBigNum(unsigned int n)     :CBigNum() { setulong(n); }
-    CBigNum(uint64_t n)         :CBigNum() { setuint64(n); }
-
-    explicit CBigNum(const std::vector<unsigned char>& vch)
-       : CBigNum()
-    {
-        setvch(vch);
-    }
-
-    void setulong(unsigned long n)
-    {
-        if (!BN_set_word(bn, n))
-            throw bignum_error("CBigNum conversion from unsigned long : BN_set_word failed");
-    }
-
-    unsigned long getulong() const
-    {
-        return BN_get_word(bn);
-    }
-
-    unsigned int getuint() const
-    {
-        return BN_get_word(bn);
-    }
-
-    int getint() const
-    {
-        unsigned long n = BN_get_word(bn);
-        if (!BN_is_negative(bn))
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::max() : n);
-        else
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::min() : -(int)n);
-    }
-
-    void setint64(int64_t n)
-    {
-        unsigned char pch[sizeof(n) + 6];
-        unsigned char* p = pch + 4;
-        bool fNegative = false;
-        if (n < (int64_t)0)
-        {
-            n = -n;
-            fNegative = true;
-        }
-        bool fLeadingZeroes = true;
-        for (int i = 0; i < 8; i++)
-        {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if (fLeadingZeroes)
-            {
-                if (c == 0)
-                    continue;
-                if (c & 0x80)
-                    *p++ = (fNegative ? 0x80 : 0);
-                else if (fNegative)
-                    c |= 0x80;
-                fLeadingZeroes = false;
-            }
-            *p++ = c;
-        }
-        unsigned int nSize = p - (pch + 4);
-        pch[0] = (nSize >> 24) & 0xff;
-        pch[1] = (nSize >> 16) & 0xff;
-        pch[2] = (nSize >> 8) & 0xff;
-        pch[3] = (nSize) & 0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
-
-    void setuint64(uint64_t n)
-    {
-        unsigned char pch[sizeof(n) + 6];
-        unsigned char* p = pch + 4;
-        bool fLeadingZeroes = true;
-        for (int i = 0; i < 8; i++)
-        {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if (fLeadingZeroes)
-            {
-                if (c == 0)
-                    continue;
-                if (c & 0x80)
-                    *p++ = 0;
-                fLeadingZeroes = false;
-            }
-            *p++ = c;
-        }
-        unsigned int nSize = p - (pch + 4);
-        pch[0] = (nSize >> 24) & 0xff;
-        pch[1] = (nSize >> 16) & 0xff;
-        pch[2] = (nSize >> 8) & 0xff;
-        pch[3] = (nSize) & 0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
+    static const base58_values t;
+    return t;
+}
 
+// The conversions work on 32 bit limbs in 64 bit arithmetic and move 5 base58
+// digits per step, 58^5 being the largest power of 58 below 2^32.
+static const uint32_t base58_chunk        = 656356768; // 58^5
+static const int      base58_chunk_digits = 5;
 
-    void setvch(const std::vector<unsigned char>& vch)
-    {
-        std::vector<unsigned char> vch2(vch.size() + 4);
-        unsigned int nSize = vch.size();
-        // BIGNUM's byte stream format expects 4 bytes of
-        // big endian size data info at the front
-        vch2[0] = (nSize >> 24) & 0xff;
-        vch2[1] = (nSize >> 16) & 0xff;
-        vch2[2] = (nSize >> 8) & 0xff;
-        vch2[3] = (nSize >> 0) & 0xff;
-        // swap data to big endian
-        reverse_copy(vch.begin(), vch.end(), vch2.begin() + 4);
-        BN_mpi2bn(&vch2[0], vch2.size(), bn);
-    }
+/** Holds small buffers on the stack, larger ones on the heap */
+template<typename T, size_t N>
+class stack_buffer
+{
+public:
+    explicit stack_buffer( size_t n ) : data( n <= N ? local : new T[n] ) { memset( data, 0, n * sizeof(T) ); }
+    ~stack_buffer() { if( data != local ) delete[] data; }
+    stack_buffer( const stack_buffer& ) = delete;
+    stack_buffer& operator=( const stack_buffer& ) = delete;
+
+    T& operator[]( size_t i ) { return data[i]; }
+    T* get() { return data; }
+private:
+    T  local[N];
+    T* data;
+};
 
-    std::vector<unsigned char> getvch() const
-    {
-        unsigned int nSize = BN_bn2mpi(bn, NULL);
-        if (nSize <= 4)
-            return std::vector<unsigned char>();
-        std::vector<unsigned char> vch(nSize);
-        BN_bn2mpi(bn, &vch[0]);
-        vch.erase(vch.begin(), vch.begin() + 4);
-        reverse(vch.begin(), vch.end());
-        return vch;
-    }
+// Stack space for inputs of up to 64 bytes
+static const size_t stack_bytes = 64;
+static const size_t stack_chars = stack_bytes * 138 / 100 + 1 + base58_chunk_digits;
+static const size_t stack_limbs = stack_bytes / 4 + 2;
 
-    CBigNum& SetCompact(unsigned int nCompact)
-    {
-        unsigned int nSize = nCompact >> 24;
-        std::vector<unsigned char> vch(4 + nSize);
-        vch[3] = nSize;
-        if (nSize >= 1) vch[4] = (nCompact >> 16) & 0xff;
-        if (nSize >= 2) vch[5] = (nCompact >> 8) & 0xff;
-        if (nSize >= 3) vch[6] = (nCompact >> 0) & 0xff;
-        BN_mpi2bn(&vch[0], vch.size(), bn);
-        return *this;
-    }
+/** @return an upper bound for the length of the encoding of len bytes with zeros leading zero bytes */
+static size_t max_encoded_size( size_t len, size_t zeros )
+{
+    // log(256) / log(58) is about 1.37
+    return zeros + ( len - zeros ) * 138 / 100 + 1;
+}
 
-    unsigned int GetCompact() const
+/** Encodes [pbegin, pend) and writes the digits to out, which must have room for max_encoded_size() */
+static size_t EncodeBase58(const unsigned char* pbegin, const unsigned char* pend, char* out)
+{
+    size_t zeros = 0;
+    while( pbegin != pend && *pbegin == 0 )
     {
-        unsigned int nSize = BN_bn2mpi(bn, NULL);
-        std::vector<unsigned char> vch(nSize);
-        nSize -= 4;
-        BN_bn2mpi(bn, &vch[0]);
-        unsigned int nCompact = nSize << 24;
-        if (nSize >= 1) nCompact |= (vch[4] << 16);
-        if (nSize >= 2) nCompact |= (vch[5] << 8);
-        if (nSize >= 3) nCompact |= (vch[6] << 0);
-        return nCompact;
+        ++pbegin;
+        ++zeros;
     }
 
-    void SetHex(const std::string& str)
+    // big endian limbs of the value
+    const size_t len    = pend - pbegin;
+    const size_t nlimbs = ( len + 3 ) / 4;
+    stack_buffer<uint32_t, stack_bytes / 4> limbs( nlimbs );
+    for( size_t i = 0; i < len; ++i )
     {
-        // skip 0x
-        const char* psz = str.c_str();
-        while (isspace(*psz))
-            psz++;
-        bool fNegative = false;
-        if (*psz == '-')
-        {
-            fNegative = true;
-            psz++;
-        }
-        if (psz[0] == '0' && tolower(psz[1]) == 'x')
-            psz += 2;
-        while (isspace(*psz))
-            psz++;
-
-        // hex string to bignum
-        static signed char phexdigit[256] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,1,2,3,4,5,6,7,8,9,0,0,0,0,0,0, 0,0xa,0xb,0xc,0xd,0xe,0xf,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0xa,0xb,0xc,0xd,0xe,0xf,0,0,0,0,0,0,0,0,0 };
-        *this = 0;
-        while (isxdigit(*psz))
-        {
-            *this <<= 4;
-            int n = phexdigit[(unsigned char)*psz++];
-            *this += n;
-        }
-        if (fNegative)
-            BN_set_negative(bn, 1);
+        const size_t bit = ( len - 1 - i ) * 8;
+        limbs[nlimbs - 1 - bit / 32] |= uint32_t(pbegin[i]) << ( bit % 32 );
     }
 
-    std::string ToString(int nBase=10) const
+    // digits, least significant first
+    stack_buffer<char, stack_chars> digits( len * 138 / 100 + 1 + base58_chunk_digits );
+    size_t ndigits = 0;
+    size_t top = 0;
+    while( top < nlimbs )
     {
-        CAutoBN_CTX pctx;
-        CBigNum bnBase = nBase;
-        CBigNum bn0 = 0;
-        std::string str;
-        CBigNum bn = *this;
-        BN_set_negative(bn.bn, false);
-        CBigNum dv;
-        CBigNum rem;
-        if (BN_cmp(bn.bn, bn0.bn) == 0)
-            return "0";
-        while (BN_cmp(bn.bn, bn0.bn) > 0)
+        uint64_t rem = 0;
+        for( size_t i = top; i < nlimbs; ++i )
         {
-            if (!BN_div(dv.bn, rem.bn, bn.bn, bnBase.bn, pctx))
-                throw bignum_error("CBigNum::ToString() : BN_div failed");
-            bn = dv;
-            unsigned int c = rem.getulong();
-            str += "0123456789abcdef"[c];
+            const uint64_t cur = ( rem << 32 ) | limbs[i];
+            limbs[i] = uint32_t( cur / base58_chunk );
+            rem      = cur % base58_chunk;
         }
-        if (BN_is_negative(this->bn))
-            str += "-";
-        reverse(str.begin(), str.end());
-        return str;
-    }
-
-    std::string GetHex() const
-    {
-        return ToString(16);
-    }
-
-
-
-    bool operator!() const
-    {
-        return BN_is_zero(bn);
-    }
-
-    CBigNum& operator+=(const CBigNum& b)
-    {
-        if (!BN_add(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator+= : BN_add failed");
-        return *this;
-    }
-
-    CBigNum& operator-=(const CBigNum& b)
-    {
-        if (!BN_sub(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator-= : BN_sub failed");
-        return *this;
-    }
-
-    CBigNum& operator*=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_mul(bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator*= : BN_mul failed");
-        return *this;
-    }
-
-    CBigNum& operator/=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_div(bn, NULL, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator/= : BN_div failed");
-        return *this;
-    }
-
-    CBigNum& operator%=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_div(NULL, bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator%= : BN_div failed");
-        return *this;
-    }
-
-    CBigNum& operator<<=(unsigned int shift)
-    {
-        if (!BN_lshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator<<= : BN_lshift failed");
-        return *this;
-    }
-
-    CBigNum& operator>>=(unsigned int shift)
-    {
-        // Note: BN_rshift segfaults on 64-bit if 2^shift is greater than the number
-        //   if built on ubuntu 9.04 or 9.10, probably depends on version of openssl
-        CBigNum a = 1;
-        a <<= shift;
-        if (BN_cmp(a.bn, bn) > 0)
+        while( top < nlimbs && limbs[top] == 0 )
+            ++top;
+        for( int k = 0; k < base58_chunk_digits; ++k )
         {
-            *this = 0;
-            return *this;
+            digits[ndigits++] = char( rem % 58 );
+            rem /= 58;
         }
-
-        if (!BN_rshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator>>= : BN_rshift failed");
-        return *this;
-    }
-
-
-    CBigNum& operator++()
-    {
-        // prefix operator
-        if (!BN_add(bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator++ : BN_add failed");
-        return *this;
-    }
-
-    const CBigNum operator++(int)
-    {
-        // postfix operator
-        const CBigNum ret = *this;
-        ++(*this);
-        return ret;
-    }
-
-    CBigNum& operator--()
-    {
-        // prefix operator
-        CBigNum r;
-        if (!BN_sub(r.bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator-- : BN_sub failed");
-        *this = r;
-        return *this;
-    }
-
-    const CBigNum operator--(int)
-    {
-        // postfix operator
-        const CBigNum ret = *this;
-        --(*this);
-        return ret;
-    }
-
-    const BIGNUM* to_bignum() const {
-       return bn;
-    }
-    BIGNUM* to_bignum() {
-       return bn;
-    }
-};
-
-
-
-inline const CBigNum operator+(const CBigNum& a, const CBigNum& b)
-{
-    CBigNum r;
-    if (!BN_add(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator+ : BN_add failed");
-    return r;
-}
-
-inline const CBigNum operator-(const CBigNum& a, const CBigNum& b)
-{
-    CBigNum r;
-    if (!BN_sub(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator- : BN_sub failed");
-    return r;
-}
-
-inline const CBigNum operator-(const CBigNum& a)
-{
-    CBigNum r(a);
-    BN_set_negative(r.to_bignum(), !BN_is_negative(r.to_bignum()));
-    return r;
-}
-
-inline const CBigNum operator*(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_mul(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator* : BN_mul failed");
-    return r;
-}
-
-inline const CBigNum operator/(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_div(r.to_bignum(), NULL, a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator/ : BN_div failed");
-    return r;
-}
-
-inline const CBigNum operator%(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_mod(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator% : BN_div failed");
-    return r;
-}
-
-inline const CBigNum operator<<(const CBigNum& a, unsigned int shift)
-{
-    CBigNum r;
-    if (!BN_lshift(r.to_bignum(), a.to_bignum(), shift))
-        throw bignum_error("CBigNum:operator<< : BN_lshift failed");
-    return r;
-}
-
-inline const CBigNum operator>>(const CBigNum& a, unsigned int shift)
-{
-    CBigNum r = a;
-    r >>= shift;
-    return r;
-}
-
-inline bool operator==(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) == 0); }
-inline bool operator!=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) != 0); }
-inline bool operator<=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) <= 0); }
-inline bool operator>=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) >= 0); }
-inline bool operator<(const CBigNum& a, const CBigNum& b)  { return (BN_cmp(a.to_bignum(), b.to_bignum()) < 0); }
-inline bool operator>(const CBigNum& a, const CBigNum& b)  { return (BN_cmp(a.to_bignum(), b.to_bignum()) > 0); }
-
-
-static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-// Encode a byte sequence as a base58-encoded string
-inline std::string EncodeBase58(const unsigned char* pbegin, const unsigned char* pend)
-{
-    CAutoBN_CTX pctx;
-    CBigNum bn58 = 58;
-    CBigNum bn0 = 0;
-
-    // Convert big endian data to little endian
-    // Extra zero at the end make sure bignum will interpret as a positive number
-    std::vector<unsigned char> vchTmp(pend-pbegin+1, 0);
-    reverse_copy(pbegin, pend, vchTmp.begin());
-
-    // Convert little endian data to bignum
-    CBigNum bn;
-    bn.setvch(vchTmp);
-
-    // Convert bignum to std::string
-    std::string str;
-    // Expected size increase from base58 conversion is approximately 137%
-    // use 138% to be safe
-    str.reserve((pend - pbegin) * 138 / 100 + 1);
-    CBigNum dv;
-    CBigNum rem;
-    while (bn > bn0)
-    {
-        if (!BN_div(dv.to_bignum(), rem.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("EncodeBase58 : BN_div failed");
-        bn = dv;
-        unsigned int c = rem.getulong();
-        str += pszBase58[c];
     }
+    // the last chunk is padded with zero digits
+    while( ndigits > 0 && digits[ndigits - 1] == 0 )
+        --ndigits;
 
-    // Leading zeroes encoded as base58 zeros
-    for (const unsigned char* p = pbegin; p < pend && *p == 0; p++)
-        str += pszBase58[0];
-
-    // Convert little endian std::string to big endian
-    reverse(str.begin(), str.end());
-//    slog( "Encode '%s'", str.c_str() );
-    return str;
-}
-
-// Encode a byte vector as a base58-encoded string
-inline std::string EncodeBase58(const std::vector<unsigned char>& vch)
-{
-    return EncodeBase58(&vch[0], &vch[0] + vch.size());
+    memset( out, pszBase58[0], zeros );
+    for( size_t i = 0; i < ndigits; ++i )
+        out[zeros + i] = pszBase58[uint8_t(digits[ndigits - 1 - i])];
+    return zeros + ndigits;
 }
 
-// Decode a base58-encoded string psz into byte vector vchRet
-// returns true if decoding is succesful
-inline bool DecodeBase58(const char* psz, std::vector<unsigned char>& vchRet)
+/**
+ * Decodes psz, which may be surrounded by whitespace. Calls alloc( size ) for a buffer to
+ * receive the result once its size is known, nothing is written if it returns nullptr.
+ * @return false if psz contains other characters
+ */
+template<typename Alloc>
+static bool DecodeBase58(const char* psz, Alloc&& alloc)
 {
-    CAutoBN_CTX pctx;
-    vchRet.clear();
-    CBigNum bn58 = 58;
-    CBigNum bn = 0;
-    CBigNum bnChar;
-    while (isspace(*psz))
+    const int8_t* table = base58_value_table().v;
+    while( isspace( (unsigned char)*psz ) )
         psz++;
 
-    // Convert big endian string to bignum
-    for (const char* p = psz; *p; p++)
-    {
-        const char* p1 = strchr(pszBase58, *p);
-        if (p1 == NULL)
+    size_t zeros = 0;
+    while( psz[zeros] == pszBase58[0] )
+        ++zeros;
+
+    const char* end = psz;
+    while( table[uint8_t(*end)] >= 0 )
+        ++end;
+    for( const char* p = end; *p; ++p )
+        if( !isspace( (unsigned char)*p ) )
+            return false;
+
+    // little endian limbs of the value, 58^n needs less than n * 5.86 bits
+    const size_t ndigits = end - psz;
+    const size_t nlimbs  = ndigits * 586 / 100 / 32 + 1;
+    stack_buffer<uint32_t, stack_limbs> limbs( nlimbs );
+    size_t used = 0;
+    for( const char* p = psz; p != end; )
+    {
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for( int k = 0; k < base58_chunk_digits && p != end; ++k, ++p )
         {
-            while (isspace(*p))
-                p++;
-            if (*p != '\0') {
-                //slog( "%s  '%c'", pszBase58,*p );
-                return false;
-            }
-            break;
+            chunk = chunk * 58 + uint8_t( table[uint8_t(*p)] );
+            scale *= 58;
         }
-        bnChar.setulong(p1 - pszBase58);
-        if (!BN_mul(bn.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("DecodeBase58 : BN_mul failed");
-        bn += bnChar;
-    }
-
-    // Get bignum as little endian data
-    std::vector<unsigned char> vchTmp = bn.getvch();
-
-    // Trim off sign byte if present
-    if (vchTmp.size() >= 2 && vchTmp.end()[-1] == 0 && vchTmp.end()[-2] >= 0x80)
-        vchTmp.erase(vchTmp.end()-1);
-
-    // Restore leading zeros
-    int nLeadingZeros = 0;
-    for (const char* p = psz; *p == pszBase58[0]; p++)
-        nLeadingZeros++;
-    vchRet.assign(nLeadingZeros + vchTmp.size(), 0);
-
-    // Convert little endian data to big endian
-    reverse_copy(vchTmp.begin(), vchTmp.end(), vchRet.end() - vchTmp.size());
+        uint64_t carry = chunk;
+        for( size_t i = 0; i < used; ++i )
+        {
+            const uint64_t cur = uint64_t(limbs[i]) * scale + carry;
+            limbs[i] = uint32_t( cur );
+            carry    = cur >> 32;
+        }
+        if( carry )
+            limbs[used++] = uint32_t( carry );
+    }
+
+    // minimal big endian bytes of the value, after a zero byte for every leading '1'
+    size_t bytes = used * 4;
+    while( bytes > 0 && ( limbs[( bytes - 1 ) / 4] >> ( ( bytes - 1 ) % 4 * 8 ) & 0xff ) == 0 )
+        --bytes;
+    unsigned char* out = (unsigned char*)alloc( zeros + bytes );
+    if( out == nullptr )
+        return true;
+    memset( out, 0, zeros );
+    for( size_t i = 0; i < bytes; ++i )
+        out[zeros + bytes - 1 - i] = uint8_t( limbs[i / 4] >> ( i % 4 * 8 ) );
     return true;
 }
 
-// Decode a base58-encoded string str into byte vector vchRet
-// returns true if decoding is succesful
-inline bool DecodeBase58(const std::string& str, std::vector<unsigned char>& vchRet)
-{
-    return DecodeBase58(str.c_str(), vchRet);
-}
-
 } // detail
 
 std::string to_base58( const char* d, size_t s ) {
-  return fc::detail::EncodeBase58( (const unsigned char*)d, (const unsigned char*)d+s ).c_str();
+  detail::stack_buffer<char, detail::stack_chars> buf( detail::max_encoded_size( s, 0 ) );
+  const size_t len = detail::EncodeBase58( (const unsigned char*)d, (const unsigned char*)d + s, buf.get() );
+  return std::string( buf.get(), len );
+}
+
+size_t to_base58( const char* d, size_t s, char* out_data, size_t out_data_len ) {
+  detail::stack_buffer<char, detail::stack_chars> buf( detail::max_encoded_size( s, 0 ) );
+  const size_t len = detail::EncodeBase58( (const unsigned char*)d, (const unsigned char*)d + s, buf.get() );
+  FC_ASSERT( len <= out_data_len );
+  memcpy( out_data, buf.get(), len );
+  return len;
 }
 
 std::string to_base58( const std::vector<char>& d )
@@ -620,29 +208,30 @@ std::string to_base58( const std::vector<char>& d )
   return std::string();
 }
 std::vector<char> from_base58( const std::string& base58_str ) {
-   std::vector<unsigned char> out;
-   if( !fc::detail::DecodeBase58( base58_str.c_str(), out ) ) {
+   std::vector<char> out;
+   if( !fc::detail::DecodeBase58( base58_str.c_str(), [&out]( size_t size ) {
+          out.resize( size );
+          return out.data();
+       } ) ) {
      FC_THROW_EXCEPTION( parse_error_exception, "Unable to decode base58 string ${base58_str}",
                          ("base58_str",base58_str) );
    }
-   return std::vector<char>((const char*)out.data(), ((const char*)out.data())+out.size() );
+   return out;
 }
 /**
  *  @return the number of bytes decoded
  */
 size_t from_base58( const std::string& base58_str, char* out_data, size_t out_data_len ) {
-  std::vector<unsigned char> out;
-  if( !fc::detail::DecodeBase58( base58_str.c_str(), out ) ) {
+  size_t len = 0;
+  if( !fc::detail::DecodeBase58( base58_str.c_str(), [&]( size_t size ) {
+         len = size;
+         return size <= out_data_len ? out_data : nullptr;
+      } ) ) {
     FC_THROW_EXCEPTION( parse_error_exception, "Unable to decode base58 string ${base58_str}",
                         ("base58_str",base58_str) );
   }
-  FC_ASSERT( out.size() <= out_data_len );
-  if (!out.empty()) {
-     memcpy( out_data, out.data(), out.size() );
-  }
-  return out.size();
+  FC_ASSERT( len <= out_data_len );
+  return len;
 }
 
 } // fc
-
-#endif
@@ -1,5 +1,13 @@
 #include <fc/crypto/base64.hpp>
-#include <ctype.h>
+#include <fc/exception/exception.hpp>
+
+#include "_cpu_features.hpp"
+
+#include <cstring>
+
+#ifdef FC_X86_SIMD
+#include <immintrin.h>
+#endif
 /* 
    base64.cpp and base64.h
 
@@ -25,114 +33,290 @@
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   Altered for fc: table driven scalar code, SIMD kernels selected at runtime
+   and interfaces that work on caller provided buffers.
+
 */
 
 namespace fc {
 
-inline const std::string& base64_chars()
+namespace {
+
+const char base64_chars[] =
+             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+             "abcdefghijklmnopqrstuvwxyz"
+             "0123456789+/";
+
+/** the value of every base64 character, 0xff for all other characters including '=' */
+struct base64_values {
+  uint8_t v[256];
+  base64_values() {
+    memset( v, 0xff, sizeof(v) );
+    for( uint8_t i = 0; i < 64; ++i )
+      v[uint8_t(base64_chars[i])] = i;
+  }
+};
+
+const base64_values& base64_value_table()
 {
-    static const std::string m_base64_chars = 
-                 "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                 "abcdefghijklmnopqrstuvwxyz"
-                 "0123456789+/";
-    return m_base64_chars;
+  static const base64_values t;
+  return t;
 }
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
-}
+/** encodes a prefix of in, a multiple of 3 bytes, and returns the number of bytes consumed */
+typedef size_t (*encode_kernel)( const uint8_t* in, size_t in_len, char* out );
+/** decodes a valid prefix of in, a multiple of 4 characters, and returns the number of bytes produced */
+typedef size_t (*decode_kernel)( const char* in, size_t in_len, uint8_t* out, size_t out_len );
 
-std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len);
+size_t encode_scalar( const uint8_t*, size_t, char* ) { return 0; }
+size_t decode_scalar( const char*, size_t, uint8_t*, size_t ) { return 0; }
 
-std::string base64_encode( const std::string& enc ) {
-  char const* s = enc.c_str();
-  return base64_encode( (unsigned char const*)s, enc.size() );
+#ifdef FC_X86_SIMD
+/*
+ * The kernels follow the algorithms by Wojciech Muła and Daniel Lemire,
+ * "Faster Base64 Encoding and Decoding using AVX2 Instructions".
+ */
+
+/** spreads the 12 bytes in the low part of v to 16 six bit values */
+__attribute__((target("ssse3")))
+inline __m128i unpack_sextets( __m128i v )
+{
+  const __m128i in = _mm_shuffle_epi8( v, _mm_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 ) );
+  const __m128i ac = _mm_mulhi_epu16( _mm_and_si128( in, _mm_set1_epi32( 0x0fc0fc00 ) ), _mm_set1_epi32( 0x04000040 ) );
+  const __m128i bd = _mm_mullo_epi16( _mm_and_si128( in, _mm_set1_epi32( 0x003f03f0 ) ), _mm_set1_epi32( 0x01000010 ) );
+  return _mm_or_si128( ac, bd );
 }
-std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
 
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
-
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-
-      for(i = 0; (i <4) ; i++)
-        ret += base64_chars()[char_array_4[i]];
-      i = 0;
-    }
+/** maps six bit values to base64 characters */
+__attribute__((target("ssse3")))
+inline __m128i sextets_to_chars( __m128i v )
+{
+  const __m128i offsets = _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                         '/' - 63, 'A', 0, 0 );
+  __m128i idx = _mm_subs_epu8( v, _mm_set1_epi8( 51 ) );
+  idx = _mm_or_si128( idx, _mm_and_si128( _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), v ), _mm_set1_epi8( 13 ) ) );
+  return _mm_add_epi8( v, _mm_shuffle_epi8( offsets, idx ) );
+}
+
+__attribute__((target("ssse3")))
+size_t encode_ssse3( const uint8_t* in, size_t in_len, char* out )
+{
+  size_t i = 0;
+  for( ; i + 16 <= in_len; i += 12, out += 16 )
+  {
+    const __m128i v = unpack_sextets( _mm_loadu_si128( (const __m128i*)(in + i) ) );
+    _mm_storeu_si128( (__m128i*)out, sextets_to_chars( v ) );
   }
+  return i;
+}
 
-  if (i)
+__attribute__((target("avx2")))
+size_t encode_avx2( const uint8_t* in, size_t in_len, char* out )
+{
+  const __m256i shuffle = _mm256_broadcastsi128_si256(
+                             _mm_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 ) );
+  const __m256i offsets = _mm256_broadcastsi128_si256(
+                             _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                            '/' - 63, 'A', 0, 0 ) );
+  size_t i = 0;
+  for( ; i + 28 <= in_len; i += 24, out += 32 )
   {
-    for(j = i; j < 3; j++)
-      char_array_3[j] = '\0';
+    // 12 input bytes per 128 bit lane
+    const __m256i raw = _mm256_inserti128_si256(
+                           _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)(in + i) ) ),
+                           _mm_loadu_si128( (const __m128i*)(in + i + 12) ), 1 );
+    const __m256i v  = _mm256_shuffle_epi8( raw, shuffle );
+    const __m256i ac = _mm256_mulhi_epu16( _mm256_and_si256( v, _mm256_set1_epi32( 0x0fc0fc00 ) ), _mm256_set1_epi32( 0x04000040 ) );
+    const __m256i bd = _mm256_mullo_epi16( _mm256_and_si256( v, _mm256_set1_epi32( 0x003f03f0 ) ), _mm256_set1_epi32( 0x01000010 ) );
+    const __m256i sextets = _mm256_or_si256( ac, bd );
+    __m256i idx = _mm256_subs_epu8( sextets, _mm256_set1_epi8( 51 ) );
+    idx = _mm256_or_si256( idx, _mm256_and_si256( _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), sextets ), _mm256_set1_epi8( 13 ) ) );
+    _mm256_storeu_si256( (__m256i*)out, _mm256_add_epi8( sextets, _mm256_shuffle_epi8( offsets, idx ) ) );
+  }
+  return i + encode_ssse3( in + i, in_len - i, out );
+}
 
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-    char_array_4[3] = char_array_3[2] & 0x3f;
+// a character c is valid if lut_lo[c & 0x0f] & lut_hi[c >> 4] is zero
+#define FC_BASE64_LUT_LO  0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, \
+                          0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+#define FC_BASE64_LUT_HI  0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, \
+                          0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+// offset from the character to its value, indexed by the high nibble, and 1 for '/'
+#define FC_BASE64_LUT_ROLL 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
 
-    for (j = 0; (j < i + 1); j++)
-      ret += base64_chars()[char_array_4[j]];
+__attribute__((target("ssse3")))
+size_t decode_ssse3( const char* in, size_t in_len, uint8_t* out, size_t out_len )
+{
+  const __m128i lut_lo   = _mm_setr_epi8( FC_BASE64_LUT_LO );
+  const __m128i lut_hi   = _mm_setr_epi8( FC_BASE64_LUT_HI );
+  const __m128i lut_roll = _mm_setr_epi8( FC_BASE64_LUT_ROLL );
+  const __m128i mask_2f  = _mm_set1_epi8( 0x2f );
+  size_t n = 0;
+  for( ; n / 3 * 4 + 16 <= in_len && n + 16 <= out_len; n += 12, in += 16 )
+  {
+    const __m128i str = _mm_loadu_si128( (const __m128i*)in );
+    const __m128i hi_nibbles = _mm_and_si128( _mm_srli_epi32( str, 4 ), mask_2f );
+    const __m128i lo = _mm_shuffle_epi8( lut_lo, _mm_and_si128( str, mask_2f ) );
+    const __m128i hi = _mm_shuffle_epi8( lut_hi, hi_nibbles );
+    if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( lo, hi ), _mm_setzero_si128() ) ) != 0xffff )
+      break;
+    const __m128i roll = _mm_shuffle_epi8( lut_roll, _mm_add_epi8( _mm_cmpeq_epi8( str, mask_2f ), hi_nibbles ) );
+    const __m128i sextets = _mm_add_epi8( str, roll );
+    // join four six bit values into three bytes
+    const __m128i pairs  = _mm_maddubs_epi16( sextets, _mm_set1_epi32( 0x01400140 ) );
+    const __m128i joined = _mm_madd_epi16( pairs, _mm_set1_epi32( 0x00011000 ) );
+    _mm_storeu_si128( (__m128i*)(out + n),
+                      _mm_shuffle_epi8( joined, _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) ) );
+  }
+  return n;
+}
 
-    while((i++ < 3))
-      ret += '=';
+__attribute__((target("avx2")))
+size_t decode_avx2( const char* in, size_t in_len, uint8_t* out, size_t out_len )
+{
+  const __m256i lut_lo   = _mm256_setr_epi8( FC_BASE64_LUT_LO, FC_BASE64_LUT_LO );
+  const __m256i lut_hi   = _mm256_setr_epi8( FC_BASE64_LUT_HI, FC_BASE64_LUT_HI );
+  const __m256i lut_roll = _mm256_setr_epi8( FC_BASE64_LUT_ROLL, FC_BASE64_LUT_ROLL );
+  const __m256i mask_2f  = _mm256_set1_epi8( 0x2f );
+  const __m256i shuffle  = _mm256_broadcastsi128_si256(
+                              _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+  size_t n = 0;
+  const char* pos = in;
+  for( ; n / 3 * 4 + 32 <= in_len && n + 32 <= out_len; n += 24, pos += 32 )
+  {
+    const __m256i str = _mm256_loadu_si256( (const __m256i*)pos );
+    const __m256i hi_nibbles = _mm256_and_si256( _mm256_srli_epi32( str, 4 ), mask_2f );
+    const __m256i lo = _mm256_shuffle_epi8( lut_lo, _mm256_and_si256( str, mask_2f ) );
+    const __m256i hi = _mm256_shuffle_epi8( lut_hi, hi_nibbles );
+    if( !_mm256_testz_si256( lo, hi ) )
+      break;
+    const __m256i roll = _mm256_shuffle_epi8( lut_roll, _mm256_add_epi8( _mm256_cmpeq_epi8( str, mask_2f ), hi_nibbles ) );
+    const __m256i sextets = _mm256_add_epi8( str, roll );
+    const __m256i pairs  = _mm256_maddubs_epi16( sextets, _mm256_set1_epi32( 0x01400140 ) );
+    const __m256i joined = _mm256_shuffle_epi8( _mm256_madd_epi16( pairs, _mm256_set1_epi32( 0x00011000 ) ), shuffle );
+    // 12 bytes in each lane, move them next to each other
+    _mm256_storeu_si256( (__m256i*)(out + n),
+                         _mm256_permutevar8x32_epi32( joined, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 7, 7 ) ) );
+  }
+  return n + decode_ssse3( pos, in_len - ( pos - in ), out + n, out_len - n );
+}
 
+#undef FC_BASE64_LUT_LO
+#undef FC_BASE64_LUT_HI
+#undef FC_BASE64_LUT_ROLL
+#endif
+
+struct base64_kernels {
+  encode_kernel encode = encode_scalar;
+  decode_kernel decode = decode_scalar;
+  base64_kernels() {
+#ifdef FC_X86_SIMD
+    const auto& cpu = detail::get_cpu_features();
+    if( cpu.avx2 ) {
+      encode = encode_avx2;
+      decode = decode_avx2;
+    } else if( cpu.ssse3 ) {
+      encode = encode_ssse3;
+      decode = decode_ssse3;
+    }
+#endif
   }
+};
 
-  return ret;
+const base64_kernels& kernels()
+{
+  static const base64_kernels k;
+  return k;
+}
+
+} // anonymous namespace
+
+std::string base64_encode( const std::string& enc ) {
+  return base64_encode( enc.data(), enc.size() );
+}
 
+std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
+  std::string ret( base64_encoded_size( in_len ), '\0' );
+  if( in_len )
+    base64_encode( (const char*)bytes_to_encode, in_len, &ret[0], ret.size() );
+  return ret;
 }
 
+size_t base64_encode( const char* in, size_t in_len, char* out, size_t out_len ) {
+  const size_t encoded_size = base64_encoded_size( in_len );
+  FC_ASSERT( out_len >= encoded_size, "Output buffer too small for base64 encoding" );
+  const uint8_t* bytes = (const uint8_t*)in;
+  size_t i = kernels().encode( bytes, in_len, out );
+  char* o = out + i / 3 * 4;
+
+  for( ; i + 3 <= in_len; i += 3, o += 4 )
+  {
+    const uint32_t v = ( uint32_t(bytes[i]) << 16 ) | ( uint32_t(bytes[i+1]) << 8 ) | bytes[i+2];
+    o[0] = base64_chars[ v >> 18 ];
+    o[1] = base64_chars[ ( v >> 12 ) & 0x3f ];
+    o[2] = base64_chars[ ( v >> 6 ) & 0x3f ];
+    o[3] = base64_chars[ v & 0x3f ];
+  }
+
+  if( i < in_len )
+  {
+    const uint32_t v = ( uint32_t(bytes[i]) << 16 ) | ( i + 1 < in_len ? uint32_t(bytes[i+1]) << 8 : 0 );
+    o[0] = base64_chars[ v >> 18 ];
+    o[1] = base64_chars[ ( v >> 12 ) & 0x3f ];
+    o[2] = i + 1 < in_len ? base64_chars[ ( v >> 6 ) & 0x3f ] : '=';
+    o[3] = '=';
+  }
+
+  return encoded_size;
+}
 
 std::string base64_decode(std::string const& encoded_string) {
-  int in_len = encoded_string.size();
+  std::string ret( base64_decoded_max_size( encoded_string.size() ), '\0' );
+  if( ret.size() )
+    ret.resize( base64_decode( encoded_string.data(), encoded_string.size(), &ret[0], ret.size() ) );
+  return ret;
+}
+
+size_t base64_decode( const char* in, size_t in_len, char* out, size_t out_len ) {
+  FC_ASSERT( out_len >= base64_decoded_max_size( in_len ), "Output buffer too small for base64 decoding" );
+  const uint8_t* table = base64_value_table().v;
+  uint8_t* o = (uint8_t*)out;
+  // the kernels stop in front of a block that contains padding or other characters
+  size_t n = kernels().decode( in, in_len, o, out_len );
+  size_t pos = n / 3 * 4;
+  o += n;
+
+  uint32_t quad = 0;
   int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
-
-  while (in_len-- && ( encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_]; in_++;
-    if (i ==4) {
-      for (i = 0; i <4; i++)
-        char_array_4[i] = base64_chars().find(char_array_4[i]);
-
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-      for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
+  for( ; pos < in_len; ++pos )
+  {
+    const uint8_t v = table[ uint8_t(in[pos]) ];
+    if( v == 0xff )
+      break;
+    quad = ( quad << 6 ) | v;
+    if( ++i == 4 )
+    {
+      o[0] = quad >> 16;
+      o[1] = quad >> 8;
+      o[2] = quad;
+      o += 3;
+      quad = 0;
       i = 0;
     }
   }
 
-  if (i) {
-    for (j = i; j <4; j++)
-      char_array_4[j] = 0;
-
-    for (j = 0; j <4; j++)
-      char_array_4[j] = base64_chars().find(char_array_4[j]);
-
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+  if( i > 1 )
+  {
+    quad <<= 6 * ( 4 - i );
+    o[0] = quad >> 16;
+    if( i == 3 )
+      o[1] = quad >> 8;
+    o += i - 1;
   }
 
-  return ret;
+  return o - (uint8_t*)out;
 }
 
 } // namespace fc
-
@@ -36,6 +36,8 @@
 #include <fc/crypto/city.hpp>
 #include <boost/endian/buffers.hpp>
 
+#include "_cpu_features.hpp"
+
 #if defined(__SSE4_2__) && defined(__x86_64__)
   #include <nmmintrin.h>
   #define _mm_crc32_u64_impl _mm_crc32_u64
@@ -43,6 +45,10 @@
   uint64_t _mm_crc32_u64_impl(uint64_t a, uint64_t b );
 #endif
 
+#ifdef FC_X86_SIMD
+  #include <nmmintrin.h>
+#endif
+
 namespace fc {
 
 using namespace std;
@@ -525,9 +531,23 @@ uint128_t city_hash128(const char *s, size_t len) {
 //#include <citycrc.h>
 //#include <nmmintrin.h>
 
+// The crc32 step of CityHashCrc256Long. Without -msse4.2 the portable one falls back to
+// the software CRC, the hardware one is selected at runtime.
+struct Crc32Portable {
+  static uint64_t Step(uint64_t crc, uint64_t v) { return _mm_crc32_u64_impl(crc, v); }
+};
+
+#ifdef FC_X86_SIMD
+struct Crc32Sse42 {
+  __attribute__((target("sse4.2")))
+  static uint64_t Step(uint64_t crc, uint64_t v) { return _mm_crc32_u64(crc, v); }
+};
+#endif
+
 // Requires len >= 240.
-static void CityHashCrc256Long(const char *s, size_t len,
-                               uint32_t seed, uint64_t *result) {
+template<typename Crc>
+static inline void CityHashCrc256Long(const char *s, size_t len,
+                                      uint32_t seed, uint64_t *result) {
   uint64_t a = Fetch64(s + 56) + k0;
   uint64_t b = Fetch64(s + 96) + k0;
   uint64_t c = result[0] = HashLen16(b, len);
@@ -559,9 +579,9 @@ static void CityHashCrc256Long(const char *s, size_t len,
     g += e;                                     \
     e += z;                                     \
     g += x;                                     \
-    z = _mm_crc32_u64_impl(z, b + g);                \
-    y = _mm_crc32_u64_impl(y, e + h);                \
-    x = _mm_crc32_u64_impl(x, f + a);                \
+    z = Crc::Step(z, b + g);                    \
+    y = Crc::Step(y, e + h);                    \
+    x = Crc::Step(x, f + a);                    \
     e = Rotate(e, r);                           \
     c += e;                                     \
     s += 40
@@ -613,19 +633,45 @@ static void CityHashCrc256Long(const char *s, size_t len,
   result[3] = a + result[2];
 }
 
+typedef void (*CityHashCrc256LongFn)(const char *s, size_t len,
+                                     uint32_t seed, uint64_t *result);
+
+static void CityHashCrc256LongPortable(const char *s, size_t len,
+                                       uint32_t seed, uint64_t *result) {
+  CityHashCrc256Long<Crc32Portable>(s, len, seed, result);
+}
+
+#ifdef FC_X86_SIMD
+__attribute__((target("sse4.2"), flatten))
+static void CityHashCrc256LongSse42(const char *s, size_t len,
+                                    uint32_t seed, uint64_t *result) {
+  CityHashCrc256Long<Crc32Sse42>(s, len, seed, result);
+}
+#endif
+
+static CityHashCrc256LongFn SelectCityHashCrc256Long() {
+#ifdef FC_X86_SIMD
+  if (detail::get_cpu_features().sse4_2)
+    return CityHashCrc256LongSse42;
+#endif
+  return CityHashCrc256LongPortable;
+}
+
 // Requires len < 240.
-static void CityHashCrc256Short(const char *s, size_t len, uint64_t *result) {
+static void CityHashCrc256Short(CityHashCrc256LongFn hash, const char *s, size_t len,
+                                uint64_t *result) {
   char buf[240];
   memcpy(buf, s, len);
   memset(buf + len, 0, 240 - len);
-  CityHashCrc256Long(buf, 240, ~static_cast<uint32_t>(len), result);
+  hash(buf, 240, ~static_cast<uint32_t>(len), result);
 }
 
 void CityHashCrc256(const char *s, size_t len, uint64_t *result) {
+  static const CityHashCrc256LongFn hash = SelectCityHashCrc256Long();
   if (LIKELY(len >= 240)) {
-    CityHashCrc256Long(s, len, 0, result);
+    hash(s, len, 0, result);
   } else {
-    CityHashCrc256Short(s, len, result);
+    CityHashCrc256Short(hash, s, len, result);
   }
 }
 
@@ -1,5 +1,13 @@
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fc/crypto/crc32c.hpp>
+
+#include "_cpu_features.hpp"
+
+#ifdef FC_X86_SIMD
+#include <nmmintrin.h>
+#endif
 //#include <zlib.h>
 /* Tables generated with code like the following:
 
@@ -627,3 +635,124 @@ int main( int argc, char** argv )
 */
 
 #endif
+
+namespace fc {
+
+namespace {
+
+    /**
+     *  Appending n zero bytes to the input is a linear operation on the (not inverted) CRC
+     *  register. The table holds this operation for every byte of the register, so that it
+     *  can be applied with four lookups.
+     */
+    struct crc32c_shift_table {
+        uint32_t t[4][256];
+
+        explicit crc32c_shift_table( size_t n ) {
+            uint32_t basis[32];
+            for( int bit = 0; bit < 32; ++bit ) {
+                uint32_t crc = uint32_t(1) << bit;
+                for( size_t i = 0; i < n; ++i )
+                    crc = crc_tableil8_o32[crc & 0xff] ^ (crc >> 8);
+                basis[bit] = crc;
+            }
+            for( int k = 0; k < 4; ++k )
+                for( uint32_t i = 0; i < 256; ++i ) {
+                    uint32_t crc = 0;
+                    for( int b = 0; b < 8; ++b )
+                        if( i & (1u << b) )
+                            crc ^= basis[8 * k + b];
+                    t[k][i] = crc;
+                }
+        }
+
+        uint32_t operator()( uint32_t crc )const {
+            return t[0][crc & 0xff] ^ t[1][(crc >> 8) & 0xff] ^ t[2][(crc >> 16) & 0xff] ^ t[3][crc >> 24];
+        }
+    };
+
+    typedef uint32_t (*crc32c_kernel)( uint32_t crc, const char* data, size_t len );
+
+    uint32_t crc32c_scalar( uint32_t crc, const char* data, size_t len ) {
+        return crc32cSlicingBy8( crc, data, len );
+    }
+
+#ifdef FC_X86_SIMD
+    /** the stream lengths of the interleaved loops, the long one amortizes the combination */
+    const size_t crc32c_long  = 8192;
+    const size_t crc32c_short = 256;
+
+    const crc32c_shift_table& crc32c_long_shift() {
+        static const crc32c_shift_table t( crc32c_long );
+        return t;
+    }
+
+    const crc32c_shift_table& crc32c_short_shift() {
+        static const crc32c_shift_table t( crc32c_short );
+        return t;
+    }
+
+    inline uint64_t load64( const char* p ) {
+        uint64_t v;
+        memcpy( &v, p, sizeof(v) );
+        return v;
+    }
+
+    /**
+     *  crc32 has a latency of three cycles but a throughput of one per cycle, so three
+     *  independent streams are processed at once and their CRCs are combined afterwards.
+     */
+    __attribute__((target("sse4.2")))
+    uint32_t crc32c_interleaved( uint32_t crc, const char*& p, size_t& len, size_t block,
+                                 const crc32c_shift_table& shift ) {
+        while( len >= 3 * block ) {
+            uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+            const char* end = p + block;
+            do {
+                crc0 = _mm_crc32_u64( crc0, load64( p ) );
+                crc1 = _mm_crc32_u64( crc1, load64( p + block ) );
+                crc2 = _mm_crc32_u64( crc2, load64( p + 2 * block ) );
+                p += 8;
+            } while( p < end );
+            crc = shift( uint32_t(crc0) ) ^ uint32_t(crc1);
+            crc = shift( crc ) ^ uint32_t(crc2);
+            p += 2 * block;
+            len -= 3 * block;
+        }
+        return crc;
+    }
+
+    __attribute__((target("sse4.2")))
+    uint32_t crc32c_sse42( uint32_t crc, const char* p, size_t len ) {
+        for( ; len > 0 && (uintptr_t(p) & 7) != 0; --len )
+            crc = _mm_crc32_u8( crc, uint8_t(*p++) );
+        if( len >= 3 * crc32c_short ) {
+            crc = crc32c_interleaved( crc, p, len, crc32c_long, crc32c_long_shift() );
+            crc = crc32c_interleaved( crc, p, len, crc32c_short, crc32c_short_shift() );
+        }
+        uint64_t crc64 = crc;
+        for( ; len >= 8; len -= 8, p += 8 )
+            crc64 = _mm_crc32_u64( crc64, load64( p ) );
+        crc = uint32_t(crc64);
+        for( ; len > 0; --len )
+            crc = _mm_crc32_u8( crc, uint8_t(*p++) );
+        return crc;
+    }
+#endif
+
+    crc32c_kernel select_crc32c_kernel() {
+#ifdef FC_X86_SIMD
+        if( detail::get_cpu_features().sse4_2 )
+            return crc32c_sse42;
+#endif
+        return crc32c_scalar;
+    }
+
+} // anonymous namespace
+
+uint32_t crc32c( const char* data, size_t len, uint32_t crc ) {
+    static const crc32c_kernel kernel = select_crc32c_kernel();
+    return ~kernel( ~crc, data, len );
+}
+
+} // namespace fc
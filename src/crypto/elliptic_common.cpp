@@ -3,6 +3,7 @@
 #include <fc/io/raw.hpp>
 #include <fc/crypto/hmac.hpp>
 #include <fc/crypto/openssl.hpp>
+#include <fc/crypto/rand.hpp>
 #include <fc/crypto/ripemd160.hpp>
 
 #ifdef _WIN32
@@ -158,6 +159,20 @@ namespace fc { namespace ecc {
         return from_key_data(key);
     }
 
+    namespace {
+        struct public_key_hash_seed
+        {
+            uint64_t seed[4];
+            public_key_hash_seed() { rand_bytes( (char*)seed, sizeof(seed) ); }
+        };
+    }
+
+    public_key_hash::public_key_hash()
+    {
+        static const public_key_hash_seed s;
+        memcpy( seed, s.seed, sizeof(seed) );
+    }
+
     unsigned int public_key::fingerprint() const
     {
         public_key_data key = serialize();
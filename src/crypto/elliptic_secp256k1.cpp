@@ -3,6 +3,7 @@
 #include <fc/crypto/base58.hpp>
 #include <fc/crypto/hmac.hpp>
 #include <fc/crypto/openssl.hpp>
+#include <fc/crypto/recovery_cache.hpp>
 #include <fc/crypto/sha512.hpp>
 
 #include <fc/fwd_impl.hpp>
@@ -26,6 +27,36 @@ namespace fc { namespace ecc {
             return ctx;
         }
 
+        /** HMAC-SHA512 keyed with a chain code, the padded key blocks are hashed only once */
+        class chain_code_hmac
+        {
+            public:
+                explicit chain_code_hmac( const fc::sha256& chain_code )
+                {
+                    char pad[128]; // the SHA-512 block size
+                    for( size_t i = 0; i < sizeof(pad); ++i )
+                        pad[i] = 0x36 ^ ( i < chain_code.data_size() ? chain_code.data()[i] : 0 );
+                    inner.write( pad, sizeof(pad) );
+                    for( size_t i = 0; i < sizeof(pad); ++i )
+                        pad[i] ^= 0x36 ^ 0x5c;
+                    outer.write( pad, sizeof(pad) );
+                }
+
+                fc::sha512 digest( const char* d, uint32_t d_len )const
+                {
+                    fc::sha512::encoder in( inner );
+                    in.write( d, d_len );
+                    const fc::sha512 intermediate = in.result();
+                    fc::sha512::encoder out( outer );
+                    out.write( intermediate.data(), intermediate.data_size() );
+                    return out.result();
+                }
+
+            private:
+                fc::sha512::encoder inner;
+                fc::sha512::encoder outer;
+        };
+
         void _init_lib() {
             static const secp256k1_context_t* ctx = _get_context();
             (void)ctx;
@@ -121,6 +152,11 @@ namespace fc { namespace ecc {
         return my->_key;
     }
 
+    const public_key_data& public_key::key_data()const
+    {
+        return my->_key;
+    }
+
     public_key_point_data public_key::serialize_ecc_point()const
     {
         FC_ASSERT( my->_key != empty_pub );
@@ -164,11 +200,17 @@ namespace fc { namespace ecc {
             FC_ASSERT( is_canonical( c ), "signature is not canonical" );
         }
 
+        const auto cache = recovery_cache::installed();
+        if( cache && cache->get( digest, c, my->_key ) )
+            return;
+
         unsigned int pk_len;
         FC_ASSERT( secp256k1_ecdsa_recover_compact( detail::_get_context(), (unsigned char*) digest.data(),
                                                     c.data() + 1, my->_key.data(), (int*) &pk_len, 1,
                                                     (*c.data() - 27) & 3 ) );
         FC_ASSERT( pk_len == my->_key.size() );
+        if( cache )
+            cache->put( digest, c, my->_key );
     }
 
     extended_public_key::extended_public_key( const public_key& k, const fc::sha256& c,
@@ -190,6 +232,35 @@ namespace fc { namespace ecc {
         return result;
     }
 
+    std::vector<extended_public_key> extended_public_key::derive_children( int first, uint32_t count ) const
+    {
+        FC_ASSERT( first >= 0 && uint64_t(first) + count <= 0x80000000ULL, "Can't derive hardened public key!" );
+        const public_key_data key = serialize();
+        // parsing the uncompressed parent for every child avoids the square root of the compressed form
+        const public_key_point_data point = serialize_ecc_point();
+        const detail::chain_code_hmac mac( c );
+        const int fp = fingerprint();
+
+        std::vector<extended_public_key> children;
+        children.reserve( count );
+        for( uint32_t n = 0; n < count; ++n )
+        {
+            const int i = first + n;
+            const detail::chr37 data = detail::_derive_message( key, i );
+            const fc::sha512 l = mac.digest( (const char*) data.data(), data.size() );
+            const fc::sha256 left = detail::_left(l);
+            FC_ASSERT( left < detail::get_curve_order() );
+            public_key_point_data child = point;
+            FC_ASSERT( secp256k1_ec_pubkey_tweak_add( detail::_get_context(), child.data(), child.size(),
+                                                      (unsigned char*) left.data() ) > 0 );
+            public_key_data compressed;
+            compressed[0] = 0x02 | ( child[64] & 1 );
+            memcpy( compressed.data() + 1, child.data() + 1, 32 );
+            children.emplace_back( public_key( compressed ), detail::_right(l), i, fp, depth + 1 );
+        }
+        return children;
+    }
+
     extended_private_key::extended_private_key( const private_key& k, const sha256& c,
                                                 int child, int parent, uint8_t depth )
         : private_key(k), c(c), child_num(child), parent_fp(parent), depth(depth) { }
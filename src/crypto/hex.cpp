@@ -1,37 +1,214 @@
 #include <fc/crypto/hex.hpp>
 #include <fc/exception/exception.hpp>
 
+#include "_cpu_features.hpp"
+
+#include <cstring>
+
+#ifdef FC_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace fc {
 
+    namespace {
+      const char hex_digits[] = "0123456789abcdef";
+
+      /** the value of every hex digit, 0xff for all other characters */
+      struct hex_values {
+        uint8_t v[256];
+        hex_values() {
+          memset( v, 0xff, sizeof(v) );
+          for( int i = 0; i < 10; ++i )
+            v['0' + i] = i;
+          for( int i = 0; i < 6; ++i )
+            v['a' + i] = v['A' + i] = 10 + i;
+        }
+      };
+
+      const hex_values& hex_value_table()
+      {
+        static const hex_values t;
+        return t;
+      }
+
+      /** encodes a prefix of in and returns the number of bytes consumed */
+      typedef size_t (*encode_kernel)( const uint8_t* in, size_t in_len, char* out );
+      /** decodes a valid prefix of in and returns the number of bytes produced */
+      typedef size_t (*decode_kernel)( const char* in, size_t in_len, uint8_t* out, size_t out_len );
+
+      size_t encode_scalar( const uint8_t*, size_t, char* ) { return 0; }
+      size_t decode_scalar( const char*, size_t, uint8_t*, size_t ) { return 0; }
+
+#ifdef FC_X86_SIMD
+      __attribute__((target("ssse3")))
+      inline __m128i hex_chars( __m128i nibbles )
+      {
+        return _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)hex_digits ), nibbles );
+      }
+
+      __attribute__((target("ssse3")))
+      size_t encode_ssse3( const uint8_t* in, size_t in_len, char* out )
+      {
+        const __m128i mask = _mm_set1_epi8( 0x0f );
+        size_t i = 0;
+        for( ; i + 16 <= in_len; i += 16 )
+        {
+          const __m128i v  = _mm_loadu_si128( (const __m128i*)(in + i) );
+          const __m128i hi = hex_chars( _mm_and_si128( _mm_srli_epi16( v, 4 ), mask ) );
+          const __m128i lo = hex_chars( _mm_and_si128( v, mask ) );
+          _mm_storeu_si128( (__m128i*)(out + 2 * i),      _mm_unpacklo_epi8( hi, lo ) );
+          _mm_storeu_si128( (__m128i*)(out + 2 * i + 16), _mm_unpackhi_epi8( hi, lo ) );
+        }
+        return i;
+      }
+
+      __attribute__((target("avx2")))
+      size_t encode_avx2( const uint8_t* in, size_t in_len, char* out )
+      {
+        const __m256i mask   = _mm256_set1_epi8( 0x0f );
+        const __m256i digits = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)hex_digits ) );
+        size_t i = 0;
+        for( ; i + 32 <= in_len; i += 32 )
+        {
+          const __m256i v  = _mm256_loadu_si256( (const __m256i*)(in + i) );
+          const __m256i hi = _mm256_shuffle_epi8( digits, _mm256_and_si256( _mm256_srli_epi16( v, 4 ), mask ) );
+          const __m256i lo = _mm256_shuffle_epi8( digits, _mm256_and_si256( v, mask ) );
+          // unpack works within 128 bit lanes, the permutes restore the byte order
+          const __m256i a  = _mm256_unpacklo_epi8( hi, lo );
+          const __m256i b  = _mm256_unpackhi_epi8( hi, lo );
+          _mm256_storeu_si256( (__m256i*)(out + 2 * i),      _mm256_permute2x128_si256( a, b, 0x20 ) );
+          _mm256_storeu_si256( (__m256i*)(out + 2 * i + 32), _mm256_permute2x128_si256( a, b, 0x31 ) );
+        }
+        return i + encode_ssse3( in + i, in_len - i, out + 2 * i );
+      }
+
+      /** converts 16 hex digits to their values, valid is set to all ones for every hex digit */
+      __attribute__((target("ssse3")))
+      inline __m128i hex_values_ssse3( __m128i c, __m128i& valid )
+      {
+        const __m128i digit  = _mm_sub_epi8( c, _mm_set1_epi8( '0' ) );
+        const __m128i letter = _mm_sub_epi8( _mm_or_si128( c, _mm_set1_epi8( 0x20 ) ), _mm_set1_epi8( 'a' ) );
+        const __m128i is_digit  = _mm_cmpeq_epi8( _mm_min_epu8( digit, _mm_set1_epi8( 9 ) ), digit );
+        const __m128i is_letter = _mm_cmpeq_epi8( _mm_min_epu8( letter, _mm_set1_epi8( 5 ) ), letter );
+        valid = _mm_or_si128( is_digit, is_letter );
+        return _mm_or_si128( _mm_and_si128( is_digit, digit ),
+                             _mm_andnot_si128( is_digit, _mm_add_epi8( letter, _mm_set1_epi8( 10 ) ) ) );
+      }
+
+      __attribute__((target("ssse3")))
+      size_t decode_ssse3( const char* in, size_t in_len, uint8_t* out, size_t out_len )
+      {
+        // high nibble * 16 + low nibble for every pair of digits
+        const __m128i merge = _mm_set1_epi16( 0x0110 );
+        size_t n = 0;
+        for( ; 2 * n + 32 <= in_len && n + 16 <= out_len; n += 16 )
+        {
+          __m128i valid0, valid1;
+          const __m128i v0 = hex_values_ssse3( _mm_loadu_si128( (const __m128i*)(in + 2 * n) ), valid0 );
+          const __m128i v1 = hex_values_ssse3( _mm_loadu_si128( (const __m128i*)(in + 2 * n + 16) ), valid1 );
+          if( _mm_movemask_epi8( _mm_and_si128( valid0, valid1 ) ) != 0xffff )
+            break;
+          _mm_storeu_si128( (__m128i*)(out + n),
+                            _mm_packus_epi16( _mm_maddubs_epi16( v0, merge ), _mm_maddubs_epi16( v1, merge ) ) );
+        }
+        return n;
+      }
+
+      __attribute__((target("avx2")))
+      inline __m256i hex_values_avx2( __m256i c, __m256i& valid )
+      {
+        const __m256i digit  = _mm256_sub_epi8( c, _mm256_set1_epi8( '0' ) );
+        const __m256i letter = _mm256_sub_epi8( _mm256_or_si256( c, _mm256_set1_epi8( 0x20 ) ), _mm256_set1_epi8( 'a' ) );
+        const __m256i is_digit  = _mm256_cmpeq_epi8( _mm256_min_epu8( digit, _mm256_set1_epi8( 9 ) ), digit );
+        const __m256i is_letter = _mm256_cmpeq_epi8( _mm256_min_epu8( letter, _mm256_set1_epi8( 5 ) ), letter );
+        valid = _mm256_or_si256( is_digit, is_letter );
+        return _mm256_blendv_epi8( _mm256_add_epi8( letter, _mm256_set1_epi8( 10 ) ), digit, is_digit );
+      }
+
+      __attribute__((target("avx2")))
+      size_t decode_avx2( const char* in, size_t in_len, uint8_t* out, size_t out_len )
+      {
+        const __m256i merge = _mm256_set1_epi16( 0x0110 );
+        size_t n = 0;
+        for( ; 2 * n + 64 <= in_len && n + 32 <= out_len; n += 32 )
+        {
+          __m256i valid0, valid1;
+          const __m256i v0 = hex_values_avx2( _mm256_loadu_si256( (const __m256i*)(in + 2 * n) ), valid0 );
+          const __m256i v1 = hex_values_avx2( _mm256_loadu_si256( (const __m256i*)(in + 2 * n + 32) ), valid1 );
+          if( _mm256_movemask_epi8( _mm256_and_si256( valid0, valid1 ) ) != -1 )
+            break;
+          // pack works within 128 bit lanes, the permute restores the byte order
+          const __m256i packed = _mm256_packus_epi16( _mm256_maddubs_epi16( v0, merge ), _mm256_maddubs_epi16( v1, merge ) );
+          _mm256_storeu_si256( (__m256i*)(out + n), _mm256_permute4x64_epi64( packed, 0xd8 ) );
+        }
+        return n + decode_ssse3( in + 2 * n, in_len - 2 * n, out + n, out_len - n );
+      }
+#endif
+
+      struct hex_kernels {
+        encode_kernel encode = encode_scalar;
+        decode_kernel decode = decode_scalar;
+        hex_kernels() {
+#ifdef FC_X86_SIMD
+          const auto& cpu = detail::get_cpu_features();
+          if( cpu.avx2 ) {
+            encode = encode_avx2;
+            decode = decode_avx2;
+          } else if( cpu.ssse3 ) {
+            encode = encode_ssse3;
+            decode = decode_ssse3;
+          }
+#endif
+        }
+      };
+
+      const hex_kernels& kernels()
+      {
+        static const hex_kernels k;
+        return k;
+      }
+    } // anonymous namespace
+
     uint8_t from_hex( char c ) {
-      if( c >= '0' && c <= '9' )
-        return c - '0';
-      if( c >= 'a' && c <= 'f' )
-          return c - 'a' + 10;
-      if( c >= 'A' && c <= 'F' )
-          return c - 'A' + 10;
-      FC_THROW_EXCEPTION( exception, "Invalid hex character '${c}'", ("c", std::string(&c,1) ) );
-      return 0;
+      const uint8_t v = hex_value_table().v[uint8_t(c)];
+      if( v == 0xff )
+        FC_THROW_EXCEPTION( exception, "Invalid hex character '${c}'", ("c", std::string(&c,1) ) );
+      return v;
+    }
+
+    size_t to_hex( const char* d, size_t s, char* out_data, size_t out_data_len )
+    {
+        FC_ASSERT( out_data_len / 2 >= s, "Output buffer too small for hex encoding" );
+        const uint8_t* c = (const uint8_t*)d;
+        size_t i = kernels().encode( c, s, out_data );
+        for( ; i < s; ++i )
+        {
+            out_data[2 * i]     = hex_digits[c[i] >> 4];
+            out_data[2 * i + 1] = hex_digits[c[i] & 0x0f];
+        }
+        return 2 * s;
     }
 
-    std::string to_hex( const char* d, uint32_t s ) 
+    std::string to_hex( const char* d, uint32_t s )
     {
-        std::string r;
-        const char* to_hex="0123456789abcdef";
-        uint8_t* c = (uint8_t*)d;
-        for( uint32_t i = 0; i < s; ++i )
-            (r += to_hex[(c[i]>>4)]) += to_hex[(c[i] &0x0f)];
+        std::string r( 2 * size_t(s), '\0' );
+        if( s )
+            to_hex( d, s, &r[0], r.size() );
         return r;
     }
 
-    size_t from_hex( const std::string& hex_str, char* out_data, size_t out_data_len ) {
-        std::string::const_iterator i = hex_str.begin();
+    size_t from_hex( const char* hex_str, size_t hex_len, char* out_data, size_t out_data_len ) {
         uint8_t* out_pos = (uint8_t*)out_data;
         uint8_t* out_end = out_pos + out_data_len;
-        while( i != hex_str.end() && out_end != out_pos ) {
-          *out_pos = from_hex( *i ) << 4;   
+        // the kernels stop in front of a block with invalid characters, the loop below reports them
+        out_pos += kernels().decode( hex_str, hex_len, out_pos, out_data_len );
+        const char* i   = hex_str + 2 * ( out_pos - (uint8_t*)out_data );
+        const char* end = hex_str + hex_len;
+        while( i != end && out_end != out_pos ) {
+          *out_pos = from_hex( *i ) << 4;
           ++i;
-          if( i != hex_str.end() )  {
+          if( i != end )  {
               *out_pos |= from_hex( *i );
               ++i;
           }
@@ -39,6 +216,11 @@ namespace fc {
         }
         return out_pos - (uint8_t*)out_data;
     }
+
+    size_t from_hex( const std::string& hex_str, char* out_data, size_t out_data_len ) {
+        return from_hex( hex_str.data(), hex_str.size(), out_data, out_data_len );
+    }
+
     std::string to_hex( const std::vector<char>& data )
     {
        if( data.size() )
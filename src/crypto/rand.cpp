@@ -1,19 +1,239 @@
 #include <openssl/rand.h>
+#include <fc/crypto/rand.hpp>
 #include <fc/crypto/openssl.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/fwd_impl.hpp>
 
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 namespace fc {
 
+namespace {
+
+  /** bumped in the child after a fork, the child must not repeat the output of its parent */
+  std::atomic<uint32_t> fork_generation( 0 );
+
+#ifndef _WIN32
+  void on_fork_child() { fork_generation.fetch_add( 1, std::memory_order_relaxed ); }
+#endif
+
+  void system_rand_bytes( unsigned char* buf, int count )
+  {
+    static int init = [] {
+#ifndef _WIN32
+      pthread_atfork( nullptr, nullptr, on_fork_child );
+#endif
+      return init_openssl();
+    }();
+    (void)init;
+
+    int result = RAND_bytes( buf, count );
+    if (result != 1)
+      FC_THROW("Error calling OpenSSL's RAND_bytes(): ${code}", ("code", (uint32_t)ERR_get_error()));
+  }
+
+  inline uint32_t rotl32( uint32_t v, int c ) { return ( v << c ) | ( v >> ( 32 - c ) ); }
+
+  inline uint32_t load32_le( const unsigned char* p )
+  {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+  }
+
+  inline void store32_le( unsigned char* p, uint32_t v )
+  {
+    p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); p[2] = uint8_t(v >> 16); p[3] = uint8_t(v >> 24);
+  }
+
+#define FC_CHACHA_QUARTERROUND(a,b,c,d) \
+    a += b; d = rotl32( d ^ a, 16 ); \
+    c += d; b = rotl32( b ^ c, 12 ); \
+    a += b; d = rotl32( d ^ a,  8 ); \
+    c += d; b = rotl32( b ^ c,  7 );
+
+  /** the ChaCha20 block function of RFC 7539 */
+  void chacha20_block( const uint32_t input[16], unsigned char out[64] )
+  {
+    uint32_t x[16];
+    memcpy( x, input, sizeof(x) );
+    for( int i = 0; i < 10; ++i )
+    {
+      FC_CHACHA_QUARTERROUND( x[0], x[4], x[ 8], x[12] )
+      FC_CHACHA_QUARTERROUND( x[1], x[5], x[ 9], x[13] )
+      FC_CHACHA_QUARTERROUND( x[2], x[6], x[10], x[14] )
+      FC_CHACHA_QUARTERROUND( x[3], x[7], x[11], x[15] )
+      FC_CHACHA_QUARTERROUND( x[0], x[5], x[10], x[15] )
+      FC_CHACHA_QUARTERROUND( x[1], x[6], x[11], x[12] )
+      FC_CHACHA_QUARTERROUND( x[2], x[7], x[ 8], x[13] )
+      FC_CHACHA_QUARTERROUND( x[3], x[4], x[ 9], x[14] )
+    }
+    for( int i = 0; i < 16; ++i )
+      store32_le( out + 4 * i, x[i] + input[i] );
+  }
+#undef FC_CHACHA_QUARTERROUND
+
+  /**
+   *  A ChaCha20 based deterministic random bit generator with fast key erasure: the first
+   *  32 bytes of every refill of the buffer replace the key, and handed out bytes are wiped
+   *  from the buffer, so a later compromise of the state does not reveal earlier output.
+   *  The key is replaced by fresh bytes of RAND_bytes after reseed_interval bytes and after
+   *  a fork.
+   */
+  class chacha20_drbg
+  {
+    public:
+      static const size_t   key_size        = 32;
+      static const size_t   buffer_size     = 16 * 64;
+      static const uint64_t reseed_interval = 1024 * 1024;
+
+      chacha20_drbg()
+      {
+        // "expand 32-byte k"
+        state[0] = 0x61707865; state[1] = 0x3320646e; state[2] = 0x79622d32; state[3] = 0x6b206574;
+      }
+
+      ~chacha20_drbg()
+      {
+        wipe( state, sizeof(state) );
+        wipe( buffer, sizeof(buffer) );
+      }
+
+      void read( unsigned char* out, size_t len )
+      {
+        check_seed( len );
+        while( len > 0 )
+        {
+          if( available == 0 )
+            refill();
+          const size_t n = std::min( len, available );
+          unsigned char* from = buffer + buffer_size - available;
+          memcpy( out, from, n );
+          wipe( from, n );
+          available -= n;
+          out += n;
+          len -= n;
+        }
+      }
+
+      /** writes the key stream directly to out, then replaces the key */
+      void fill( unsigned char* out, size_t len )
+      {
+        check_seed( len );
+        // nonce 1 separates this stream from the one of refill()
+        set_counter_and_nonce( 0, 1 );
+        for( ; len >= 64; len -= 64, out += 64 )
+        {
+          chacha20_block( state, out );
+          next_block();
+        }
+        if( len > 0 )
+        {
+          unsigned char last[64];
+          chacha20_block( state, last );
+          memcpy( out, last, len );
+          wipe( last, sizeof(last) );
+        }
+        available = 0;
+        refill();
+      }
+
+    private:
+      static void wipe( void* p, size_t len )
+      {
+        volatile unsigned char* v = static_cast<volatile unsigned char*>( p );
+        while( len-- )
+          *v++ = 0;
+      }
+
+      void check_seed( size_t len )
+      {
+        const uint32_t generation = fork_generation.load( std::memory_order_relaxed );
+        if( !seeded || generation != seed_generation || since_seed + len > reseed_interval )
+        {
+          unsigned char key[key_size];
+          system_rand_bytes( key, sizeof(key) );
+          set_key( key );
+          wipe( key, sizeof(key) );
+          wipe( buffer, sizeof(buffer) );
+          available       = 0;
+          since_seed      = 0;
+          seed_generation = generation;
+          seeded          = true;
+        }
+        since_seed += len;
+      }
+
+      void set_key( const unsigned char* key )
+      {
+        for( int i = 0; i < 8; ++i )
+          state[4 + i] = load32_le( key + 4 * i );
+      }
+
+      void set_counter_and_nonce( uint64_t counter, uint64_t nonce )
+      {
+        state[12] = uint32_t( counter ); state[13] = uint32_t( counter >> 32 );
+        state[14] = uint32_t( nonce );   state[15] = uint32_t( nonce >> 32 );
+      }
+
+      void next_block()
+      {
+        if( ++state[12] == 0 )
+          ++state[13];
+      }
+
+      void refill()
+      {
+        set_counter_and_nonce( 0, 0 );
+        for( size_t i = 0; i < buffer_size; i += 64 )
+        {
+          chacha20_block( state, buffer + i );
+          next_block();
+        }
+        set_key( buffer );
+        wipe( buffer, key_size );
+        available = buffer_size - key_size;
+      }
+
+      uint32_t      state[16];
+      unsigned char buffer[buffer_size];
+      size_t        available       = 0;
+      uint64_t      since_seed      = 0;
+      uint32_t      seed_generation = 0;
+      bool          seeded          = false;
+  };
+
+  /** requests of this size and larger bypass the buffer */
+  const size_t bulk_size = 256;
+
+  chacha20_drbg& thread_drbg()
+  {
+    static thread_local chacha20_drbg drbg;
+    return drbg;
+  }
+
+} // anonymous namespace
+
 void rand_bytes(char* buf, int count)
 {
-  static int init = init_openssl();
-  (void)init;
+  FC_ASSERT( count >= 0, "Negative number of random bytes requested" );
+  if( size_t(count) >= bulk_size )
+    thread_drbg().fill( (unsigned char*)buf, count );
+  else
+    thread_drbg().read( (unsigned char*)buf, count );
+}
 
-  int result = RAND_bytes((unsigned char*)buf, count);
-  if (result != 1)
-    FC_THROW("Error calling OpenSSL's RAND_bytes(): ${code}", ("code", (uint32_t)ERR_get_error()));
+void rand_fill(char* buf, size_t count)
+{
+  thread_drbg().fill( (unsigned char*)buf, count );
+}
+
+void rand_system_bytes(char* buf, int count)
+{
+  system_rand_bytes( (unsigned char*)buf, count );
 }
 
 }  // namespace fc
@@ -0,0 +1,186 @@
+#include <fc/crypto/recovery_cache.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/thread/scoped_lock.hpp>
+
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace fc { namespace ecc {
+
+   namespace {
+
+      struct entry
+      {
+         fc::sha256        digest;
+         compact_signature sig;
+         public_key_data   key;
+         uint64_t          hash       = 0;
+         bool              referenced = false;
+      };
+
+      struct shard
+      {
+         boost::mutex                            lock;
+         std::vector<entry>                      slots;
+         size_t                                  used = 0;
+         size_t                                  hand = 0;
+         std::unordered_map<uint64_t, uint32_t>  index;
+         uint64_t                                hits      = 0;
+         uint64_t                                misses    = 0;
+         uint64_t                                evictions = 0;
+
+         /** @return the next slot without a second chance */
+         uint32_t evict()
+         {
+            while( slots[hand].referenced )
+            {
+               slots[hand].referenced = false;
+               hand = ( hand + 1 ) % slots.size();
+            }
+            const uint32_t victim = hand;
+            hand = ( hand + 1 ) % slots.size();
+            index.erase( slots[victim].hash );
+            ++evictions;
+            return victim;
+         }
+      };
+
+      std::shared_ptr<recovery_cache>& installed_cache()
+      {
+         static std::shared_ptr<recovery_cache> cache;
+         return cache;
+      }
+
+   } // anonymous namespace
+
+   class recovery_cache::impl
+   {
+      public:
+         impl( size_t capacity, size_t shard_count )
+         {
+            FC_ASSERT( capacity > 0 && shard_count > 0 );
+            rand_bytes( salt, sizeof(salt) );
+            shard_count = std::min( shard_count, capacity );
+            const size_t per_shard = ( capacity + shard_count - 1 ) / shard_count;
+            for( size_t i = 0; i < shard_count; ++i )
+            {
+               shards.emplace_back( new shard );
+               shards.back()->slots.resize( per_shard );
+               shards.back()->index.reserve( per_shard );
+            }
+         }
+
+         uint64_t hash( const fc::sha256& digest, const compact_signature& sig )const
+         {
+            char buffer[sizeof(salt) + sizeof(fc::sha256) + sizeof(compact_signature)];
+            memcpy( buffer, salt, sizeof(salt) );
+            memcpy( buffer + sizeof(salt), digest.data(), digest.data_size() );
+            memcpy( buffer + sizeof(salt) + digest.data_size(), sig.data(), sig.size() );
+            return city_hash64( buffer, sizeof(buffer) );
+         }
+
+         shard& shard_for( uint64_t h )
+         {
+            // the index is keyed by the low bits, pick the shard with the others
+            return *shards[ ( h >> 32 ) % shards.size() ];
+         }
+
+         char                                 salt[16];
+         std::vector<std::unique_ptr<shard>>  shards;
+   };
+
+   recovery_cache::recovery_cache( size_t capacity, size_t shards )
+      : my( new impl( capacity, shards ) ) {}
+
+   recovery_cache::~recovery_cache() {}
+
+   bool recovery_cache::get( const fc::sha256& digest, const compact_signature& sig, public_key_data& key )
+   {
+      const uint64_t h = my->hash( digest, sig );
+      shard& s = my->shard_for( h );
+      scoped_lock<boost::mutex> lock( s.lock );
+      const auto itr = s.index.find( h );
+      if( itr != s.index.end() )
+      {
+         entry& e = s.slots[itr->second];
+         if( e.digest == digest && e.sig == sig )
+         {
+            e.referenced = true;
+            key = e.key;
+            ++s.hits;
+            return true;
+         }
+      }
+      ++s.misses;
+      return false;
+   }
+
+   void recovery_cache::put( const fc::sha256& digest, const compact_signature& sig, const public_key_data& key )
+   {
+      const uint64_t h = my->hash( digest, sig );
+      shard& s = my->shard_for( h );
+      scoped_lock<boost::mutex> lock( s.lock );
+      uint32_t slot;
+      const auto itr = s.index.find( h );
+      if( itr != s.index.end() )
+         slot = itr->second; // same entry, or one with a colliding hash that gets replaced
+      else
+      {
+         slot = s.used < s.slots.size() ? s.used++ : s.evict();
+         s.index.emplace( h, slot );
+      }
+      entry& e = s.slots[slot];
+      e.digest = digest;
+      e.sig    = sig;
+      e.key    = key;
+      e.hash   = h;
+      // entries earn their second chance with a hit, which keeps one-time lookups from
+      // pushing out the working set
+      e.referenced = false;
+   }
+
+   void recovery_cache::clear()
+   {
+      for( auto& s : my->shards )
+      {
+         scoped_lock<boost::mutex> lock( s->lock );
+         s->index.clear();
+         for( auto& e : s->slots )
+            e.referenced = false;
+         s->used = 0;
+         s->hand = 0;
+      }
+   }
+
+   recovery_cache::stats recovery_cache::get_stats()const
+   {
+      stats result;
+      for( auto& s : my->shards )
+      {
+         scoped_lock<boost::mutex> lock( s->lock );
+         result.hits      += s->hits;
+         result.misses    += s->misses;
+         result.evictions += s->evictions;
+         result.size      += s->index.size();
+      }
+      return result;
+   }
+
+   void recovery_cache::install( std::shared_ptr<recovery_cache> cache )
+   {
+      std::atomic_store( &installed_cache(), std::move( cache ) );
+   }
+
+   std::shared_ptr<recovery_cache> recovery_cache::installed()
+   {
+      return std::atomic_load( &installed_cache() );
+   }
+
+} } // fc::ecc
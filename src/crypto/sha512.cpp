@@ -30,6 +30,11 @@ namespace fc {
     sha512::encoder::encoder() {
       reset();
     }
+    sha512::encoder::encoder( const encoder& e ) : my( e.my ) {}
+    sha512::encoder& sha512::encoder::operator=( const encoder& e ) {
+      my->ctx = e.my->ctx;
+      return *this;
+    }
 
     sha512 sha512::hash( const char* d, uint32_t dlen ) {
       encoder e;
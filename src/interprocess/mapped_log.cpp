@@ -0,0 +1,285 @@
+#include <fc/interprocess/mapped_log.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/crypto/crc32c.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/endian/buffers.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace fc {
+
+  namespace {
+
+    struct record_header {
+      boost::endian::little_uint32_buf_t size;
+      boost::endian::little_uint32_buf_t crc;
+    };
+    static_assert( sizeof(record_header) == mapped_log_base::header_size, "unexpected header padding" );
+
+    uint32_t record_crc( const record_header& h, const char* payload, uint32_t size )
+    {
+      return crc32c( payload, size, crc32c( (const char*)h.size.data(), sizeof(h.size) ) );
+    }
+
+    bool is_zero( const char* p, size_t len )
+    {
+      for( size_t i = 0; i < len; ++i )
+        if( p[i] )
+          return false;
+      return true;
+    }
+
+    fc::path segment_file( const fc::path& dir, uint32_t number )
+    {
+      char name[32];
+      snprintf( name, sizeof(name), "%08u.seg", number );
+      return dir / name;
+    }
+
+  } // anonymous namespace
+
+  class mapped_log_base::impl {
+    public:
+      struct segment {
+        fc::path                       file;
+        std::unique_ptr<file_mapping>  mapping;
+        std::unique_ptr<mapped_region> region;
+        char*                          base = nullptr;
+        uint32_t                       size = 0;
+      };
+
+      struct location {
+        uint32_t segment;
+        uint32_t offset;
+      };
+
+      impl( const fc::path& d, uint32_t seg_size, mode_t m ) : dir(d), segment_size(seg_size), mode(m)
+      {
+        FC_ASSERT( mode == read_write || mode == read_only, "A log cannot be opened write only" );
+        FC_ASSERT( segment_size > header_size, "Segment size must be larger than the record header" );
+        if( mode == read_only )
+        {
+          FC_ASSERT( fc::is_directory( dir ), "Log ${d} does not exist", ("d",dir) );
+          scan();
+          return;
+        }
+        if( !fc::exists( dir ) )
+          fc::create_directories( dir );
+        recover();
+      }
+
+      void open_segment( uint32_t number, bool create )
+      {
+        segment seg;
+        seg.file = segment_file( dir, number );
+        if( create )
+        {
+          // sized under another name, so that a crash never leaves a short segment behind
+          const fc::path tmp = seg.file.generic_string() + ".tmp";
+          { fc::ofstream touch( tmp ); }
+          fc::resize_file( tmp, segment_size );
+          fc::rename( tmp, seg.file );
+        }
+        const uint64_t file_size = fc::file_size( seg.file );
+        FC_ASSERT( file_size > header_size && file_size <= UINT32_MAX,
+                   "Invalid log segment size ${s} of ${f}", ("s",file_size)("f",seg.file) );
+        seg.size    = static_cast<uint32_t>( file_size );
+        seg.mapping.reset( new file_mapping( seg.file.generic_string().c_str(), mode ) );
+        seg.region.reset( new mapped_region( *seg.mapping, mode ) );
+        seg.base    = static_cast<char*>( seg.region->get_address() );
+        segments.push_back( std::move(seg) );
+      }
+
+      /** @return the offset after the last valid record of seg, adding the records to the index */
+      uint32_t index_segment( uint32_t number, const segment& seg )
+      {
+        uint32_t pos = 0;
+        while( seg.size - pos >= header_size )
+        {
+          const record_header& h = *reinterpret_cast<const record_header*>( seg.base + pos );
+          const uint32_t size = h.size.value();
+          if( size > seg.size - pos - header_size
+              || h.crc.value() != record_crc( h, seg.base + pos + header_size, size ) )
+            break;
+          index.push_back( location{ number, pos } );
+          pos += header_size + size;
+        }
+        return pos;
+      }
+
+      /** builds the index up to the first invalid record, without modifying anything */
+      void scan()
+      {
+        for( uint32_t number = 0; fc::exists( segment_file( dir, number ) ); ++number )
+        {
+          if( fc::file_size( segment_file( dir, number ) ) <= header_size )
+          {
+            damaged = true;
+            return;
+          }
+          open_segment( number, false );
+          const segment& seg = segments.back();
+          const uint32_t pos = index_segment( number, seg );
+          if( !is_zero( seg.base + pos, seg.size - pos ) )
+          {
+            damaged = true;
+            return;
+          }
+        }
+      }
+
+      /** scans all segments, rebuilds the index and cuts the log after the last valid record */
+      void recover()
+      {
+        uint32_t number = 0;
+        while( fc::exists( segment_file( dir, number ) ) )
+        {
+          // logs written before segments were created under a temporary name can end in a
+          // segment which a crash left empty
+          if( fc::file_size( segment_file( dir, number ) ) <= header_size )
+          {
+            remove_segments_from( number );
+            damaged = true;
+            break;
+          }
+          open_segment( number, false );
+          segment& seg = segments.back();
+          const uint32_t pos = index_segment( number, seg );
+
+          ++number;
+          // unused space at the end of a segment is zero, anything else is a damaged record
+          if( !is_zero( seg.base + pos, seg.size - pos ) )
+          {
+            wlog( "Truncating log segment ${f} after damaged record at offset ${p}", ("f",seg.file)("p",pos) );
+            memset( seg.base + pos, 0, seg.size - pos );
+            seg.region->flush();
+            remove_segments_from( number );
+            write_pos = pos;
+            damaged = true;
+            return;
+          }
+          write_pos = pos;
+        }
+        if( segments.empty() )
+        {
+          open_segment( 0, true );
+          write_pos = 0;
+        }
+      }
+
+      /** removes the segments from number on, they are damaged or follow a damaged record */
+      void remove_segments_from( uint32_t number )
+      {
+        while( fc::exists( segment_file( dir, number ) ) )
+        {
+          wlog( "Discarding damaged log segment ${f}", ("f",segment_file( dir, number )) );
+          fc::remove( segment_file( dir, number ) );
+          ++number;
+        }
+      }
+
+      char* prepare( uint32_t size )
+      {
+        FC_ASSERT( mode == read_write, "The log is read only" );
+        segment* seg = &segments.back();
+        // an abandoned record must not be mistaken for damage when the log is reopened
+        if( prepared )
+          memset( seg->base + write_pos + header_size, 0, prepared_size );
+        FC_ASSERT( size <= segment_size - header_size && size <= UINT32_MAX - header_size,
+                   "Record of ${s} bytes does not fit into a log segment", ("s",size) );
+        if( uint64_t(size) + header_size > seg->size - write_pos )
+        {
+          // finish the current segment before starting the next, so that recovery never sees
+          // a later segment next to a partially written one
+          seg->region->flush();
+          open_segment( static_cast<uint32_t>( segments.size() ), true );
+          write_pos = 0;
+          seg = &segments.back();
+        }
+        prepared_size = size;
+        prepared = true;
+        return seg->base + write_pos + header_size;
+      }
+
+      uint64_t commit()
+      {
+        FC_ASSERT( prepared, "No record has been prepared" );
+        segment& seg = segments.back();
+        record_header& h = *reinterpret_cast<record_header*>( seg.base + write_pos );
+        h.size = prepared_size;
+        h.crc  = record_crc( h, seg.base + write_pos + header_size, prepared_size );
+        index.push_back( location{ static_cast<uint32_t>( segments.size() - 1 ), write_pos } );
+        write_pos += header_size + prepared_size;
+        prepared = false;
+        return index.size() - 1;
+      }
+
+      fc::path              dir;
+      uint32_t              segment_size;
+      mode_t                mode;
+      std::vector<segment>  segments;
+      std::vector<location> index;
+      uint32_t              write_pos = 0;
+      uint32_t              prepared_size = 0;
+      bool                  prepared = false;
+      bool                  damaged = false;
+  };
+
+  constexpr uint32_t mapped_log_base::header_size;
+  constexpr uint32_t mapped_log_base::default_segment_size;
+
+  mapped_log_base::mapped_log_base( const fc::path& dir, uint32_t segment_size, mode_t mode )
+    : my( new impl( dir, segment_size, mode ) ) {}
+
+  mapped_log_base::~mapped_log_base() {}
+
+  uint64_t mapped_log_base::size()const
+  {
+    return my->index.size();
+  }
+
+  mapped_log_base::record_view mapped_log_base::view( uint64_t index )const
+  {
+    FC_ASSERT( index < my->index.size(), "Record ${i} does not exist", ("i",index) );
+    const impl::location& loc = my->index[index];
+    const char* p = my->segments[loc.segment].base + loc.offset;
+    return record_view{ p + header_size, reinterpret_cast<const record_header*>( p )->size.value() };
+  }
+
+  char* mapped_log_base::prepare( uint32_t size )
+  {
+    return my->prepare( size );
+  }
+
+  uint64_t mapped_log_base::commit()
+  {
+    return my->commit();
+  }
+
+  uint64_t mapped_log_base::append( const char* data, uint32_t size )
+  {
+    char* p = my->prepare( size );
+    if( size )
+      memcpy( p, data, size );
+    return my->commit();
+  }
+
+  void mapped_log_base::flush()
+  {
+    if( my->mode == read_only )
+      return;
+    // earlier segments have been flushed when the log moved on to the next one
+    my->segments.back().region->flush();
+  }
+
+  bool mapped_log_base::recovered()const
+  {
+    return my->damaged;
+  }
+
+}
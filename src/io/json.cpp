@@ -26,7 +26,7 @@ namespace fc
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in, uint32_t max_depth );
     template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
     template<typename T> variant token_from_stream( T& in );
-    void escape_string( const string& str, ostream& os );
+    void escape_string( const boost::string_view& str, ostream& os );
     template<typename T> void to_stream( T& os, const variants& a, json::output_formatting format, uint32_t max_depth );
     template<typename T> void to_stream( T& os, const variant_object& o, json::output_formatting format, uint32_t max_depth );
     template<typename T> void to_stream( T& os, const variant& v, json::output_formatting format, uint32_t max_depth );
@@ -491,7 +491,7 @@ namespace fc
     *  * other control characters are printed as UTF8
     *  * printable characters are printed as is
     */
-   void escape_string( const string& str, ostream& os )
+   void escape_string( const boost::string_view& str, ostream& os )
    {
       os << '"';
       for( auto itr = str.begin(); itr != str.end(); ++itr )
@@ -631,7 +631,7 @@ namespace fc
               os << v.as_string();
               return;
          case variant::string_type:
-              escape_string( v.get_string(), os );
+              escape_string( v.get_string_view(), os );
               return;
          case variant::blob_type:
               escape_string( v.as_string(), os );
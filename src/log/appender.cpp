@@ -8,6 +8,7 @@
 #include <fc/log/console_appender.hpp>
 #include <fc/log/file_appender.hpp>
 #include <fc/log/gelf_appender.hpp>
+#include <fc/log/binary_appender.hpp>
 #include <fc/variant.hpp>
 #include "console_defines.h"
 
@@ -47,5 +48,6 @@ namespace fc {
    static bool reg_console_appender = appender::register_appender<console_appender>( "console" );
    static bool reg_file_appender = appender::register_appender<file_appender>( "file" );
    static bool reg_gelf_appender = appender::register_appender<gelf_appender>( "gelf" );
+   static bool reg_binary_appender = appender::register_appender<binary_appender>( "binary" );
 
 } // namespace fc
@@ -0,0 +1,351 @@
+#include <fc/log/binary_appender.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/thread/scoped_lock.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace fc {
+
+   namespace {
+
+      uint64_t hash_append( uint64_t h, const char* data, size_t size )
+      {
+         return h * 0x9e3779b97f4a7c15ull + city_hash64( data, size );
+      }
+      uint64_t hash_append( uint64_t h, const std::string& s ) { return hash_append( h, s.data(), s.size() ); }
+
+      bool contains_double( const variant& v )
+      {
+         switch( v.get_type() )
+         {
+            case variant::double_type:
+               return true;
+            case variant::array_type:
+               for( const auto& item : v.get_array() )
+                  if( contains_double( item ) )
+                     return true;
+               return false;
+            case variant::object_type:
+               for( const auto& entry : v.get_object() )
+                  if( contains_double( entry.value() ) )
+                     return true;
+               return false;
+            default:
+               return false;
+         }
+      }
+
+      /** fc::raw does not pack doubles, they are written as the strings they are rendered as */
+      variant without_doubles( const variant& v )
+      {
+         switch( v.get_type() )
+         {
+            case variant::double_type:
+               return v.as_string();
+            case variant::array_type:
+            {
+               variants items;
+               items.reserve( v.get_array().size() );
+               for( const auto& item : v.get_array() )
+                  items.push_back( without_doubles( item ) );
+               return items;
+            }
+            case variant::object_type:
+            {
+               mutable_variant_object object;
+               for( const auto& entry : v.get_object() )
+                  object( entry.key(), without_doubles( entry.value() ) );
+               return variant( std::move( object ) );
+            }
+            default:
+               return v;
+         }
+      }
+
+   } // anonymous namespace
+
+   class binary_appender::impl
+   {
+      public:
+         impl( const config& c ) : cfg( c ), _interval_seconds( cfg.rotation_interval.to_seconds() )
+         {
+            try
+            {
+               fc::create_directories( cfg.directory );
+               if( cfg.rotate )
+               {
+                  FC_ASSERT( cfg.rotation_interval >= seconds( 1 ) );
+                  FC_ASSERT( cfg.rotation_limit >= cfg.rotation_interval );
+               }
+               open_log( time_point::now() );
+            }
+            catch( ... )
+            {
+               std::cerr << "error opening binary log: " << cfg.directory.preferred_string() << "\n";
+            }
+         }
+
+         ~impl()
+         {
+            if( log )
+               log->flush();
+         }
+
+         /** starts the log for the interval containing now, and removes logs past the rotation limit */
+         void open_log( const time_point& now )
+         {
+            if( log )
+               log->flush();
+            log.reset();
+            formats.clear();
+            names.clear();
+            if( !cfg.rotate )
+            {
+               log.reset( new mapped_log_base( cfg.directory, cfg.segment_size ) );
+               return;
+            }
+
+            const time_point_sec start( uint32_t( now.sec_since_epoch() / _interval_seconds * _interval_seconds ) );
+            _next_log_time = start + _interval_seconds;
+            log.reset( new mapped_log_base( cfg.directory / start.to_non_delimited_iso_string(), cfg.segment_size ) );
+
+            const time_point_sec limit = time_point_sec( now ) - cfg.rotation_limit.to_seconds();
+            for( directory_iterator itr( cfg.directory ); itr != directory_iterator(); ++itr )
+            {
+               try
+               {
+                  if( fc::is_directory( *itr ) && time_point_sec::from_iso_string( itr->filename().string() ) < limit )
+                     remove_all( *itr );
+               }
+               catch( ... )
+               {
+               }
+            }
+         }
+
+         template<typename T>
+         void append( const T& value )
+         {
+            const binary_log::record r( value );
+            const size_t size = raw::pack_size( r );
+            datastream<char*> ds( log->prepare( size ), size );
+            raw::pack( ds, r );
+            log->commit();
+         }
+
+         /** @return the id of the format of m, defining it if necessary */
+         uint32_t format_id( const log_message& m, const log_context& context, const variant_object& data )
+         {
+            const std::string& format = m.get_format();
+            const char*        file   = context.get_file_c_str();
+            const char*        method = context.get_method_c_str();
+            const uint64_t     line   = context.get_line_number();
+            const uint8_t      level  = uint8_t( int( context.get_log_level() ) );
+
+            uint64_t h = hash_append( line * 8 + level, format );
+            h = hash_append( h, file, strlen( file ) );
+            h = hash_append( h, method, strlen( method ) );
+            for( const auto& entry : data )
+               h = hash_append( h, entry.key() );
+
+            auto range = formats.equal_range( h );
+            for( auto itr = range.first; itr != range.second; ++itr )
+            {
+               const binary_log::format_definition& def = itr->second;
+               if( def.line == line && def.level == level && def.format == format && def.file == file
+                   && def.method == method && def.arg_names.size() == data.size()
+                   && std::equal( data.begin(), data.end(), def.arg_names.begin(),
+                                  []( const variant_object::entry& e, const std::string& name ) { return e.key() == name; } ) )
+                  return def.id.value;
+            }
+
+            binary_log::format_definition def;
+            def.id     = uint32_t( formats.size() );
+            def.level  = level;
+            def.format = format;
+            def.file   = file;
+            def.line   = line;
+            def.method = method;
+            for( const auto& entry : data )
+               def.arg_names.push_back( entry.key() );
+            append( def );
+            formats.emplace( h, def );
+            return def.id;
+         }
+
+         /** @return the id of the name, defining it if necessary */
+         uint32_t name_id( const std::string& name )
+         {
+            auto itr = names.find( name );
+            if( itr != names.end() )
+               return itr->second;
+            binary_log::name_definition def;
+            def.id   = uint32_t( names.size() );
+            def.name = name;
+            append( def );
+            names[name] = def.id;
+            return def.id;
+         }
+
+         bool rotation_due( const time_point& now )const { return cfg.rotate && now >= _next_log_time; }
+
+         config                                    cfg;
+         boost::mutex                              slock;
+         std::unique_ptr<mapped_log_base>          log;
+         /** the definitions of the current log, formats by the hash of their call site */
+         std::unordered_multimap<uint64_t, binary_log::format_definition> formats;
+         std::unordered_map<std::string, uint32_t> names;
+
+      private:
+         const int64_t                             _interval_seconds;
+         time_point                                _next_log_time;
+   };
+
+   binary_appender::config::config( const fc::path& p ) :
+     directory( p )
+   {}
+
+   binary_appender::binary_appender( const variant& args ) :
+     my( new impl( args.as<config>( FC_MAX_LOG_OBJECT_DEPTH ) ) )
+   {}
+
+   binary_appender::binary_appender( const config& cfg ) :
+     my( new impl( cfg ) )
+   {}
+
+   binary_appender::~binary_appender(){}
+
+   void binary_appender::log( const log_message& m )
+   {
+      const log_context context = m.get_context();
+      const variant_object data = m.get_data();
+
+      fc::scoped_lock<boost::mutex> lock( my->slock );
+      try
+      {
+         const time_point now = time_point::now();
+         if( my->rotation_due( now ) )
+            my->open_log( now );
+         if( !my->log )
+            return;
+
+         const uint32_t format  = my->format_id( m, context, data );
+         const uint32_t thread  = my->name_id( context.get_thread_name() );
+         const uint32_t context_name = my->name_id( context.get_context() );
+
+         // packed like a binary_log::record holding a binary_log::event, without copying the args
+         const unsigned_int which( binary_log::record::tag<binary_log::event>::value );
+         size_t size = raw::pack_size( which ) + raw::pack_size( context.get_timestamp() )
+                       + raw::pack_size( unsigned_int( format ) ) + raw::pack_size( unsigned_int( thread ) )
+                       + raw::pack_size( unsigned_int( context_name ) ) + raw::pack_size( unsigned_int( data.size() ) );
+         // the args are copied only if they contain doubles
+         variant_object args = data;
+         for( const auto& entry : data )
+            if( contains_double( entry.value() ) )
+            {
+               args = without_doubles( variant( data ) ).get_object();
+               break;
+            }
+         for( const auto& entry : args )
+            size += raw::pack_size( entry.value() );
+
+         datastream<char*> ds( my->log->prepare( size ), size );
+         raw::pack( ds, which );
+         raw::pack( ds, context.get_timestamp() );
+         raw::pack( ds, unsigned_int( format ) );
+         raw::pack( ds, unsigned_int( thread ) );
+         raw::pack( ds, unsigned_int( context_name ) );
+         raw::pack( ds, unsigned_int( data.size() ) );
+         for( const auto& entry : args )
+            raw::pack( ds, entry.value() );
+         my->log->commit();
+
+         if( my->cfg.flush )
+            my->log->flush();
+      }
+      catch( const fc::exception& e )
+      {
+         std::cerr << "error writing binary log: " << e.to_string() << "\n";
+      }
+      catch( const std::exception& e )
+      {
+         std::cerr << "error writing binary log: " << e.what() << "\n";
+      }
+   }
+
+   namespace binary_log {
+
+      void read( const fc::path& directory, const std::function<void( const log_message& )>& f )
+      {
+         // a rotated log keeps one log per interval in subdirectories, named so that they sort by time
+         std::vector<fc::path> logs;
+         for( directory_iterator itr( directory ); itr != directory_iterator(); ++itr )
+            if( fc::is_directory( *itr ) )
+               logs.push_back( *itr );
+         std::sort( logs.begin(), logs.end() );
+         if( logs.empty() )
+            logs.push_back( directory );
+
+         for( const auto& dir : logs )
+         {
+            // a definition replaces an earlier one with the same id, which a reopened log contains
+            std::unordered_map<uint32_t, format_definition> formats;
+            std::unordered_map<uint32_t, std::string>       names;
+            auto name = [&names]( uint32_t id ) {
+               auto itr = names.find( id );
+               FC_ASSERT( itr != names.end(), "Undefined name ${id}", ("id",id) );
+               return itr->second;
+            };
+
+            // the appender may still be writing to the log
+            mapped_log<record> log( dir, mapped_log_base::default_segment_size, read_only );
+            log.visit( [&]( uint64_t index, const record& r ) {
+               if( r.which() == record::tag<format_definition>::value )
+               {
+                  const auto& def = r.get<format_definition>();
+                  formats[def.id] = def;
+               }
+               else if( r.which() == record::tag<name_definition>::value )
+               {
+                  const auto& def = r.get<name_definition>();
+                  names[def.id] = def.name;
+               }
+               else
+               {
+                  const auto& e = r.get<event>();
+                  auto itr = formats.find( e.format );
+                  FC_ASSERT( itr != formats.end(), "Undefined format ${id} in record ${i}", ("id",e.format.value)("i",index) );
+                  const format_definition& def = itr->second;
+                  FC_ASSERT( def.arg_names.size() == e.args.size(), "Wrong number of arguments in record ${i}", ("i",index) );
+
+                  mutable_variant_object context;
+                  context( "level",       variant( log_level( def.level ), 1 ) )
+                         ( "file",        def.file )
+                         ( "line",        def.line )
+                         ( "method",      def.method )
+                         ( "hostname",    "" )
+                         ( "thread_name", name( e.thread_name ) )
+                         ( "timestamp",   variant( e.timestamp, 1 ) )
+                         ( "context",     name( e.context ) );
+                  mutable_variant_object args;
+                  for( size_t i = 0; i < e.args.size(); ++i )
+                     args( def.arg_names[i], e.args[i] );
+                  f( log_message( log_context( variant( context ), FC_MAX_LOG_OBJECT_DEPTH ), def.format, variant_object( std::move( args ) ) ) );
+               }
+            } );
+         }
+      }
+
+   } // namespace binary_log
+
+} // namespace fc
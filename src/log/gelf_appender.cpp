@@ -11,8 +11,14 @@
 #include <fc/compress/zlib.hpp>
 
 #include <boost/lexical_cast.hpp>
+#include <boost/scope_exit.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <queue>
 #include <sstream>
 #include <iostream>
@@ -20,6 +26,14 @@
 namespace fc 
 {
 
+  // packets are sent by UDP, and they tend to disappear if they
+  // get too large.  It's hard to find any solid numbers on how
+  // large they can be before they get dropped -- datagrams can
+  // be up to 64k, but anything over 512 is not guaranteed.
+  // You can play with this number, intermediate values like
+  // 1400 and 8100 are likely to work on most intranets.
+  const unsigned max_payload_size = 512;
+
   class gelf_appender::impl
   {
   public:
@@ -27,6 +41,18 @@ namespace fc
     optional<ip::endpoint>     gelf_endpoint;
     udp_socket                 gelf_socket;
 
+    std::atomic<uint64_t>      sent{0};
+    std::atomic<uint64_t>      datagrams{0};
+    std::atomic<uint64_t>      dropped{0};
+    std::atomic<uint64_t>      backlog{0};
+
+    // batch mode, the queue is guarded by lock
+    std::mutex                     lock;
+    std::condition_variable        wake;
+    std::deque<string>             queue;
+    bool                           stopping = false;
+    std::unique_ptr<boost::thread> sender;
+
     impl(const config& c) : 
       cfg(c)
     {
@@ -34,7 +60,95 @@ namespace fc
 
     ~impl()
     {
+      if (sender)
+      {
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          stopping = true;
+        }
+        wake.notify_one();
+        sender->join();
+      }
+    }
+
+    void start_sender()
+    {
+      sender.reset(new boost::thread([this]() {
+        fc::thread::current().set_name("gelf sender");
+        BOOST_SCOPE_EXIT(void)
+        {
+          fc::thread::cleanup();
+        }
+        BOOST_SCOPE_EXIT_END
+        run();
+      }));
     }
+
+    /** sends the queued messages until the appender is destroyed, and then those still queued */
+    void run()
+    {
+      zlib_compressor compressor;
+      string compressed;
+      std::vector<char> buffer;
+      std::vector<std::pair<size_t, size_t>> chunks;
+      std::deque<string> taken;
+      uint64_t messages = 0;
+
+      auto send = [&]() {
+        if (chunks.empty())
+          return;
+        std::vector<std::pair<const char*, size_t>> batch;
+        batch.reserve(chunks.size());
+        for (const auto& chunk : chunks)
+          batch.emplace_back(buffer.data() + chunk.first, chunk.second);
+        try
+        {
+          gelf_socket.send_to(batch, *gelf_endpoint);
+          sent += messages;
+          datagrams += batch.size();
+        }
+        catch (...)
+        {
+          // there is nobody to report to, the loss shows in the statistics
+          dropped += messages;
+        }
+        backlog -= messages;
+        messages = 0;
+        buffer.clear();
+        chunks.clear();
+      };
+
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          while (queue.empty() && !stopping)
+            wake.wait(guard);
+          if (queue.empty())
+            return;
+          taken.swap(queue);
+        }
+        for (const string& message : taken)
+        {
+          compressor.compress(message.data(), message.size(), compressed);
+          split(compressed, buffer, chunks);
+          ++messages;
+          if (chunks.size() >= cfg.batch_size)
+            send();
+        }
+        send();
+        taken.clear();
+      }
+    }
+
+    /** @return the GELF JSON of message */
+    string to_gelf(const log_message& message) const;
+
+    /** 
+     *  Appends the datagrams of a compressed message to buffer, and their offsets and sizes 
+     *  to chunks. Messages which do not fit into one datagram are split into GELF chunks.
+     */
+    static void split(string& compressed, std::vector<char>& buffer, std::vector<std::pair<size_t, size_t>>& chunks);
   };
 
   gelf_appender::gelf_appender(const variant& args) :
@@ -73,7 +187,11 @@ namespace fc
       }
 
       if (my->gelf_endpoint)
+      {
         my->gelf_socket.open();
+        if (my->cfg.batch)
+          my->start_sender();
+      }
     }
     catch (...)
     {
@@ -84,17 +202,14 @@ namespace fc
   gelf_appender::~gelf_appender()
   {}
 
-  void gelf_appender::log(const log_message& message)
+  string gelf_appender::impl::to_gelf(const log_message& message) const
   {
-    if (!my->gelf_endpoint)
-      return;
-
     log_context context = message.get_context();
 
     mutable_variant_object gelf_message;
     gelf_message["version"] = "1.1";
-    gelf_message["host"] = my->cfg.host;
-    gelf_message["short_message"] = format_string( message.get_format(), message.get_data(), my->cfg.max_object_depth );
+    gelf_message["host"] = cfg.host;
+    gelf_message["short_message"] = format_string( message.get_format(), message.get_data(), cfg.max_object_depth );
     
     gelf_message["timestamp"] = context.get_timestamp().time_since_epoch().count() / 1000000.;
 
@@ -128,83 +243,116 @@ namespace fc
     if (!context.get_task_name().empty())
       gelf_message["_task_name"] = context.get_task_name();
 
-    string gelf_message_as_string;
     try
     {
-       gelf_message_as_string = json::to_string(gelf_message);
+       return json::to_string(gelf_message);
     }
     catch( const fc::assert_exception& e )
     {
-       gelf_message_as_string = "{\"level\":3,\"short_message\":\"ERROR while generating log message\"}";
+       return "{\"level\":3,\"short_message\":\"ERROR while generating log message\"}";
     }
-    gelf_message_as_string = zlib_compress(gelf_message_as_string);
-    
+  }
+
+  void gelf_appender::impl::split(string& compressed, std::vector<char>& buffer, 
+                                  std::vector<std::pair<size_t, size_t>>& chunks)
+  {
     // graylog2 expects the zlib header to be 0x78 0x9c
     // but miniz.c generates 0x78 0x01 (indicating 
     // low compression instead of default compression)
     // so change that here
-    assert(gelf_message_as_string[0] == (char)0x78);
-    if (gelf_message_as_string[1] == (char)0x01 ||
-        gelf_message_as_string[1] == (char)0xda)
-      gelf_message_as_string[1] = (char)0x9c;
-    assert(gelf_message_as_string[1] == (char)0x9c);
-
-    // packets are sent by UDP, and they tend to disappear if they
-    // get too large.  It's hard to find any solid numbers on how
-    // large they can be before they get dropped -- datagrams can
-    // be up to 64k, but anything over 512 is not guaranteed.
-    // You can play with this number, intermediate values like
-    // 1400 and 8100 are likely to work on most intranets.
-    const unsigned max_payload_size = 512;
-
-    if (gelf_message_as_string.size() <= max_payload_size)
+    assert(compressed[0] == (char)0x78);
+    if (compressed[1] == (char)0x01 ||
+        compressed[1] == (char)0xda)
+      compressed[1] = (char)0x9c;
+    assert(compressed[1] == (char)0x9c);
+
+    if (compressed.size() <= max_payload_size)
     {
       // no need to split
-      std::shared_ptr<char> send_buffer(new char[gelf_message_as_string.size()],
-                                        [](char* p){ delete[] p; });
-      memcpy(send_buffer.get(), gelf_message_as_string.c_str(), 
-             gelf_message_as_string.size());
+      chunks.emplace_back(buffer.size(), compressed.size());
+      buffer.insert(buffer.end(), compressed.begin(), compressed.end());
+      return;
+    }
+
+    // split the message
+    // we need to generate an 8-byte ID for this message.  
+    // city hash should do
+    uint64_t message_id = city_hash64(compressed.c_str(), compressed.size());
+    const unsigned header_length = 2 /* magic */ + 8 /* msg id */ + 1 /* seq */ + 1 /* count */;
+    const unsigned body_length = max_payload_size - header_length;
+    unsigned total_number_of_packets = (compressed.size() + body_length - 1) / body_length;
+    unsigned bytes_sent = 0;
+    unsigned number_of_packets_sent = 0;
+    while (bytes_sent < compressed.size())
+    {
+      unsigned bytes_to_send = std::min((unsigned)compressed.size() - bytes_sent, 
+                                        body_length);
+
+      const size_t offset = buffer.size();
+      buffer.resize(offset + header_length + bytes_to_send);
+      char* ptr = buffer.data() + offset;
+      // magic number for chunked message
+      *(unsigned char*)ptr++ = 0x1e;
+      *(unsigned char*)ptr++ = 0x0f;
+
+      // message id
+      memcpy(ptr, (char*)&message_id, sizeof(message_id));
+      ptr += sizeof(message_id);
 
-      my->gelf_socket.send_to(send_buffer, gelf_message_as_string.size(), 
-                              *my->gelf_endpoint);
+      *(unsigned char*)(ptr++) = number_of_packets_sent;
+      *(unsigned char*)(ptr++) = total_number_of_packets;
+      memcpy(ptr, compressed.c_str() + bytes_sent, 
+             bytes_to_send);
+      chunks.emplace_back(offset, header_length + bytes_to_send);
+      ++number_of_packets_sent;
+      bytes_sent += bytes_to_send;
     }
-    else
+    assert(number_of_packets_sent == total_number_of_packets);
+  }
+
+  void gelf_appender::log(const log_message& message)
+  {
+    if (!my->gelf_endpoint)
+      return;
+
+    if (my->sender)
     {
-      // split the message
-      // we need to generate an 8-byte ID for this message.  
-      // city hash should do
-      uint64_t message_id = city_hash64(gelf_message_as_string.c_str(), gelf_message_as_string.size());
-      const unsigned header_length = 2 /* magic */ + 8 /* msg id */ + 1 /* seq */ + 1 /* count */;
-      const unsigned body_length = max_payload_size - header_length;
-      unsigned total_number_of_packets = (gelf_message_as_string.size() + body_length - 1) / body_length;
-      unsigned bytes_sent = 0;
-      unsigned number_of_packets_sent = 0;
-      while (bytes_sent < gelf_message_as_string.size())
+      // drop before spending any time on a message which would not fit
+      if (my->backlog.load(std::memory_order_relaxed) >= my->cfg.queue_size)
       {
-        unsigned bytes_to_send = std::min((unsigned)gelf_message_as_string.size() - bytes_sent, 
-                                          body_length);
-                                               
-        std::shared_ptr<char> send_buffer(new char[max_payload_size], 
-                                          [](char* p){ delete[] p; });
-        char* ptr = send_buffer.get();
-        // magic number for chunked message
-        *(unsigned char*)ptr++ = 0x1e;
-        *(unsigned char*)ptr++ = 0x0f;
-
-        // message id
-        memcpy(ptr, (char*)&message_id, sizeof(message_id));
-        ptr += sizeof(message_id);
-
-        *(unsigned char*)(ptr++) = number_of_packets_sent;
-        *(unsigned char*)(ptr++) = total_number_of_packets;
-        memcpy(ptr, gelf_message_as_string.c_str() + bytes_sent, 
-               bytes_to_send);
-        my->gelf_socket.send_to(send_buffer, header_length + bytes_to_send, 
-                                *my->gelf_endpoint);
-        ++number_of_packets_sent;
-        bytes_sent += bytes_to_send;
+        ++my->dropped;
+        return;
       }
-      assert(number_of_packets_sent == total_number_of_packets);
+      string gelf_message = my->to_gelf(message);
+      {
+        std::lock_guard<std::mutex> guard(my->lock);
+        my->queue.push_back(std::move(gelf_message));
+        ++my->backlog;
+      }
+      my->wake.notify_one();
+      return;
     }
+
+    string gelf_message_as_string = zlib_compress(my->to_gelf(message));
+    std::vector<char> buffer;
+    std::vector<std::pair<size_t, size_t>> chunks;
+    impl::split(gelf_message_as_string, buffer, chunks);
+
+    std::vector<std::pair<const char*, size_t>> datagrams;
+    for (const auto& chunk : chunks)
+      datagrams.emplace_back(buffer.data() + chunk.first, chunk.second);
+    my->gelf_socket.send_to(datagrams, *my->gelf_endpoint);
+    ++my->sent;
+    my->datagrams += datagrams.size();
+  }
+
+  gelf_appender::statistics gelf_appender::get_statistics() const
+  {
+    statistics result;
+    result.sent = my->sent.load();
+    result.datagrams = my->datagrams.load();
+    result.dropped = my->dropped.load();
+    result.backlog = my->backlog.load();
+    return result;
   }
 } // fc
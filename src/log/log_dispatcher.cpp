@@ -0,0 +1,415 @@
+#include <fc/log/log_dispatcher.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/scope_exit.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace fc {
+
+namespace detail {
+
+   /** a message queued for the dispatcher */
+   struct queued_log_message
+   {
+      logger      target;
+      log_message message;
+      time_point  timestamp;
+   };
+
+   /** the single producer, single consumer ring buffer of a thread */
+   class log_buffer
+   {
+      public:
+         log_buffer( size_t size, uint64_t gen )
+         :slots( new slot[size] ), mask( size - 1 ), generation( gen ){}
+
+         ~log_buffer()
+         {
+            while( front() )
+               pop();
+         }
+
+         /** @return false if the buffer is full */
+         bool push( const logger& l, log_message& m, const time_point& t )
+         {
+            const uint64_t h = head.load( std::memory_order_relaxed );
+            if( h - tail.load( std::memory_order_acquire ) > mask )
+               return false;
+            new( &slots[h & mask] ) queued_log_message{ l, std::move(m), t };
+            head.store( h + 1, std::memory_order_release );
+            return true;
+         }
+
+         /** @return the oldest message, or nullptr if the buffer is empty */
+         queued_log_message* front()
+         {
+            const uint64_t t = tail.load( std::memory_order_relaxed );
+            if( t == head.load( std::memory_order_acquire ) )
+               return nullptr;
+            return reinterpret_cast<queued_log_message*>( &slots[t & mask] );
+         }
+
+         void pop()
+         {
+            const uint64_t t = tail.load( std::memory_order_relaxed );
+            reinterpret_cast<queued_log_message*>( &slots[t & mask] )->~queued_log_message();
+            tail.store( t + 1, std::memory_order_release );
+         }
+
+         typedef std::aligned_storage<sizeof(queued_log_message), alignof(queued_log_message)>::type slot;
+
+         std::unique_ptr<slot[]> slots;
+         const uint64_t          mask;
+         /** the run of the dispatcher the buffer belongs to */
+         const uint64_t          generation;
+         /** set when the thread exits */
+         std::atomic<bool>       abandoned{ false };
+
+         // written by the thread, kept apart from the tail written by the dispatcher
+         char                    producer_padding[64];
+         std::atomic<uint64_t>   head{ 0 };
+         /** set while the thread checks whether the dispatcher runs and pushes */
+         std::atomic<bool>       producing{ false };
+         char                    consumer_padding[64];
+         std::atomic<uint64_t>   tail{ 0 };
+   };
+
+   class log_dispatcher_impl
+   {
+      public:
+         void run();
+         /** passes on the queued messages, earliest first, @return how many */
+         size_t dispatch( const std::vector<std::shared_ptr<log_buffer>>& local );
+         void wake_dispatcher();
+
+         /**
+          *  Waits until done() returns true, which the dispatcher has to bring about, or until the deadline.
+          *  @return done()
+          */
+         template<typename Done>
+         bool wait_for_dispatcher( Done&& done,
+                                   std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() )
+         {
+            waiting.fetch_add( 1 );
+            wake_dispatcher();
+            std::unique_lock<std::mutex> guard( lock );
+            bool result;
+            while( !( result = done() ) && std::chrono::steady_clock::now() < deadline )
+               progress.wait_for( guard, std::chrono::milliseconds( 10 ) );
+            waiting.fetch_sub( 1 );
+            return result;
+         }
+
+         /** waits until the messages queued before have been passed on, or until the deadline */
+         void flush( std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max() );
+
+         std::mutex                               lock;
+         std::condition_variable                  wake;       ///< the dispatcher waits for messages
+         std::condition_variable                  progress;   ///< threads wait for the dispatcher
+         std::vector<std::shared_ptr<log_buffer>> buffers;    ///< guarded by lock
+         std::atomic<uint64_t>                    buffers_changed{ 0 };
+
+         std::atomic<bool>                        running{ false };
+         std::atomic<bool>                        stopping{ false };
+         std::atomic<bool>                        sleeping{ false };
+         std::atomic<uint32_t>                    waiting{ 0 };
+         std::atomic<uint64_t>                    generation{ 0 };
+         /** written by start() before the generation is incremented */
+         std::atomic<size_t>                      buffer_size{ 0 };
+         std::atomic<int>                         flush_level{ log_level::error };
+
+         std::mutex                               start_stop;
+         std::unique_ptr<boost::thread>           thread;
+   };
+
+   /** never destroyed, since threads may log while the program exits */
+   log_dispatcher_impl& dispatcher()
+   {
+      static log_dispatcher_impl* d = new log_dispatcher_impl();
+      return *d;
+   }
+
+   thread_local bool on_dispatcher_thread = false;
+
+   /** the buffer of the current thread, which is abandoned when the thread exits */
+   struct thread_buffer
+   {
+      ~thread_buffer()
+      {
+         if( buffer )
+            buffer->abandoned.store( true, std::memory_order_release );
+      }
+      std::shared_ptr<log_buffer> buffer;
+   };
+   thread_local thread_buffer current_buffer;
+
+   void log_dispatcher_impl::wake_dispatcher()
+   {
+      // taking the lock makes sure the dispatcher is either waiting or going to look at the buffers
+      { std::lock_guard<std::mutex> guard( lock ); }
+      wake.notify_one();
+   }
+
+   size_t log_dispatcher_impl::dispatch( const std::vector<std::shared_ptr<log_buffer>>& local )
+   {
+      size_t count = 0;
+      while( true )
+      {
+         log_buffer* next = nullptr;
+         time_point earliest;
+         for( const auto& b : local )
+         {
+            const queued_log_message* q = b->front();
+            if( q && ( !next || q->timestamp < earliest ) )
+            {
+               next = b.get();
+               earliest = q->timestamp;
+            }
+         }
+         if( !next )
+            return count;
+
+         queued_log_message* q = next->front();
+         try
+         {
+            q->target.log( std::move( q->message ) );
+         }
+         catch( ... )
+         {
+            // there is no caller to report to
+         }
+         next->pop();
+         ++count;
+
+         if( waiting.load( std::memory_order_relaxed ) )
+         {
+            { std::lock_guard<std::mutex> guard( lock ); }
+            progress.notify_all();
+         }
+      }
+   }
+
+   void log_dispatcher_impl::run()
+   {
+      std::vector<std::shared_ptr<log_buffer>> local;
+      uint64_t seen = uint64_t(-1);
+      auto drained = [&local]() {
+         for( const auto& b : local )
+            if( b->front() )
+               return false;
+         return true;
+      };
+
+      while( true )
+      {
+         if( buffers_changed.load() != seen )
+         {
+            std::lock_guard<std::mutex> guard( lock );
+            local = buffers;
+            seen = buffers_changed.load();
+         }
+         if( dispatch( local ) )
+            continue;
+
+         // forget the buffers of threads which have exited
+         bool removed = false;
+         for( const auto& b : local )
+            if( b->abandoned.load( std::memory_order_acquire ) && !b->front() )
+            {
+               std::lock_guard<std::mutex> guard( lock );
+               auto itr = std::find( buffers.begin(), buffers.end(), b );
+               if( itr != buffers.end() )
+                  buffers.erase( itr );
+               buffers_changed.fetch_add( 1 );
+               removed = true;
+            }
+         if( removed )
+            continue;
+
+         std::unique_lock<std::mutex> guard( lock );
+         // stop() sets stopping after the last message has been queued
+         if( stopping.load() )
+         {
+            guard.unlock();
+            if( buffers_changed.load() == seen && drained() )
+               return;
+            continue;
+         }
+         sleeping.store( true );
+         std::atomic_thread_fence( std::memory_order_seq_cst );
+         if( buffers_changed.load() == seen && drained() )
+            wake.wait_for( guard, std::chrono::milliseconds( 100 ) );
+         sleeping.store( false, std::memory_order_relaxed );
+      }
+   }
+
+   bool dispatch_later( const logger& l, log_message& m )
+   {
+      log_dispatcher_impl& d = dispatcher();
+      if( !d.running.load( std::memory_order_relaxed ) || on_dispatcher_thread )
+         return false;
+
+      thread_buffer& current = current_buffer;
+      while( true )
+      {
+         const uint64_t generation = d.generation.load();
+         if( !current.buffer || current.buffer->generation != generation )
+         {
+            auto b = std::make_shared<log_buffer>( d.buffer_size.load(), generation );
+            std::lock_guard<std::mutex> guard( d.lock );
+            d.buffers.push_back( b );
+            d.buffers_changed.fetch_add( 1 );
+            if( current.buffer )
+               current.buffer->abandoned.store( true );
+            current.buffer = std::move( b );
+         }
+         current.buffer->producing.store( true );
+         if( !d.running.load() )
+         {
+            current.buffer->producing.store( false );
+            return false;
+         }
+         // the dispatcher might have been restarted since the buffer was registered
+         if( current.buffer->generation == d.generation.load() )
+            break;
+         current.buffer->producing.store( false );
+      }
+
+      log_buffer& b = *current.buffer;
+      const log_context context = m.get_context();
+      while( !b.push( l, m, context.get_timestamp() ) )
+         d.wait_for_dispatcher( [&b]() {
+            return b.head.load( std::memory_order_relaxed ) - b.tail.load( std::memory_order_acquire ) <= b.mask / 2;
+         } );
+      const uint64_t pushed = b.head.load( std::memory_order_relaxed );
+      // orders the push before reading sleeping, the dispatcher does the opposite
+      b.producing.store( false );
+      if( d.sleeping.load() )
+         d.wake_dispatcher();
+
+      if( context.get_log_level() >= d.flush_level.load( std::memory_order_relaxed ) )
+         d.wait_for_dispatcher( [&b, pushed]() { return b.tail.load( std::memory_order_acquire ) >= pushed; } );
+      return true;
+   }
+
+   void log_dispatcher_impl::flush( std::chrono::steady_clock::time_point deadline )
+   {
+      std::vector<std::pair<std::shared_ptr<log_buffer>, uint64_t>> targets;
+      {
+         std::lock_guard<std::mutex> guard( lock );
+         for( const auto& b : buffers )
+            targets.emplace_back( b, b->head.load( std::memory_order_acquire ) );
+      }
+      wait_for_dispatcher( [&targets]() {
+         for( const auto& t : targets )
+            if( t.first->tail.load( std::memory_order_acquire ) < t.second )
+               return false;
+         return true;
+      }, deadline );
+   }
+
+   std::terminate_handler previous_terminate = nullptr;
+
+   bool install_exit_handlers()
+   {
+      std::atexit( []() { log_dispatcher::stop(); } );
+      previous_terminate = std::set_terminate( []() {
+         // the dispatcher might be stuck in an appender, which must not keep the program from aborting
+         if( dispatcher().running.load() && !on_dispatcher_thread )
+            dispatcher().flush( std::chrono::steady_clock::now() + std::chrono::milliseconds( 300 ) );
+         if( previous_terminate )
+            previous_terminate();
+         std::abort();
+      } );
+      return true;
+   }
+
+} // namespace detail
+
+void log_dispatcher::start( size_t buffer_size, log_level flush_level )
+{
+   detail::log_dispatcher_impl& d = detail::dispatcher();
+   std::lock_guard<std::mutex> guard( d.start_stop );
+   if( d.running.load() )
+      return;
+
+   static bool handlers_installed = detail::install_exit_handlers();
+   (void)handlers_installed;
+
+   size_t size = 2;
+   while( size < buffer_size )
+      size *= 2;
+   d.buffer_size.store( size );
+   d.flush_level.store( flush_level );
+   d.stopping.store( false );
+   d.generation.fetch_add( 1 );
+   d.thread.reset( new boost::thread( [&d]() {
+      fc::thread::current().set_name( "log dispatcher" );
+      detail::on_dispatcher_thread = true;
+      BOOST_SCOPE_EXIT(void)
+      {
+         fc::thread::cleanup();
+      }
+      BOOST_SCOPE_EXIT_END
+      d.run();
+   } ) );
+   d.running.store( true );
+}
+
+void log_dispatcher::stop()
+{
+   detail::log_dispatcher_impl& d = detail::dispatcher();
+   // an appender cannot wait for the thread it runs on
+   if( detail::on_dispatcher_thread )
+      return;
+   std::lock_guard<std::mutex> guard( d.start_stop );
+   if( !d.running.load() )
+      return;
+
+   // threads which see running cleared log synchronously, wait for those which did not
+   d.running.store( false );
+   std::vector<std::shared_ptr<detail::log_buffer>> buffers;
+   {
+      std::lock_guard<std::mutex> l( d.lock );
+      buffers = d.buffers;
+   }
+   for( const auto& b : buffers )
+      while( b->producing.load() )
+         std::this_thread::yield();
+
+   d.stopping.store( true );
+   d.wake_dispatcher();
+   d.thread->join();
+   d.thread.reset();
+
+   std::lock_guard<std::mutex> l( d.lock );
+   d.buffers.clear();
+   d.buffers_changed.fetch_add( 1 );
+}
+
+void log_dispatcher::flush()
+{
+   detail::log_dispatcher_impl& d = detail::dispatcher();
+   if( !d.running.load() || detail::on_dispatcher_thread )
+      return;
+   d.flush();
+}
+
+bool log_dispatcher::is_running()
+{
+   return detail::dispatcher().running.load();
+}
+
+} // namespace fc
@@ -8,22 +8,65 @@
 #include <fc/io/stdio.hpp>
 #include <fc/io/json.hpp>
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <time.h>
+
 namespace fc
 {
    namespace detail
    {
+      typedef std::shared_ptr<const string> shared_name;
+
+      const shared_name& no_name()
+      {
+         static const shared_name empty = std::make_shared<const string>();
+         return empty;
+      }
+
+      /** the names of the current thread and task, shared by the contexts created on a thread */
+      struct current_names
+      {
+         shared_name thread_name;
+         shared_name task_name;
+      };
+
+      std::atomic<bool> coarse_timestamps{ false };
+
+      time_point log_timestamp()
+      {
+#ifdef CLOCK_REALTIME_COARSE
+         if( coarse_timestamps.load( std::memory_order_relaxed ) )
+         {
+            timespec ts;
+            clock_gettime( CLOCK_REALTIME_COARSE, &ts );
+            return time_point( microseconds( int64_t( ts.tv_sec ) * 1000000 + ts.tv_nsec / 1000 ) );
+         }
+#endif
+         return time_point::now();
+      }
+
       class log_context_impl
       {
          public:
+            log_context_impl(){}
+            log_context_impl( const log_context_impl& ) = delete;
+
             log_level level;
-            string       file;
-            uint64_t     line;
-            string       method;
-            string       thread_name;
-            string       task_name;
+            /** either static strings or the storage below */
+            const char*  file = "";
+            uint64_t     line = 0;
+            const char*  method = "";
+            shared_name  thread_name = no_name();
+            shared_name  task_name = no_name();
             string       hostname;
             string       context;
             time_point   timestamp;
+
+            /** copies of file and method, unless the context was made with static_source */
+            string       file_storage;
+            string       method_storage;
       };
 
       class log_message_impl
@@ -33,9 +76,24 @@ namespace fc
             :context( std::move(ctx) ){}
             log_message_impl(){}
 
+            /** converts the lazy arguments, if any, the first time it is called */
+            const variant_object& data()
+            {
+               std::call_once( converted, [this]() {
+                  if( !lazy_args.empty() )
+                  {
+                     args = lazy_args.to_variant_object();
+                     lazy_args = log_args();
+                  }
+               } );
+               return args;
+            }
+
             log_context     context;
             string          format;
             variant_object  args;
+            log_args        lazy_args;
+            std::once_flag  converted;
       };
    }
 
@@ -44,18 +102,44 @@ namespace fc
    log_context::log_context()
    :my( std::make_shared<detail::log_context_impl>() ){}
 
-   log_context::log_context( log_level ll, const char* file, uint64_t line, 
+   log_context::log_context( log_level ll, const char* file, uint64_t line,
                                             const char* method )
+   :log_context( ll, file, line, method, static_source() )
+   {
+      // the caller's strings may not outlive the context, which can be read on other threads
+      my->file_storage   = my->file;
+      my->file           = my->file_storage.c_str();
+      my->method_storage = method;
+      my->method         = my->method_storage.c_str();
+   }
+
+   log_context::log_context( log_level ll, const char* file, uint64_t line,
+                                            const char* method, static_source )
    :my( std::make_shared<detail::log_context_impl>() )
    {
       my->level       = ll;
-      my->file        = fc::path(file).filename().generic_string(); // TODO truncate filename
+      // the file name without its directory, separated by either kind of slash
+      const char* name = file;
+      for( const char* p = file; *p; ++p )
+         if( *p == '/' || *p == '\\' )
+            name = p + 1;
+      my->file        = name;
       my->line        = line;
       my->method      = method;
-      my->timestamp   = time_point::now();
-      my->thread_name = fc::thread::current().name();
-      const char* current_task_desc = fc::thread::current().current_task_desc();
-      my->task_name   = current_task_desc ? current_task_desc : "?unnamed?";
+      my->timestamp   = detail::log_timestamp();
+
+      // the names change rarely, so they are shared until they do
+      static thread_local detail::current_names names;
+      fc::thread& current = fc::thread::current();
+      if( !names.thread_name || *names.thread_name != current.name() )
+         names.thread_name = std::make_shared<const string>( current.name() );
+      const char* current_task_desc = current.current_task_desc();
+      if( !current_task_desc )
+         current_task_desc = "?unnamed?";
+      if( !names.task_name || strcmp( names.task_name->c_str(), current_task_desc ) != 0 )
+         names.task_name = std::make_shared<const string>( current_task_desc );
+      my->thread_name = names.thread_name;
+      my->task_name   = names.task_name;
    }
 
    log_context::log_context( const variant& v, uint32_t max_depth )
@@ -63,13 +147,15 @@ namespace fc
    {
        auto obj = v.get_object();
        my->level        = obj["level"].as<log_level>(max_depth);
-       my->file         = obj["file"].as_string();
+       my->file_storage = obj["file"].as_string();
+       my->file         = my->file_storage.c_str();
        my->line         = obj["line"].as_uint64();
-       my->method       = obj["method"].as_string();
+       my->method_storage = obj["method"].as_string();
+       my->method       = my->method_storage.c_str();
        my->hostname     = obj["hostname"].as_string();
-       my->thread_name  = obj["thread_name"].as_string();
+       my->thread_name  = std::make_shared<const string>( obj["thread_name"].as_string() );
        if (obj.contains("task_name"))
-         my->task_name    = obj["task_name"].as_string();
+         my->task_name    = std::make_shared<const string>( obj["task_name"].as_string() );
        my->timestamp    = obj["timestamp"].as<time_point>(max_depth);
        if( obj.contains( "context" ) )
            my->context      = obj["context"].as<string>(max_depth);
@@ -77,7 +163,7 @@ namespace fc
 
    std::string log_context::to_string()const
    {
-      return my->thread_name + "  " + my->file + ":" + fc::to_string(my->line) + " " + my->method;
+      return *my->thread_name + "  " + my->file + ":" + fc::to_string(my->line) + " " + my->method;
 
    }
 
@@ -90,6 +176,11 @@ namespace fc
 
    log_context::~log_context(){}
 
+   void log_context::set_coarse_timestamps( bool enable )
+   {
+      detail::coarse_timestamps.store( enable, std::memory_order_relaxed );
+   }
+
 
    void to_variant( const log_context& l, variant& v, uint32_t max_depth )
    { 
@@ -155,12 +246,14 @@ namespace fc
    string     log_context::get_file()const       { return my->file; }
    uint64_t   log_context::get_line_number()const { return my->line; }
    string     log_context::get_method()const     { return my->method; }
-   string     log_context::get_thread_name()const { return my->thread_name; }
-   string     log_context::get_task_name()const { return my->task_name; }
+   string     log_context::get_thread_name()const { return *my->thread_name; }
+   string     log_context::get_task_name()const { return *my->task_name; }
    string     log_context::get_host_name()const   { return my->hostname; }
    time_point  log_context::get_timestamp()const  { return my->timestamp; }
    log_level  log_context::get_log_level()const{ return my->level;   }
    string     log_context::get_context()const   { return my->context; }
+   const char* log_context::get_file_c_str()const   { return my->file; }
+   const char* log_context::get_method_c_str()const { return my->method; }
 
 
    variant log_context::to_variant(uint32_t max_depth)const
@@ -171,7 +264,7 @@ namespace fc
                ( "line",         my->line                )
                ( "method",       my->method              )
                ( "hostname",     my->hostname            )
-               ( "thread_name",  my->thread_name         )
+               ( "thread_name",  *my->thread_name        )
                ( "timestamp",    variant(my->timestamp, max_depth) );
 
       if( my->context.size() ) 
@@ -191,6 +284,13 @@ namespace fc
       my->args    = std::move(args);
    }
 
+   log_message::log_message( log_context ctx, std::string format, log_args&& args )
+   :my( std::make_shared<detail::log_message_impl>(std::move(ctx)) )
+   {
+      my->format    = std::move(format);
+      my->lazy_args = std::move(args);
+   }
+
    log_message::log_message( const variant& v, uint32_t max_depth )
    :my( std::make_shared<detail::log_message_impl>( log_context( v.get_object()["context"], max_depth ) ) )
    {
@@ -203,16 +303,24 @@ namespace fc
       return limited_mutable_variant_object(max_depth)
                           ( "context", my->context )
                           ( "format",  my->format )
-                          ( "data",    my->args   );
+                          ( "data",    my->data() );
    }
 
    log_context    log_message::get_context()const { return my->context; }
-   string         log_message::get_format()const  { return my->format;  }
-   variant_object log_message::get_data()const    { return my->args;    }
+   const string&  log_message::get_format()const  { return my->format;  }
+   variant_object log_message::get_data()const    { return my->data();  }
 
    string        log_message::get_message()const
    {
-      return format_string( my->format, my->args );
+      return format_string( my->format, my->data() );
+   }
+
+   variant_object log_args::to_variant_object()const
+   {
+      limited_mutable_variant_object data( FC_MAX_LOG_OBJECT_DEPTH, true );
+      for( const auto& a : _args )
+         a->add_to( data );
+      return variant_object( std::move(data) );
    }
 
 
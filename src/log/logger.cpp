@@ -1,5 +1,6 @@
 #include <fc/log/logger.hpp>
 #include <fc/log/log_message.hpp>
+#include <fc/log/log_dispatcher.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/thread/spin_lock.hpp>
 #include <fc/thread/scoped_lock.hpp>
@@ -62,6 +63,9 @@ namespace fc {
     }
 
     void logger::log( log_message m ) {
+       if( detail::dispatch_later( *this, m ) )
+          return;
+
        m.get_context().append_context( my->_name );
 
        for( auto itr = my->_appenders.begin(); itr != my->_appenders.end(); ++itr )
@@ -2,6 +2,13 @@
 #include <fc/network/ip.hpp>
 #include <fc/fwd_impl.hpp>
 #include <fc/asio.hpp>
+#include <fc/exception/exception.hpp>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+#endif
 
 
 namespace fc {
@@ -83,6 +90,43 @@ namespace fc {
     return completion_promise->wait();
   }
 
+  size_t udp_socket::send_to( const std::vector<std::pair<const char*, size_t>>& datagrams, const ip::endpoint& to )
+  {
+    size_t sent = 0;
+#if defined(__linux__)
+    boost::asio::ip::udp::endpoint destination = to_asio_ep(to);
+    std::vector<iovec>   buffers( datagrams.size() );
+    std::vector<mmsghdr> messages( datagrams.size() );
+    for( size_t i = 0; i < datagrams.size(); ++i )
+    {
+      buffers[i].iov_base = const_cast<char*>( datagrams[i].first );
+      buffers[i].iov_len  = datagrams[i].second;
+      memset( &messages[i], 0, sizeof(mmsghdr) );
+      messages[i].msg_hdr.msg_name    = destination.data();
+      messages[i].msg_hdr.msg_namelen = destination.size();
+      messages[i].msg_hdr.msg_iov     = &buffers[i];
+      messages[i].msg_hdr.msg_iovlen  = 1;
+    }
+    while( sent < datagrams.size() )
+    {
+      int count = ::sendmmsg( my->_sock.native_handle(), messages.data() + sent, datagrams.size() - sent, 0 );
+      if( count < 0 )
+      {
+        if( errno == EINTR )
+          continue;
+        // the socket is non-blocking, the rest is sent below once there is room
+        if( errno == EAGAIN || errno == EWOULDBLOCK )
+          break;
+        FC_THROW( "sendmmsg failed: ${error}", ("error", strerror(errno)) );
+      }
+      sent += count;
+    }
+#endif
+    for( ; sent < datagrams.size(); ++sent )
+      send_to( datagrams[sent].first, datagrams[sent].second, to );
+    return sent;
+  }
+
   void udp_socket::open() {
     my->_sock.open( boost::asio::ip::udp::v4() );
     my->_sock.non_blocking(true);
@@ -146,7 +146,7 @@ response websocket_api_connection::on_message( const std::string& message )
        && !var_obj["id"].is_string() && !var_obj["id"].is_numeric() && !var_obj["id"].is_null() )
       return response( variant(), { -32600, "Invalid id" }, "2.0" );
 
-   if( var_obj.contains( "method" ) && ( !var_obj["method"].is_string() || var_obj["method"].get_string() == "" ) )
+   if( var_obj.contains( "method" ) && ( !var_obj["method"].is_string() || var_obj["method"].get_string_view().empty() ) )
       return response( variant(), { -32600, "Missing or invalid method" }, "2.0" );
 
    if( var_obj.contains( "jsonrpc" ) && ( !var_obj["jsonrpc"].is_string() || var_obj["jsonrpc"] != "2.0" ) )
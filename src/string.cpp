@@ -10,6 +10,7 @@
 #include <iomanip>
 #include <locale>
 #include <limits>
+#include <unordered_map>
 
 /*
  *  Implemented with std::string for now.
@@ -193,59 +194,116 @@ namespace fc  {
      }
   }
 
-   string format_string( const string& format, const variant_object& args, uint32_t max_object_depth )
-   {
-      stringstream ss;
-      size_t prev = 0;
-      auto next = format.find( '$' );
-      while( prev < format.size() )
+   namespace {
+      /** a format parsed into literal text and the keys of its ${key} placeholders */
+      struct compiled_format
       {
-         ss << format.substr( prev, next == string::npos ? string::npos : next - prev );
-
-         // if we got to the end, return it.
-         if( next == size_t(string::npos) || next == format.size() )
-            return ss.str();
-
-         // if we are not at the end, then update the start
-         prev = next + 1;
+         struct segment
+         {
+            string text; ///< literal text or a key
+            bool   is_key;
+         };
+         std::vector<segment> segments;
 
-         if( format[prev] == '{' )
+         compiled_format() {}
+         explicit compiled_format( const string& format )
          {
-            // if the next char is a open, then find close
-            next = format.find( '}', prev );
-            // if we found close...
-            if( next != string::npos )
+            size_t prev = 0;
+            auto next = format.find( '$' );
+            while( prev < format.size() )
             {
-               // the key is between prev and next
-               string key = format.substr( prev+1, (next-prev-1) );
-
-               auto val = args.find( key );
-               if( val != args.end() )
+               add_text( format, prev, next == string::npos ? format.size() : next );
+               if( next == string::npos )
+                  break;
+               prev = next + 1;
+               if( format[prev] == '{' )
                {
-                  if( val->value().is_object() || val->value().is_array() )
+                  // a '$' without a matching '}' is dropped
+                  next = format.find( '}', prev );
+                  if( next != string::npos )
                   {
-                     try
-                     {
-                        ss << json::to_string( val->value(), json::stringify_large_ints_and_doubles, max_object_depth );
-                     }
-                     catch( const fc::assert_exception& e )
-                     {
-                        ss << "[\"ERROR_WHILE_CONVERTING_VALUE_TO_STRING\"]";
-                     }
+                     segments.push_back( segment{ format.substr( prev + 1, next - prev - 1 ), true } );
+                     prev = next + 1;
                   }
-                  else
-                     ss << val->value().as_string();
                }
                else
-                  ss << "${"<<key<<"}";
-               prev = next + 1;
+                  add_text( format, next, next + 1 );
+               next = format.find( '$', prev );
+            }
+         }
+
+      private:
+         void add_text( const string& format, size_t begin, size_t end )
+         {
+            if( begin == end )
+               return;
+            if( segments.empty() || segments.back().is_key )
+               segments.push_back( segment{ string(), false } );
+            segments.back().text.append( format, begin, end - begin );
+         }
+      };
+
+      /**
+       *  Formats are mostly literals, so every thread keeps the ones it has seen parsed.
+       *  Formats built at runtime are parsed into uncached once the cache is full.
+       */
+      const compiled_format& compile_format( const string& format, compiled_format& uncached )
+      {
+         static thread_local std::unordered_map<string, compiled_format> cache;
+         auto itr = cache.find( format );
+         if( itr != cache.end() )
+            return itr->second;
+         if( cache.size() < 1024 )
+            return cache.emplace( format, compiled_format( format ) ).first->second;
+         uncached = compiled_format( format );
+         return uncached;
+      }
+   }
+
+   void format_string( const string& format, const variant_object& args, string& out, uint32_t max_object_depth )
+   {
+      compiled_format uncached;
+      for( const auto& seg : compile_format( format, uncached ).segments )
+      {
+         if( !seg.is_key )
+         {
+            out += seg.text;
+            continue;
+         }
+         auto val = args.find( seg.text );
+         if( val == args.end() )
+         {
+            out += "${";
+            out += seg.text;
+            out += '}';
+         }
+         else if( val->value().is_object() || val->value().is_array() )
+         {
+            try
+            {
+               out += json::to_string( val->value(), json::stringify_large_ints_and_doubles, max_object_depth );
             }
+            catch( const fc::assert_exception& e )
+            {
+               out += "[\"ERROR_WHILE_CONVERTING_VALUE_TO_STRING\"]";
+            }
+         }
+         else if( val->value().is_string() )
+         {
+            const boost::string_view str = val->value().get_string_view();
+            out.append( str.data(), str.size() );
          }
          else
-            ss << format[next];
-         next = format.find( '$', prev );
+            out += val->value().as_string();
       }
-      return ss.str();
+   }
+
+   string format_string( const string& format, const variant_object& args, uint32_t max_object_depth )
+   {
+      string out;
+      out.reserve( format.size() + 64 );
+      format_string( format, args, out, max_object_depth );
+      return out;
    }
 
 } // namespace fc
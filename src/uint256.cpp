@@ -0,0 +1,72 @@
+#include <fc/uint256.hpp>
+#include <fc/variant.hpp>
+
+#include <openssl/bn.h>
+
+#include <vector>
+
+namespace fc {
+
+namespace {
+
+   template<typename T>
+   bigint to_bigint_impl( const T& v )
+   {
+      const bool negative = v < 0;
+      std::vector<char> bytes;
+      boost::multiprecision::export_bits( T( abs( v ) ), std::back_inserter( bytes ), 8 );
+      bigint result( bytes );
+      if( negative )
+         BN_set_negative( result.get(), 1 );
+      return result;
+   }
+
+   template<typename T>
+   void from_bigint_impl( const bigint& b, T& v, size_t bits )
+   {
+      const std::vector<char> bytes = b;
+      FC_ASSERT( size_t( b.log2() ) <= bits, "bigint does not fit into ${b} bits", ("b",bits) );
+      FC_ASSERT( std::numeric_limits<T>::is_signed || !b.is_negative(),
+                 "negative bigint converted to an unsigned integer" );
+      boost::multiprecision::import_bits( v, bytes.begin(), bytes.end(), 8 );
+      if( b.is_negative() )
+         v = detail::negate( v, std::integral_constant<bool, std::numeric_limits<T>::is_signed>() );
+   }
+
+   template<typename T>
+   void from_variant_impl( const variant& var, T& vo )
+   {
+      try
+      {
+         vo = T( var.as_string() );
+      }
+      catch( const std::runtime_error& e )
+      {
+         FC_THROW_EXCEPTION( parse_error_exception, "Invalid integer ${v}: ${e}",
+                             ("v",var.as_string())("e",e.what()) );
+      }
+   }
+
+} // anonymous namespace
+
+bigint to_bigint( const uint256_t& v ) { return to_bigint_impl( v ); }
+bigint to_bigint( const int256_t& v )  { return to_bigint_impl( v ); }
+bigint to_bigint( const uint512_t& v ) { return to_bigint_impl( v ); }
+bigint to_bigint( const int512_t& v )  { return to_bigint_impl( v ); }
+
+void from_bigint( const bigint& b, uint256_t& v ) { from_bigint_impl( b, v, 256 ); }
+void from_bigint( const bigint& b, int256_t& v )  { from_bigint_impl( b, v, 256 ); }
+void from_bigint( const bigint& b, uint512_t& v ) { from_bigint_impl( b, v, 512 ); }
+void from_bigint( const bigint& b, int512_t& v )  { from_bigint_impl( b, v, 512 ); }
+
+void to_variant( const uint256_t& v, variant& vo, uint32_t max_depth ) { vo = v.str(); }
+void to_variant( const int256_t& v, variant& vo, uint32_t max_depth )  { vo = v.str(); }
+void to_variant( const uint512_t& v, variant& vo, uint32_t max_depth ) { vo = v.str(); }
+void to_variant( const int512_t& v, variant& vo, uint32_t max_depth )  { vo = v.str(); }
+
+void from_variant( const variant& var, uint256_t& vo, uint32_t max_depth ) { from_variant_impl( var, vo ); }
+void from_variant( const variant& var, int256_t& vo, uint32_t max_depth )  { from_variant_impl( var, vo ); }
+void from_variant( const variant& var, uint512_t& vo, uint32_t max_depth ) { from_variant_impl( var, vo ); }
+void from_variant( const variant& var, int512_t& vo, uint32_t max_depth )  { from_variant_impl( var, vo ); }
+
+} // namespace fc
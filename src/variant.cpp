@@ -10,6 +10,7 @@
 #include <boost/scoped_array.hpp>
 #include <fc/reflect/variant.hpp>
 #include <algorithm>
+#include <atomic>
 
 #if defined(__APPLE__) or defined(__OpenBSD__)
 #include <boost/multiprecision/integer.hpp>
@@ -27,6 +28,112 @@ void set_variant_type( variant* v, variant::type_id t)
    data[ sizeof(variant) -1 ] = t;
 }
 
+/**
+ *  Short strings are stored in the variant itself: the characters from the first byte on,
+ *  their count in the byte before the TypeID, which is inline_string_type. get_type()
+ *  reports these as string_type.
+ */
+static const char   inline_string_type = 9;
+static const size_t max_inline_string  = sizeof(variant) - 2;
+
+static bool is_inline_string( const variant* v )
+{
+   return reinterpret_cast<const char*>(v)[ sizeof(variant) - 1 ] == inline_string_type;
+}
+
+static boost::string_view inline_string( const variant* v )
+{
+   const char* data = reinterpret_cast<const char*>(v);
+   return boost::string_view( data, uint8_t( data[ sizeof(variant) - 2 ] ) );
+}
+
+static void set_string( variant* v, const char* str, size_t len )
+{
+   char* data = reinterpret_cast<char*>(v);
+   if( len <= max_inline_string )
+   {
+      memcpy( data, str, len );
+      data[ sizeof(variant) - 2 ] = char( len );
+      data[ sizeof(variant) - 1 ] = inline_string_type;
+      return;
+   }
+   *reinterpret_cast<string**>(v) = new string( str, len );
+   set_variant_type( v, variant::string_type );
+}
+
+/**
+ *  Arrays and blobs are reference counted and shared by the copies of a variant. The mutable
+ *  accessors copy a shared payload first. A payload that a mutable reference has been handed
+ *  out for may change at any time, so copies of it are deep like before.
+ */
+template<typename T>
+struct shared_payload
+{
+   explicit shared_payload( T&& v ) : value( std::move(v) ) {}
+   explicit shared_payload( const T& v ) : value( v ) {}
+
+   T                     value;
+   std::atomic<uint32_t> refs{ 1 };
+   bool                  shareable = true;
+};
+typedef shared_payload<variants> shared_variants;
+typedef shared_payload<blob>     shared_blob;
+
+template<typename T>
+static shared_payload<T>*& payload( variant* v )
+{
+   return *reinterpret_cast<shared_payload<T>**>(v);
+}
+
+template<typename T>
+static const shared_payload<T>* payload( const variant* v )
+{
+   return *reinterpret_cast<const shared_payload<T>* const*>(v);
+}
+
+template<typename T>
+static void release_payload( variant* v )
+{
+   shared_payload<T>* p = payload<T>( v );
+   if( p->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+      delete p;
+}
+
+/** makes v refer to the payload of from */
+template<typename T>
+static void share_payload( variant* v, const variant* from )
+{
+   shared_payload<T>* p = const_cast<shared_payload<T>*>( payload<T>( from ) );
+   if( p->shareable )
+      p->refs.fetch_add( 1, std::memory_order_relaxed );
+   else
+      p = new shared_payload<T>( p->value );
+   payload<T>( v ) = p;
+}
+
+/** @return the payload of v for modification, after copying it if it is shared */
+template<typename T>
+static T& unshare_payload( variant* v )
+{
+   shared_payload<T>*& p = payload<T>( v );
+   if( p->refs.load( std::memory_order_acquire ) != 1 )
+   {
+      shared_payload<T>* copy = new shared_payload<T>( p->value );
+      release_payload<T>( v );
+      p = copy;
+   }
+   p->shareable = false;
+   return p->value;
+}
+
+static void set_string( variant* v, string&& str )
+{
+   if( str.size() <= max_inline_string )
+      return set_string( v, str.data(), str.size() );
+   *reinterpret_cast<string**>(v) = new string( std::move(str) );
+   set_variant_type( v, variant::string_type );
+}
+
 variant::variant()
 {
    set_variant_type( this, null_type );
@@ -113,14 +220,12 @@ variant::variant( bool val, uint32_t max_depth )
 
 variant::variant( char* str, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_string( this, str, strlen( str ) );
 }
 
 variant::variant( const char* str, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_string( this, str, strlen( str ) );
 }
 
 // TODO: do a proper conversion to utf8
@@ -130,8 +235,7 @@ variant::variant( wchar_t* str, uint32_t max_depth )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
       buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_string( this, buffer.get(), len );
 }
 
 // TODO: do a proper conversion to utf8
@@ -141,18 +245,16 @@ variant::variant( const wchar_t* str, uint32_t max_depth )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
       buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_string( this, buffer.get(), len );
 }
 
 variant::variant( std::string val, uint32_t max_depth )
 {
-   *reinterpret_cast<string**>(this)  = new string( std::move(val) );
-   set_variant_type( this, string_type );
+   set_string( this, std::move(val) );
 }
 variant::variant( blob val, uint32_t max_depth )
 {
-   *reinterpret_cast<blob**>(this)  = new blob( std::move(val) );
+   payload<blob>( this ) = new shared_blob( std::move(val) );
    set_variant_type( this, blob_type );
 }
 
@@ -169,15 +271,23 @@ variant::variant( mutable_variant_object obj, uint32_t max_depth )
 
 variant::variant( variants arr, uint32_t max_depth )
 {
-   *reinterpret_cast<variants**>(this)  = new variants(std::move(arr));
+   payload<variants>( this ) = new shared_variants( std::move(arr) );
    set_variant_type(this,  array_type );
 }
 
 typedef const variant_object* const_variant_object_ptr; 
-typedef const variants* const_variants_ptr; 
-typedef const blob*   const_blob_ptr; 
 typedef const string* const_string_ptr;
 
+/** @return the string of a string_type variant, which is copied to buf if stored inline */
+static const string& string_ref( const variant* v, string& buf )
+{
+   if( !is_inline_string( v ) )
+      return **reinterpret_cast<const const_string_ptr*>(v);
+   const boost::string_view str = inline_string( v );
+   buf.assign( str.data(), str.size() );
+   return buf;
+}
+
 void variant::clear()
 {
    switch( get_type() )
@@ -186,10 +296,14 @@ void variant::clear()
         delete *reinterpret_cast<variant_object**>(this);
         break;
      case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        release_payload<variants>( this );
+        break;
+     case blob_type:
+        release_payload<blob>( this );
         break;
      case string_type:
-        delete *reinterpret_cast<string**>(this);
+        if( !is_inline_string( this ) )
+           delete *reinterpret_cast<string**>(this);
         break;
      default:
         break;
@@ -207,14 +321,22 @@ variant::variant( const variant& v, uint32_t max_depth )
           set_variant_type( this, object_type );
           return;
        case array_type:
-          *reinterpret_cast<variants**>(this)  = 
-             new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
+          share_payload<variants>( this, &v );
           set_variant_type( this,  array_type );
           return;
+       case blob_type:
+          share_payload<blob>( this, &v );
+          set_variant_type( this,  blob_type );
+          return;
        case string_type:
-          *reinterpret_cast<string**>(this)  = 
-             new string(**reinterpret_cast<const const_string_ptr*>(&v) );
-          set_variant_type( this, string_type );
+          if( !is_inline_string( &v ) )
+          {
+             *reinterpret_cast<string**>(this)  = 
+                new string(**reinterpret_cast<const const_string_ptr*>(&v) );
+             set_variant_type( this, string_type );
+          }
+          else
+             memcpy( this, &v, sizeof(v) );
           return;
        default:
           memcpy( this, &v, sizeof(v) );
@@ -254,10 +376,17 @@ variant& variant::operator=( const variant& v )
             new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
          break;
       case array_type:
-         *reinterpret_cast<variants**>(this)  = 
-            new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
+         share_payload<variants>( this, &v );
+         break;
+      case blob_type:
+         share_payload<blob>( this, &v );
          break;
       case string_type:
+         if( is_inline_string( &v ) )
+         {
+            memcpy( this, &v, sizeof(v) );
+            return *this;
+         }
          *reinterpret_cast<string**>(this)  = new string((**reinterpret_cast<const const_string_ptr*>(&v)) );
          break;
 
@@ -288,10 +417,13 @@ void  variant::visit( const visitor& v )const
          v.handle( *reinterpret_cast<const bool*>(this) );
          return;
       case string_type:
-         v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
+         if( is_inline_string( this ) )
+            v.handle( inline_string( this ).to_string() );
+         else
+            v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
          return;
       case array_type:
-         v.handle( **reinterpret_cast<const const_variants_ptr*>(this) );
+         v.handle( payload<variants>( this )->value );
          return;
       case object_type:
          v.handle( **reinterpret_cast<const const_variant_object_ptr*>(this) );
@@ -303,7 +435,8 @@ void  variant::visit( const visitor& v )const
 
 variant::type_id variant::get_type()const
 {
-   return (type_id)reinterpret_cast<const char*>(this)[sizeof(*this)-1];
+   const char t = reinterpret_cast<const char*>(this)[sizeof(*this)-1];
+   return t == inline_string_type ? string_type : (type_id)t;
 }
 
 bool variant::is_null()const
@@ -379,7 +512,10 @@ int64_t variant::as_int64()const
    switch( get_type() )
    {
       case string_type:
-          return to_int64(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string buf;
+          return to_int64( string_ref( this, buf ) );
+      }
       case double_type:
           return int64_t(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -400,7 +536,10 @@ uint64_t variant::as_uint64()const
    switch( get_type() )
    {
       case string_type:
-          return to_uint64(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string buf;
+          return to_uint64( string_ref( this, buf ) );
+      }
       case double_type:
           return static_cast<uint64_t>(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -422,7 +561,10 @@ double  variant::as_double()const
    switch( get_type() )
    {
       case string_type:
-          return to_double(**reinterpret_cast<const const_string_ptr*>(this)); 
+      {
+          string buf;
+          return to_double( string_ref( this, buf ) );
+      }
       case double_type:
           return *reinterpret_cast<const double*>(this);
       case int64_type:
@@ -444,7 +586,7 @@ bool  variant::as_bool()const
    {
       case string_type:
       {
-          const string& s = **reinterpret_cast<const const_string_ptr*>(this);
+          const boost::string_view s = get_string_view();
           if( s == "true" )
              return true;
           if( s == "false" )
@@ -471,7 +613,7 @@ string    variant::as_string()const
    switch( get_type() )
    {
       case string_type:
-          return **reinterpret_cast<const const_string_ptr*>(this); 
+          return get_string();
       case double_type:
           return to_string(*reinterpret_cast<const double*>(this)); 
       case int64_type:
@@ -496,21 +638,21 @@ string    variant::as_string()const
 variants&         variant::get_array()
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<variants**>(this);
+     return unshare_payload<variants>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 blob&         variant::get_blob()
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<blob**>(this);
+     return unshare_payload<blob>( this );
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
 const blob&         variant::get_blob()const
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<const const_blob_ptr*>(this);
+     return payload<blob>( this )->value;
    
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
@@ -523,11 +665,11 @@ blob variant::as_blob()const
       case blob_type: return get_blob();
       case string_type:
       {
-         const string& str = get_string();
+         const boost::string_view str = get_string_view();
          if( str.size() == 0 ) return blob();
          if( str.back() == '=' )
          {
-            std::string b64 = base64_decode( get_string() );
+            std::string b64 = base64_decode( str.to_string() );
             return blob( { std::vector<char>( b64.begin(), b64.end() ) } );
          }
          return blob( { std::vector<char>( str.begin(), str.end() ) } );
@@ -545,7 +687,7 @@ blob variant::as_blob()const
 const variants&       variant::get_array()const
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<const const_variants_ptr*>(this);
+     return payload<variants>( this )->value;
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 
@@ -572,11 +714,21 @@ size_t            variant::size()const
     return get_array().size();
 }
 
-const string&        variant::get_string()const
+string               variant::get_string()const
 {
+  return get_string_view().to_string();
+}
+
+boost::string_view   variant::get_string_view()const
+{
+  if( is_inline_string( this ) )
+     return inline_string( this );
   if( get_type() == string_type )
-     return **reinterpret_cast<const const_string_ptr*>(this);
-  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
+  {
+     const string& str = **reinterpret_cast<const const_string_ptr*>(this);
+     return boost::string_view( str.data(), str.size() );
+  }
+  FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to String", ("type",get_type()) );
 }
 
 /// @throw if get_type() != object_type 
@@ -1,10 +1,79 @@
 #include <fc/variant_object.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/crypto/city.hpp>
 #include <assert.h>
+#include <string.h>
 
 
 namespace fc
 {
+   namespace detail
+   {
+      /**
+       *  Open addressing hash table over the keys of an object, mapping each key to the
+       *  position of its first entry like the linear search does. Slots hold the position + 1,
+       *  zero marks a free slot. At most half of the slots are used.
+       */
+      class variant_object_index
+      {
+         public:
+            typedef std::vector<variant_object::entry> entries;
+
+            explicit variant_object_index( const entries& e )
+            {
+               size_t slots = 16;
+               while( slots < 2 * e.size() )
+                  slots *= 2;
+               _slots.resize( slots );
+               for( size_t i = 0; i < e.size(); ++i )
+                  insert( e, i );
+            }
+
+            /** @return the position of the first entry with key, e.size() if there is none */
+            size_t find( const entries& e, const char* key, size_t len )const
+            {
+               const size_t mask = _slots.size() - 1;
+               for( size_t i = city_hash_size_t( key, len ) & mask; _slots[i]; i = ( i + 1 ) & mask )
+               {
+                  const string& k = e[ _slots[i] - 1 ].key();
+                  if( k.size() == len && memcmp( k.data(), key, len ) == 0 )
+                     return _slots[i] - 1;
+               }
+               return e.size();
+            }
+
+            /** adds e.back() */
+            void append( const entries& e )
+            {
+               if( 2 * e.size() > _slots.size() )
+               {
+                  *this = variant_object_index( e );
+                  return;
+               }
+               insert( e, e.size() - 1 );
+            }
+
+         private:
+            void insert( const entries& e, size_t pos )
+            {
+               const string& key = e[pos].key();
+               const size_t mask = _slots.size() - 1;
+               size_t i = city_hash_size_t( key.data(), key.size() ) & mask;
+               for( ; _slots[i]; i = ( i + 1 ) & mask )
+                  if( e[ _slots[i] - 1 ].key() == key )
+                     return; // keep the first entry of a duplicate key
+               _slots[i] = uint32_t( pos + 1 );
+            }
+
+            std::vector<uint32_t> _slots;
+      };
+
+      void variant_object_index_deleter::operator()( variant_object_index* index )const
+      {
+         delete index;
+      }
+   }
+
    // ---------------------------------------------------------------
    // entry
 
@@ -50,6 +119,8 @@ namespace fc
    // ---------------------------------------------------------------
    // variant_object
 
+   const size_t variant_object::index_threshold;
+
    variant_object::iterator variant_object::begin() const
    {
       assert( _key_value != nullptr );
@@ -68,14 +139,27 @@ namespace fc
 
    variant_object::iterator variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      if( _key_value->size() <= index_threshold )
       {
-         if( itr->key() == key )
+         for( auto itr = begin(); itr != end(); ++itr )
          {
-            return itr;
+            if( itr->key() == key )
+            {
+               return itr;
+            }
          }
+         return end();
       }
-      return end();
+
+      const detail::variant_object_index* index = _index.load( std::memory_order_acquire );
+      if( index == nullptr )
+      {
+         // concurrent readers may build an index at the same time, the first one is kept
+         std::unique_ptr<const detail::variant_object_index> built( new detail::variant_object_index( *_key_value ) );
+         if( _index.compare_exchange_strong( index, built.get(), std::memory_order_acq_rel ) )
+            index = built.release();
+      }
+      return begin() + index->find( *_key_value, key, strlen( key ) );
    }
 
    const variant& variant_object::operator[]( const string& key )const
@@ -113,7 +197,7 @@ namespace fc
    }
 
    variant_object::variant_object( variant_object&& obj)
-   : _key_value( std::move(obj._key_value) )
+   : _key_value( std::move(obj._key_value) ), _index( obj._index.exchange( nullptr ) )
    {
       obj._key_value = std::make_shared<std::vector<entry>>();
       assert( _key_value != nullptr );
@@ -125,16 +209,27 @@ namespace fc
    }
 
    variant_object::variant_object( mutable_variant_object&& obj )
-   : _key_value(std::move(obj._key_value))
+   : _key_value(std::move(obj._key_value)), _index( obj._index.release() )
    {
       assert( _key_value != nullptr );
    }
 
+   variant_object::~variant_object()
+   {
+      reset_index();
+   }
+
+   void variant_object::reset_index( const detail::variant_object_index* index )
+   {
+      delete _index.exchange( index );
+   }
+
    variant_object& variant_object::operator=( variant_object&& obj )
    {
       if (this != &obj)
       {
          std::swap(_key_value, obj._key_value );
+         obj.reset_index( _index.exchange( obj._index.exchange( nullptr ) ) );
          assert( _key_value != nullptr );
       }
       return *this;
@@ -145,6 +240,7 @@ namespace fc
       if (this != &obj)
       {
          _key_value = obj._key_value;
+         reset_index();
       }
       return *this;
    }
@@ -152,13 +248,16 @@ namespace fc
    variant_object& variant_object::operator=( mutable_variant_object&& obj )
    {
       _key_value = std::move(obj._key_value);
+      reset_index( obj._index.release() );
       obj._key_value.reset( new std::vector<entry>() );
       return *this;
    }
 
    variant_object& variant_object::operator=( const mutable_variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      // other objects may share the entries
+      _key_value = std::make_shared<std::vector<entry>>( *obj._key_value );
+      reset_index();
       return *this;
    }
 
@@ -202,6 +301,8 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )const
    {
+      if( _index )
+         return begin() + _index->find( *_key_value, key, strlen( key ) );
       for( auto itr = begin(); itr != end(); ++itr )
       {
          if( itr->key() == key )
@@ -219,14 +320,16 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      if( !_index && _key_value->size() > variant_object::index_threshold )
+         _index.reset( new detail::variant_object_index( *_key_value ) );
+      return static_cast<const mutable_variant_object*>(this)->find( key );
+   }
+
+   void mutable_variant_object::append( entry e )
+   {
+      _key_value->push_back( std::move(e) );
+      if( _index )
+         _index->append( *_key_value );
    }
 
    const variant& mutable_variant_object::operator[]( const string& key )const
@@ -249,7 +352,7 @@ namespace fc
    {
       auto itr = find( key );
       if( itr != end() ) return itr->value();
-      _key_value->emplace_back(entry(key, variant()));
+      append( entry( key, variant() ) );
       return _key_value->back().value();
    }
 
@@ -280,13 +383,14 @@ namespace fc
    }
 
    mutable_variant_object::mutable_variant_object( mutable_variant_object&& obj )
-      : _key_value(std::move(obj._key_value))
+      : _key_value(std::move(obj._key_value)), _index(std::move(obj._index))
    {
    }
 
    mutable_variant_object& mutable_variant_object::operator=( const variant_object& obj )
    {
       *_key_value = *obj._key_value;
+      _index.reset();
       return *this;
    }
 
@@ -295,6 +399,7 @@ namespace fc
       if (this != &obj)
       {
          _key_value = std::move(obj._key_value);
+         _index = std::move(obj._index);
       }
       return *this;
    }
@@ -304,6 +409,7 @@ namespace fc
       if (this != &obj)
       {
          *_key_value = *obj._key_value;
+         _index.reset();
       }
       return *this;
    }
@@ -320,6 +426,8 @@ namespace fc
          if( itr->key() == key )
          {
             _key_value->erase(itr);
+            // the positions of the following entries have changed
+            _index.reset();
             return;
          }
       }
@@ -335,7 +443,7 @@ namespace fc
       }
       else
       {
-         _key_value->push_back( entry( std::move(key), std::move(var) ) );
+         append( entry( std::move(key), std::move(var) ) );
       }
       return *this;
    }
@@ -345,7 +453,7 @@ namespace fc
     */
    mutable_variant_object& mutable_variant_object::operator()( string key, variant var, uint32_t max_depth )
    {
-      _key_value->push_back( entry( std::move(key), std::move(var) ) );
+      append( entry( std::move(key), std::move(var) ) );
       return *this;
    }
 
@@ -1,6 +1,8 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/bloom_filter.hpp>
+#include <fc/blocked_bloom_filter.hpp>
+#include <fc/concurrent_bloom_filter.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/reflect/variant.hpp>
 #include <iostream>
@@ -9,6 +11,11 @@
 #include <fstream>
 #include <fc/io/json.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/time.hpp>
+#include <fc/thread/parallel.hpp>
+#include <fc/thread/scoped_lock.hpp>
+
+#include <boost/thread/mutex.hpp>
 
 using namespace fc;
 
@@ -125,4 +132,218 @@ BOOST_AUTO_TEST_CASE(bloom_test_2)
    }
 }
 
+BOOST_AUTO_TEST_CASE(blocked_bloom_test)
+{ try {
+   blocked_bloom_filter filter(setup_parameters());
+   BOOST_CHECK_EQUAL( 0u, filter.size() % blocked_bloom_filter::block_bits );
+   BOOST_CHECK( filter.size() >= setup_parameters().optimal_parameters.table_size );
+
+   for( uint64_t i = 0; i < 100000; i += 2 )
+      filter.insert( i );
+   BOOST_CHECK_EQUAL( 50000u, filter.element_count() );
+   uint32_t false_positives = 0;
+   for( uint64_t i = 0; i < 100000; i += 2 )
+   {
+      BOOST_CHECK( filter.contains( i ) );
+      false_positives += filter.contains( i + 1 );
+   }
+   BOOST_CHECK( false_positives < 50 );
+   BOOST_CHECK( !filter.contains( std::string( "not inserted" ) ) );
+
+   // union of two halves
+   blocked_bloom_filter odd(setup_parameters());
+   for( uint64_t i = 1; i < 100000; i += 2 )
+      odd.insert( i );
+   blocked_bloom_filter both = filter;
+   both |= odd;
+   for( uint64_t i = 0; i < 100000; ++i )
+      BOOST_CHECK( both.contains( i ) );
+   // a different seed maps the keys differently and is not merged
+   bloom_parameters other_seed = setup_parameters();
+   other_seed.random_seed = 0x1234;
+   blocked_bloom_filter other(other_seed);
+   other.insert( uint64_t(1) );
+   blocked_bloom_filter unchanged = filter;
+   unchanged |= other;
+   BOOST_CHECK( unchanged == filter );
+
+   // serialization keeps all state
+   const std::vector<char> packed = fc::raw::pack( filter );
+   BOOST_CHECK_EQUAL( blocked_bloom_filter::format_version, uint8_t(packed[0]) );
+   blocked_bloom_filter unpacked = fc::raw::unpack<blocked_bloom_filter>( packed );
+   BOOST_CHECK( unpacked == filter );
+   BOOST_CHECK( unpacked.contains( uint64_t(0) ) );
+   std::vector<char> future_format = packed;
+   future_format[0] = blocked_bloom_filter::format_version + 1;
+   BOOST_CHECK_THROW( fc::raw::unpack<blocked_bloom_filter>( future_format ), fc::exception );
+
+   // the words are little-endian, whatever the byte order of the host
+   const size_t table_start = packed.size() - filter.blocks_.size() * sizeof(blocked_bloom_filter::block);
+   for( size_t w = 0; w < 8; ++w )
+   {
+      uint64_t word = 0;
+      for( size_t b = 0; b < 8; ++b )
+         word |= uint64_t( uint8_t( packed[table_start + w * 8 + b] ) ) << ( 8 * b );
+      BOOST_CHECK_EQUAL( word, filter.blocks_[0].words[w] );
+   }
+
+   // a block count whose table size overflows is rejected before anything is allocated
+   std::vector<char> huge( packed.begin(), packed.begin() + 1 + 4 + 8 + 8 + 8 );
+   const std::vector<char> block_count = fc::raw::pack( fc::unsigned_int( uint64_t(1) << 58 ) );
+   huge.insert( huge.end(), block_count.begin(), block_count.end() );
+   BOOST_CHECK_THROW( fc::raw::unpack<blocked_bloom_filter>( huge ), fc::exception );
+
+   filter.clear();
+   BOOST_CHECK( !filter.contains( uint64_t(0) ) );
+   BOOST_CHECK_EQUAL( 0u, filter.element_count() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(bloom_benchmark)
+{ try {
+   // large enough for the table to not fit into the caches
+   bloom_parameters parameters;
+   parameters.projected_element_count    = 2000000;
+   parameters.false_positive_probability = 0.0001;
+   parameters.compute_optimal_parameters();
+   const uint64_t elements = parameters.projected_element_count;
+   const uint64_t queries  = 1000000;
+
+   auto run = [&]( auto& filter, const std::string& name ) {
+      fc::time_point start = fc::time_point::now();
+      for( uint64_t i = 0; i < elements; ++i )
+         filter.insert( i * 7919 );
+      fc::time_point end = fc::time_point::now();
+      const int64_t insert_ns = ( end - start ).count() * 1000 / elements;
+
+      uint64_t found = 0;
+      start = fc::time_point::now();
+      for( uint64_t i = 0; i < queries; ++i )
+         found += filter.contains( i * 7919 );
+      end = fc::time_point::now();
+      const int64_t hit_ns = ( end - start ).count() * 1000 / queries;
+      BOOST_CHECK_EQUAL( queries, found );
+
+      uint64_t false_positives = 0;
+      start = fc::time_point::now();
+      for( uint64_t i = 0; i < queries; ++i )
+         false_positives += filter.contains( i * 7919 + 1 );
+      end = fc::time_point::now();
+      const int64_t miss_ns = ( end - start ).count() * 1000 / queries;
+
+      ilog( "${n}: ${s} bits, ${k} hashes, insert ${i} ns/op, contains ${h} ns/op (present) ${m} ns/op (absent), "
+            "false positive rate ${f} (expected ${e})",
+            ("n",name)("s",filter.size())("k",filter.hash_count())("i",insert_ns)("h",hit_ns)("m",miss_ns)
+            ("f",double(false_positives) / queries)("e",filter.effective_fpp()) );
+      return false_positives;
+   };
+
+   bloom_filter classic(parameters);
+   blocked_bloom_filter blocked(parameters);
+   run( classic, "bloom_filter" );
+   const uint64_t blocked_false_positives = run( blocked, "blocked_bloom_filter" );
+   // somewhat worse than the classic layout, but in the same range
+   BOOST_CHECK( double(blocked_false_positives) / queries < 10 * parameters.false_positive_probability );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(concurrent_bloom_test)
+{ try {
+   concurrent_bloom_filter filter(setup_parameters());
+   blocked_bloom_filter expected(setup_parameters());
+   BOOST_CHECK_EQUAL( expected.size(), filter.size() );
+   BOOST_CHECK_EQUAL( expected.hash_count(), filter.hash_count() );
+
+   // concurrent inserts of overlapping ranges
+   std::vector<fc::future<void>> inserters;
+   for( uint64_t t = 0; t < 8; ++t )
+      inserters.push_back( fc::do_parallel( [&filter,t] () {
+         for( uint64_t i = t * 1000; i < t * 1000 + 2000; ++i )
+            filter.insert( i );
+      } ) );
+   for( auto& f : inserters )
+      f.wait();
+   for( uint64_t i = 0; i < 9000; ++i )
+      expected.insert( i );
+
+   BOOST_CHECK_EQUAL( 16000u, filter.element_count() );
+   for( uint64_t i = 0; i < 9000; ++i )
+      BOOST_CHECK( filter.contains( i ) );
+   // the table is the same as if the keys were inserted one after the other
+   blocked_bloom_filter snapshot = filter.snapshot();
+   expected.inserted_element_count_ = snapshot.element_count();
+   BOOST_CHECK( snapshot == expected );
+   BOOST_CHECK( fc::raw::unpack<blocked_bloom_filter>( fc::raw::pack( snapshot ) ) == snapshot );
+
+   // merging with the blocked_bloom_filter rules
+   blocked_bloom_filter more(setup_parameters());
+   more.insert( std::string( "more" ) );
+   filter |= more;
+   BOOST_CHECK( filter.contains( std::string( "more" ) ) );
+   bloom_parameters other_seed = setup_parameters();
+   other_seed.random_seed = 0x1234;
+   blocked_bloom_filter other(other_seed);
+   other.insert( std::string( "other" ) );
+   filter |= other;
+   BOOST_CHECK( !filter.contains( std::string( "other" ) ) );
+
+   concurrent_bloom_filter copy( snapshot );
+   BOOST_CHECK_EQUAL( 16000u, copy.element_count() );
+   BOOST_CHECK( copy.contains( uint64_t(0) ) );
+   BOOST_CHECK( !copy.contains( std::string( "more" ) ) );
+   copy |= filter;
+   BOOST_CHECK( copy.contains( std::string( "more" ) ) );
+
+   filter.clear();
+   BOOST_CHECK_EQUAL( 0u, filter.element_count() );
+   BOOST_CHECK( !filter.contains( uint64_t(0) ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(concurrent_bloom_benchmark)
+{ try {
+   bloom_parameters parameters;
+   parameters.projected_element_count    = 2000000;
+   parameters.false_positive_probability = 0.0001;
+   parameters.compute_optimal_parameters();
+   const uint64_t threads    = 8;
+   const uint64_t per_thread = parameters.projected_element_count / threads;
+
+   // every thread inserts its keys and looks up as many keys of the other threads
+   auto run = [&]( const std::string& name, const std::function<void(uint64_t)>& insert,
+                   const std::function<bool(uint64_t)>& contains ) {
+      const fc::time_point start = fc::time_point::now();
+      std::vector<fc::future<uint64_t>> workers;
+      for( uint64_t t = 0; t < threads; ++t )
+         workers.push_back( fc::do_parallel( [&,t] () {
+            uint64_t found = 0;
+            const uint64_t other = ( t + 1 ) % threads;
+            for( uint64_t i = 0; i < per_thread; ++i )
+            {
+               insert( t * per_thread + i );
+               found += contains( other * per_thread + i );
+            }
+            return found;
+         } ) );
+      uint64_t found = 0;
+      for( auto& w : workers )
+         found += w.wait();
+      const fc::time_point end = fc::time_point::now();
+      ilog( "${n}: ${o} inserts and lookups in ${t}µs on ${c} threads, ${f} found",
+            ("n",name)("o",threads * per_thread)("t",end-start)("c",threads)("f",found) );
+   };
+
+   blocked_bloom_filter locked(parameters);
+   boost::mutex lock;
+   run( "blocked_bloom_filter with mutex",
+        [&]( uint64_t k ) { fc::scoped_lock<boost::mutex> l( lock ); locked.insert( k ); },
+        [&]( uint64_t k ) { fc::scoped_lock<boost::mutex> l( lock ); return locked.contains( k ); } );
+
+   concurrent_bloom_filter concurrent(parameters);
+   run( "concurrent_bloom_filter",
+        [&]( uint64_t k ) { concurrent.insert( k ); },
+        [&]( uint64_t k ) { return concurrent.contains( k ); } );
+
+   BOOST_CHECK_EQUAL( threads * per_thread, concurrent.element_count() );
+   for( uint64_t i = 0; i < threads * per_thread; i += 1000 )
+      BOOST_CHECK( concurrent.contains( i ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
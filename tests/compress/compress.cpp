@@ -3,33 +3,15 @@
 #include <fstream>
 #include <iostream>
 #include <fc/compress/zlib.hpp>
+#include <fc/crypto/city.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/io/buffered_iostream.hpp>
+#include <fc/io/sstream.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
 
 BOOST_AUTO_TEST_SUITE(compress)
 
-extern "C" {
-
-enum
-{
-  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
-  TINFL_FLAG_HAS_MORE_INPUT = 2,
-  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
-  TINFL_FLAG_COMPUTE_ADLER32 = 8
-};
-
-extern char* tinfl_decompress_mem_to_heap(const void *pSrc_buf, size_t src_buf_len, size_t *pOut_len, int flags);
-
-}
-
-static std::string zlib_decompress( const std::string compressed )
-{
-    size_t decomp_len;
-    char* decomp = tinfl_decompress_mem_to_heap( compressed.c_str(), compressed.length(), &decomp_len, TINFL_FLAG_PARSE_ZLIB_HEADER );
-    std::string result( decomp, decomp_len );
-    free( decomp );
-    return result;
-}
-
 BOOST_AUTO_TEST_CASE(zlib_test)
 {
     std::ifstream testfile;
@@ -42,7 +24,7 @@ BOOST_AUTO_TEST_CASE(zlib_test)
     {
         buffer << line << "\n";
         std::string compressed = fc::zlib_compress( line );
-        std::string decomp = zlib_decompress( compressed );
+        std::string decomp = fc::zlib_decompress( compressed );
         BOOST_CHECK_EQUAL( decomp, line );
 
         std::getline( testfile, line );
@@ -50,8 +32,141 @@ BOOST_AUTO_TEST_CASE(zlib_test)
 
     line = buffer.str();
     std::string compressed = fc::zlib_compress( line );
-    std::string decomp = zlib_decompress( compressed );
+    std::string decomp = fc::zlib_decompress( compressed );
     BOOST_CHECK_EQUAL( decomp, line );
 }
 
+BOOST_AUTO_TEST_CASE(zlib_compressor_test)
+{
+    fc::zlib_compressor compressor;
+    std::string compressed;
+    for( const std::string& text : { std::string(), std::string( "hello" ), std::string( 100000, 'x' ), std::string( "hello again" ) } )
+    {
+        compressor.compress( text.data(), text.size(), compressed );
+        BOOST_CHECK( compressed == fc::zlib_compress( text ) );
+        BOOST_CHECK_EQUAL( fc::zlib_decompress( compressed ), text );
+    }
+}
+
+/** log-like text, which compresses to about a quarter */
+static std::string sample_text( size_t size )
+{
+    std::string text;
+    for( uint64_t i = 0; text.size() < size; ++i )
+        text += "block " + std::to_string( i ) + " produced by producer" + std::to_string( i % 21 ) + " with id "
+                + std::to_string( fc::city_hash64( (const char*)&i, sizeof(i) ) ) + "\n";
+    text.resize( size );
+    return text;
+}
+
+static std::string inflate_all( const std::string& compressed )
+{
+    fc::inflate_istream in( std::make_shared<fc::stringstream>( compressed ) );
+    std::string result;
+    char buffer[1000];
+    try
+    {
+        while( true )
+            result.append( buffer, in.readsome( buffer, sizeof(buffer) ) );
+    }
+    catch( const fc::eof_exception& )
+    {
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(deflate_stream_test)
+{
+    const std::string text = sample_text( 300000 );
+    auto context = std::make_shared<fc::zlib_compressor>();
+    for( int level : { 0, 1, 6, 9 } )
+    {
+        auto out = std::make_shared<fc::stringstream>();
+        {
+            fc::deflate_ostream deflate( out, level, context );
+            // odd pieces, so that writes do not line up with the blocks of the compressor
+            for( size_t pos = 0; pos < text.size(); pos += 777 )
+                deflate.write( text.data() + pos, std::min<size_t>( 777, text.size() - pos ) );
+            deflate.close();
+        }
+        const std::string compressed = out->str();
+        BOOST_CHECK_EQUAL( fc::zlib_decompress( compressed ), text );
+        BOOST_CHECK( inflate_all( compressed ) == text );
+        if( level == 6 )
+            BOOST_CHECK( compressed == fc::zlib_compress( text ) );
+    }
+
+    // the destructor finishes the stream
+    auto out = std::make_shared<fc::stringstream>();
+    {
+        fc::deflate_ostream deflate( out, fc::zlib_best_speed );
+        deflate.write( text.data(), 1000 );
+    }
+    BOOST_CHECK_EQUAL( fc::zlib_decompress( out->str() ), text.substr( 0, 1000 ) );
+
+    BOOST_CHECK_THROW( fc::deflate_ostream( out, 10 ), fc::exception );
+
+    // a stream without any data
+    BOOST_CHECK_EQUAL( fc::zlib_decompress( fc::zlib_compress( "" ) ), "" );
+    auto empty = std::make_shared<fc::stringstream>();
+    fc::deflate_ostream( empty ).close();
+    BOOST_CHECK( empty->str() == fc::zlib_compress( "" ) );
+    BOOST_CHECK_EQUAL( inflate_all( empty->str() ), "" );
+}
+
+BOOST_AUTO_TEST_CASE(deflate_flush_test)
+{
+    const std::string text = sample_text( 10000 );
+    auto out = std::make_shared<fc::stringstream>();
+    fc::deflate_ostream deflate( out );
+    deflate.write( text.data(), 5000 );
+    deflate.flush();
+
+    // what has been flushed can be read, before the stream is complete
+    fc::buffered_istream in( std::make_shared<fc::inflate_istream>( std::make_shared<fc::stringstream>( out->str() ) ) );
+    BOOST_CHECK_EQUAL( in.peek(), text[0] );
+    std::string first( 5000, ' ' );
+    in.read( &first[0], first.size() );
+    BOOST_CHECK( first == text.substr( 0, 5000 ) );
+    char c;
+    BOOST_CHECK_THROW( in.readsome( &c, 1 ), fc::exception );
+
+    deflate.write( text.data() + 5000, 5000 );
+    deflate.close();
+    BOOST_CHECK( inflate_all( out->str() ) == text );
+
+    std::string corrupt = out->str();
+    corrupt[corrupt.size() / 2] ^= 0x55;
+    BOOST_CHECK_THROW( inflate_all( corrupt ), fc::exception );
+    BOOST_CHECK_THROW( fc::zlib_decompress( corrupt ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(deflate_benchmark)
+{
+    const std::string text = sample_text( 8 * 1024 * 1024 );
+    auto context = std::make_shared<fc::zlib_compressor>();
+    for( int level : { 0, 1, 3, 6, 9 } )
+    {
+        auto out = std::make_shared<fc::stringstream>();
+        fc::time_point start = fc::time_point::now();
+        {
+            fc::deflate_ostream deflate( out, level, context );
+            for( size_t pos = 0; pos < text.size(); pos += 65536 )
+                deflate.write( text.data() + pos, 65536 );
+            deflate.close();
+        }
+        const fc::microseconds deflate_time = fc::time_point::now() - start;
+        const std::string compressed = out->str();
+
+        start = fc::time_point::now();
+        const std::string decompressed = inflate_all( compressed );
+        const fc::microseconds inflate_time = fc::time_point::now() - start;
+        BOOST_CHECK( decompressed == text );
+
+        ilog( "level ${l}: ${r}% of the size, deflate ${d} MB/s, inflate ${i} MB/s",
+              ("l",level)("r",compressed.size() * 100 / text.size())
+              ("d",text.size() / std::max<int64_t>( deflate_time.count(), 1 ))("i",text.size() / std::max<int64_t>( inflate_time.count(), 1 )) );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,7 +4,13 @@
 #include <iostream>
 #include <fc/crypto/aes.hpp>
 #include <fc/crypto/city.hpp>
+#include <fc/crypto/rand.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/sstream.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
 
 #include <fc/variant.hpp>
 
@@ -67,4 +73,124 @@ BOOST_AUTO_TEST_CASE(aes_test)
 //    BOOST_CHECK( !memcmp( dcrypt.data(), data.data(), len) );
 }
 
+BOOST_AUTO_TEST_CASE(aes_stream_test)
+{ try {
+    const auto key = fc::sha512::hash( "stream", 6 );
+    for( size_t size : { 0, 1, 15, 16, 17, 100000, 200001 } )
+    {
+        std::vector<char> data( size );
+        fc::rand_bytes( data.data(), size );
+
+        // the streams produce and accept the format of aes_encrypt, whatever the write sizes
+        auto cipher = std::make_shared<fc::stringstream>();
+        fc::aes_ostream out( cipher, key );
+        for( size_t pos = 0; pos < size; pos += 7777 )
+            out.write( data.data() + pos, std::min<size_t>( 7777, size - pos ) );
+        out.close();
+        const std::string cipher_text = cipher->str();
+        BOOST_CHECK( std::vector<char>( cipher_text.begin(), cipher_text.end() ) == fc::aes_encrypt( key, data ) );
+        BOOST_CHECK_THROW( out.write( "x", 1 ), fc::assert_exception );
+
+        fc::aes_istream in( std::make_shared<fc::stringstream>( cipher_text ), key );
+        std::vector<char> decrypted( size );
+        if( size )
+            in.read( decrypted.data(), size );
+        BOOST_CHECK( data == decrypted );
+        char c;
+        BOOST_CHECK_THROW( in.readsome( &c, 1 ), fc::eof_exception );
+    }
+
+    // the destructor finishes a stream which has not been closed
+    {
+        auto unclosed = std::make_shared<fc::stringstream>();
+        {
+            fc::aes_ostream out( unclosed, key );
+            out.write( "some plain text", 15 );
+        }
+        const std::string cipher_text = unclosed->str();
+        BOOST_CHECK( std::vector<char>( cipher_text.begin(), cipher_text.end() ) == fc::aes_encrypt( key, std::vector<char>( "some plain text", "some plain text" + 15 ) ) );
+    }
+
+    // a wrong key is detected by the padding of the last block
+    auto cipher = std::make_shared<fc::stringstream>();
+    fc::aes_ostream out( cipher, key );
+    out.write( "some plain text", 15 );
+    out.close();
+    fc::aes_istream in( std::make_shared<fc::stringstream>( cipher->str() ), fc::sha512::hash( "wrong", 5 ) );
+    char buffer[16];
+    BOOST_CHECK_THROW( in.read( buffer, 15 ), fc::aes_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(aes_save_load_test)
+{ try {
+    const auto key = fc::sha512::hash( "file", 4 );
+    fc::temp_directory dir;
+    const fc::path file = dir.path() / "cipher";
+
+    std::vector<char> data( 300000 );
+    fc::rand_bytes( data.data(), data.size() );
+    fc::aes_save( file, key, data );
+    BOOST_CHECK( fc::aes_load( file, key ) == data );
+
+    // the chunked versions use the same format
+    const fc::path plain = dir.path() / "plain";
+    {
+        fc::ofstream p( plain );
+        p.write( data.data(), data.size() );
+    }
+    const fc::path file2 = dir.path() / "cipher2";
+    fc::aes_save( file2, key, plain );
+    BOOST_CHECK( fc::aes_load( file2, key ) == data );
+    fc::stringstream loaded;
+    fc::aes_load( file, key, loaded );
+    BOOST_CHECK( loaded.str() == std::string( data.begin(), data.end() ) );
+
+    std::vector<char> empty;
+    fc::aes_save( file2, key, empty );
+    BOOST_CHECK( fc::aes_load( file2, key ).empty() );
+
+    // saving replaces the old file only when the new one is complete
+    fc::aes_save( file2, key, plain );
+    BOOST_CHECK( fc::aes_load( file2, key ) == data );
+    BOOST_CHECK( !fc::exists( file2.generic_string() + ".tmp" ) );
+    BOOST_CHECK_THROW( fc::aes_save( file2, key, dir.path() / "missing" ), fc::exception );
+    BOOST_CHECK( fc::aes_load( file2, key ) == data );
+
+    BOOST_CHECK_THROW( fc::aes_load( file, fc::sha512::hash( "wrong", 5 ) ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(aes_benchmark)
+{ try {
+    const auto key = fc::sha512::hash( "benchmark", 9 );
+
+    std::vector<char> memo( 100, 'm' );
+    const int memos = 100000;
+    fc::time_point start = fc::time_point::now();
+    for( int i = 0; i < memos; ++i )
+        fc::aes_decrypt( key, fc::aes_encrypt( key, memo ) );
+    fc::time_point end = fc::time_point::now();
+    ilog( "${n} memos encrypted and decrypted in ${t}µs", ("n",memos)("t",end-start) );
+
+    fc::temp_directory dir;
+    const fc::path plain = dir.path() / "plain";
+    std::vector<char> chunk( 1024 * 1024, 'p' );
+    {
+        fc::ofstream p( plain );
+        for( int i = 0; i < 64; ++i )
+            p.write( chunk.data(), chunk.size() );
+    }
+    start = fc::time_point::now();
+    fc::aes_save( dir.path() / "cipher", key, plain );
+    end = fc::time_point::now();
+    ilog( "64MB file saved in ${t}µs", ("t",end-start) );
+
+    start = fc::time_point::now();
+    fc::ofstream restored( dir.path() / "restored" );
+    fc::aes_load( dir.path() / "cipher", key, restored );
+    restored.close();
+    end = fc::time_point::now();
+    ilog( "64MB file loaded in ${t}µs", ("t",end-start) );
+    BOOST_CHECK_EQUAL( fc::file_size( plain ), fc::file_size( dir.path() / "restored" ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
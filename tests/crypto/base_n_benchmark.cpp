@@ -0,0 +1,149 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/base58.hpp>
+#include <fc/crypto/base64.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+namespace fc { namespace test {
+
+   // defined in base_n_tests.cpp
+   std::string legacy_to_base58( const char* d, size_t s );
+   bool legacy_from_base58( const std::string& str, std::vector<char>& out );
+
+   /** Pre-kernel hex encoder, appends one character at a time */
+   std::string to_hex_bytewise( const char* d, size_t s )
+   {
+      std::string r;
+      const char* digits = "0123456789abcdef";
+      const uint8_t* c = (const uint8_t*)d;
+      for( size_t i = 0; i < s; ++i )
+         (r += digits[c[i] >> 4]) += digits[c[i] & 0x0f];
+      return r;
+   }
+
+   /** Pre-kernel base64 encoder, appends one character at a time */
+   std::string base64_encode_bytewise( const char* d, size_t s )
+   {
+      const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      const uint8_t* c = (const uint8_t*)d;
+      std::string r;
+      size_t i = 0;
+      for( ; i + 3 <= s; i += 3 )
+      {
+         const uint32_t v = ( uint32_t(c[i]) << 16 ) | ( uint32_t(c[i+1]) << 8 ) | c[i+2];
+         for( int j = 18; j >= 0; j -= 6 )
+            r += chars[( v >> j ) & 0x3f];
+      }
+      return r;
+   }
+
+   const size_t DATA_SIZE = 16 * 1024 * 1024;
+
+   std::string make_random( size_t len )
+   {
+      std::string data( len, '\0' );
+      uint64_t x = 0x9e3779b97f4a7c15ULL;
+      for( auto& c : data )
+      {
+         x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+         c = char( x );
+      }
+      return data;
+   }
+
+   void report( const std::string& what, const time_point& start, const time_point& end )
+   {
+      const int64_t us = std::max<int64_t>( ( end - start ).count(), 1 );
+      ilog( "${w} ${s} bytes in ${t}µs, ${r} MB/s",
+            ("w",what)("s",DATA_SIZE)("t",us)("r",DATA_SIZE / us) );
+   }
+
+} } // fc::test
+
+BOOST_AUTO_TEST_SUITE(base_n_benchmark)
+
+BOOST_AUTO_TEST_CASE( hex_throughput )
+{
+   const std::string data = fc::test::make_random( fc::test::DATA_SIZE );
+
+   fc::time_point start = fc::time_point::now();
+   const std::string slow = fc::test::to_hex_bytewise( data.data(), data.size() );
+   fc::test::report( "hex encoded byte-wise", start, fc::time_point::now() );
+
+   start = fc::time_point::now();
+   const std::string hex = fc::to_hex( data.data(), data.size() );
+   fc::test::report( "hex encoded", start, fc::time_point::now() );
+   BOOST_CHECK( slow == hex );
+
+   std::string decoded( data.size(), '\0' );
+   start = fc::time_point::now();
+   BOOST_CHECK_EQUAL( data.size(), fc::from_hex( hex, &decoded[0], decoded.size() ) );
+   fc::test::report( "hex decoded", start, fc::time_point::now() );
+   BOOST_CHECK( data == decoded );
+}
+
+BOOST_AUTO_TEST_CASE( base64_throughput )
+{
+   const std::string data = fc::test::make_random( fc::test::DATA_SIZE - fc::test::DATA_SIZE % 3 );
+
+   fc::time_point start = fc::time_point::now();
+   const std::string slow = fc::test::base64_encode_bytewise( data.data(), data.size() );
+   fc::test::report( "base64 encoded byte-wise", start, fc::time_point::now() );
+
+   start = fc::time_point::now();
+   const std::string b64 = fc::base64_encode( data );
+   fc::test::report( "base64 encoded", start, fc::time_point::now() );
+   BOOST_CHECK( slow == b64 );
+
+   start = fc::time_point::now();
+   const std::string decoded = fc::base64_decode( b64 );
+   fc::test::report( "base64 decoded", start, fc::time_point::now() );
+   BOOST_CHECK( data == decoded );
+}
+
+BOOST_AUTO_TEST_CASE( base58_public_keys )
+{
+   const size_t count = 20000;
+   std::vector<std::string> keys;
+   const std::string random = fc::test::make_random( count * 33 );
+   for( size_t i = 0; i < count; ++i )
+   {
+      keys.push_back( random.substr( i * 33, 33 ) );
+      keys.back()[0] = 2 + i % 2;
+   }
+
+   std::vector<std::string> legacy;
+   fc::time_point start = fc::time_point::now();
+   for( const auto& k : keys )
+      legacy.push_back( fc::test::legacy_to_base58( k.data(), k.size() ) );
+   fc::time_point end = fc::time_point::now();
+   ilog( "${c} public keys encoded with BIGNUM in ${t}µs", ("c",count)("t",end-start) );
+
+   std::vector<std::string> encoded;
+   start = fc::time_point::now();
+   for( const auto& k : keys )
+      encoded.push_back( fc::to_base58( k.data(), k.size() ) );
+   end = fc::time_point::now();
+   ilog( "${c} public keys encoded in ${t}µs", ("c",count)("t",end-start) );
+   BOOST_CHECK( legacy == encoded );
+
+   std::vector<char> out;
+   start = fc::time_point::now();
+   for( const auto& e : encoded )
+      fc::test::legacy_from_base58( e, out );
+   end = fc::time_point::now();
+   ilog( "${c} public keys decoded with BIGNUM in ${t}µs", ("c",count)("t",end-start) );
+
+   char key[33];
+   size_t total = 0;
+   start = fc::time_point::now();
+   for( const auto& e : encoded )
+      total += fc::from_base58( e, key, sizeof(key) );
+   end = fc::time_point::now();
+   ilog( "${c} public keys decoded in ${t}µs", ("c",count)("t",end-start) );
+   BOOST_CHECK_EQUAL( count * 33, total );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,9 +3,12 @@
 #include <fc/crypto/hex.hpp>
 #include <fc/crypto/base58.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/crypto/bigint.hpp>
 #include <fc/exception/exception.hpp>
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 static const std::string TEST1("");
 static const std::string TEST2("\0\00101", 4);
@@ -30,6 +33,58 @@ static void test_16( const std::string& test, const std::string& expected )
     }
 }
 
+namespace fc { namespace test {
+
+    static const char* base58_alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    /** The OpenSSL BIGNUM based encoder that was used before, as a reference */
+    std::string legacy_to_base58( const char* d, size_t s )
+    {
+        const fc::bigint b58( uint64_t(58) ), zero( uint64_t(0) );
+        fc::bigint bn( d, s );
+        std::string str;
+        while( bn > zero )
+        {
+            str += base58_alphabet[( bn % b58 ).to_int64()];
+            bn = bn / b58;
+        }
+        for( size_t i = 0; i < s && d[i] == 0; ++i )
+            str += base58_alphabet[0];
+        std::reverse( str.begin(), str.end() );
+        return str;
+    }
+
+    /** The OpenSSL BIGNUM based decoder that was used before, as a reference */
+    bool legacy_from_base58( const std::string& str, std::vector<char>& out )
+    {
+        const char* p = str.c_str();
+        while( isspace( (unsigned char)*p ) )
+            ++p;
+        const char* begin = p;
+        fc::bigint bn( uint64_t(0) );
+        for( ; *p; ++p )
+        {
+            const char* digit = strchr( base58_alphabet, *p );
+            if( digit == nullptr )
+            {
+                while( isspace( (unsigned char)*p ) )
+                    ++p;
+                if( *p != '\0' )
+                    return false;
+                break;
+            }
+            bn = bn * fc::bigint( uint64_t(58) ) + fc::bigint( uint64_t( digit - base58_alphabet ) );
+        }
+        out.clear();
+        for( p = begin; *p == base58_alphabet[0]; ++p )
+            out.push_back( 0 );
+        const std::vector<char> value = bn;
+        out.insert( out.end(), value.begin(), value.end() );
+        return true;
+    }
+
+} } // fc::test
+
 BOOST_AUTO_TEST_SUITE(fc_crypto)
 
 BOOST_AUTO_TEST_CASE(hex_test)
@@ -64,6 +119,59 @@ static void test_58( const std::string& test, const std::string& expected )
 
 }
 
+static std::string make_data( size_t len )
+{
+    std::string data( len, '\0' );
+    for( size_t i = 0; i < len; ++i )
+        data[i] = char( i * 167 + ( i >> 3 ) );
+    return data;
+}
+
+BOOST_AUTO_TEST_CASE(hex_buffer_test)
+{
+    // lengths around the 16 and 32 byte blocks of the vector kernels
+    for( size_t len = 0; len < 200; ++len )
+    {
+        const std::string data = make_data( len );
+        std::string expected;
+        for( unsigned char c : data )
+            expected += "0123456789abcdef"[c >> 4], expected += "0123456789abcdef"[c & 0x0f];
+
+        std::vector<char> hex( 2 * len + 1, 'x' );
+        BOOST_CHECK_EQUAL( 2 * len, fc::to_hex( data.data(), len, hex.data(), hex.size() ) );
+        BOOST_CHECK_EQUAL( expected, std::string( hex.data(), 2 * len ) );
+        BOOST_CHECK_EQUAL( 'x', hex.back() );
+        BOOST_CHECK_EQUAL( expected, fc::to_hex( data.data(), len ) );
+
+        std::string upper = expected;
+        for( char& c : upper )
+            c = toupper( c );
+        std::vector<char> out( len + 1, 'x' );
+        BOOST_CHECK_EQUAL( len, fc::from_hex( upper.data(), upper.size(), out.data(), out.size() ) );
+        BOOST_CHECK( !memcmp( data.data(), out.data(), len ) );
+        BOOST_CHECK_EQUAL( len / 2, fc::from_hex( expected, out.data(), len / 2 ) );
+    }
+    BOOST_CHECK_THROW( fc::to_hex( "abc", 3, nullptr, 5 ), fc::exception );
+
+    // every character at every position of a block
+    const std::string bytes = make_data( 64 );
+    const std::string valid = fc::to_hex( bytes.data(), bytes.size() );
+    char out[64];
+    for( int c = 0; c < 256; ++c )
+    {
+        const bool is_hex = isxdigit( c );
+        for( size_t pos = 0; pos < valid.size(); pos += 13 )
+        {
+            std::string hex = valid;
+            hex[pos] = char(c);
+            if( is_hex )
+                BOOST_CHECK_EQUAL( 64u, fc::from_hex( hex, out, sizeof(out) ) );
+            else
+                BOOST_CHECK_THROW( fc::from_hex( hex, out, sizeof(out) ), fc::exception );
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(base58_test)
 {
     test_58( TEST1, "" );
@@ -73,6 +181,45 @@ BOOST_AUTO_TEST_CASE(base58_test)
     test_58( TEST5, "111" );
 }
 
+BOOST_AUTO_TEST_CASE(base58_fuzz_test)
+{
+    uint64_t x = 0x2545f4914f6cdd1dULL;
+    auto next = [&x]() { x ^= x << 13; x ^= x >> 7; x ^= x << 17; return x; };
+    for( int round = 0; round < 2000; ++round )
+    {
+        // zero runs at the front and inside exercise leading '1's and empty limbs
+        std::string data( next() % 100, '\0' );
+        const size_t zeros = next() % 4 == 0 ? next() % 6 : 0;
+        for( size_t i = zeros; i < data.size(); ++i )
+            data[i] = next() % 5 == 0 ? 0 : char( next() );
+
+        const std::string expected = fc::test::legacy_to_base58( data.data(), data.size() );
+        BOOST_REQUIRE_EQUAL( expected, fc::to_base58( data.data(), data.size() ) );
+        char buffer[160];
+        BOOST_REQUIRE_EQUAL( expected.size(), fc::to_base58( data.data(), data.size(), buffer, sizeof(buffer) ) );
+        BOOST_REQUIRE_EQUAL( expected, std::string( buffer, expected.size() ) );
+
+        const std::vector<char> decoded = fc::from_base58( expected );
+        BOOST_REQUIRE( std::vector<char>( data.begin(), data.end() ) == decoded );
+        BOOST_REQUIRE_EQUAL( data.size(), fc::from_base58( expected, buffer, sizeof(buffer) ) );
+        BOOST_REQUIRE( data.empty() || !memcmp( data.data(), buffer, data.size() ) );
+    }
+
+    // random strings, including whitespace and characters outside the alphabet
+    const std::string chars = std::string( fc::test::base58_alphabet ) + " \t\n0OIl+/";
+    for( int round = 0; round < 2000; ++round )
+    {
+        std::string str( next() % 60, ' ' );
+        for( auto& c : str )
+            c = next() % 8 == 0 ? chars[58 + next() % 10] : chars[next() % 58];
+        std::vector<char> expected;
+        if( fc::test::legacy_from_base58( str, expected ) )
+            BOOST_REQUIRE( expected == fc::from_base58( str ) );
+        else
+            BOOST_REQUIRE_THROW( fc::from_base58( str ), fc::parse_error_exception );
+    }
+    BOOST_CHECK( std::vector<char>( 2, 0 ) == fc::from_base58( "  11 \n" ) );
+}
 
 static void test_64( const std::string& test, const std::string& expected )
 {
@@ -95,5 +242,55 @@ BOOST_AUTO_TEST_CASE(base64_test)
     test_64( TEST5, "AAAA" );
 }
 
+BOOST_AUTO_TEST_CASE(base64_buffer_test)
+{
+    for( size_t len = 0; len < 200; ++len )
+    {
+        const std::string data = make_data( len );
+        const std::string expected = fc::base64_encode( data );
+        BOOST_CHECK_EQUAL( fc::base64_encoded_size( len ), expected.size() );
+
+        std::vector<char> enc( fc::base64_encoded_size( len ) + 1, 'x' );
+        BOOST_CHECK_EQUAL( expected.size(), fc::base64_encode( data.data(), len, enc.data(), enc.size() ) );
+        BOOST_CHECK_EQUAL( expected, std::string( enc.data(), expected.size() ) );
+        BOOST_CHECK_EQUAL( 'x', enc.back() );
+
+        std::vector<char> dec( fc::base64_decoded_max_size( expected.size() ) );
+        const size_t dec_len = fc::base64_decode( expected.data(), expected.size(), dec.data(), dec.size() );
+        BOOST_CHECK_EQUAL( len, dec_len );
+        BOOST_CHECK( !memcmp( data.data(), dec.data(), len ) );
+        BOOST_CHECK_EQUAL( data, fc::base64_decode( expected ) );
+        BOOST_CHECK_EQUAL( data, fc::base64_decode( expected + "=" ) );
+
+        // unpadded input decodes to the same bytes
+        std::string unpadded = expected;
+        unpadded.erase( unpadded.find_last_not_of( '=' ) + 1 );
+        BOOST_CHECK_EQUAL( data, fc::base64_decode( unpadded ) );
+    }
+    char small[2];
+    BOOST_CHECK_THROW( fc::base64_decode( "AAAA", 4, small, sizeof(small) ), fc::exception );
+
+    // decoding stops at the first character that is not part of the alphabet
+    const std::string data  = make_data( 96 );
+    const std::string valid = fc::base64_encode( data );
+    for( int c = 0; c < 256; ++c )
+    {
+        const bool is_b64 = isalnum( c ) || c == '+' || c == '/';
+        for( size_t pos = 0; pos < valid.size(); pos += 12 )
+        {
+            std::string enc = valid;
+            enc[pos] = char(c);
+            const std::string dec = fc::base64_decode( enc );
+            if( is_b64 )
+                BOOST_CHECK_EQUAL( data.size(), dec.size() );
+            else
+            {
+                BOOST_CHECK_EQUAL( pos / 4 * 3, dec.size() );
+                BOOST_CHECK_EQUAL( data.substr( 0, dec.size() ), dec );
+            }
+        }
+    }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
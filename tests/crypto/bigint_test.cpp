@@ -2,6 +2,40 @@
 
 #include <fc/variant.hpp>
 #include <fc/crypto/bigint.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/uint256.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+namespace {
+    constexpr fc::uint256_t two_pow_200 = fc::uint256_t(1) << 200;
+    static_assert( ( two_pow_200 * 3 - 1 ) >> 200 == 2, "constexpr arithmetic" );
+    static_assert( fc::int256_t(-5) * 7 < fc::int256_t(-34), "constexpr signed arithmetic" );
+
+    /** a value with the given number of pseudo random bits */
+    fc::bigint random_bigint( uint32_t seed, uint32_t bits )
+    {
+        std::vector<char> bytes;
+        for( uint32_t i = 0; bytes.size() * 8 < bits; ++i )
+        {
+            const fc::sha256 h = fc::sha256::hash( std::to_string( seed ) + "/" + std::to_string( i ) );
+            bytes.insert( bytes.end(), h.data(), h.data() + h.data_size() );
+        }
+        bytes.resize( bits / 8 );
+        if( !bytes.empty() )
+            bytes[0] |= 0x80;
+        return fc::bigint( bytes );
+    }
+
+    template<typename T>
+    T to_fixed( const fc::bigint& b )
+    {
+        T v;
+        fc::from_bigint( b, v );
+        return v;
+    }
+}
 
 BOOST_AUTO_TEST_SUITE(fc_crypto)
 
@@ -75,5 +109,105 @@ BOOST_AUTO_TEST_CASE(bigint_test_2)
     BOOST_CHECK_EQUAL( (std::string) big, "38685626840157682946539517" );
 }
 
+BOOST_AUTO_TEST_CASE(uint256_test)
+{
+    // arithmetic agrees with bigint
+    for( uint32_t i = 0; i < 200; ++i )
+    {
+        const fc::bigint a = random_bigint( i, 64 + i % 64 * 3 ), b = random_bigint( i + 1000, 8 + i % 28 * 2 );
+        const fc::uint256_t ua = to_fixed<fc::uint256_t>( a ), ub = to_fixed<fc::uint256_t>( b );
+        BOOST_CHECK( fc::to_bigint( ua ) == a );
+        BOOST_CHECK( fc::to_bigint( ua + ub ) == a + b );
+        BOOST_CHECK( fc::to_bigint( ua - ub ) == a - b );
+        BOOST_CHECK( fc::to_bigint( ua / ub ) == a / b );
+        BOOST_CHECK( fc::to_bigint( ua % ub ) == a % b );
+        BOOST_CHECK( fc::to_bigint( fc::uint512_t( ua ) * ub ) == a * b );
+        fc::bigint shifted( a );
+        shifted >>= i % 70;
+        BOOST_CHECK( fc::to_bigint( ua >> ( i % 70 ) ) == shifted );
+        BOOST_CHECK_EQUAL( ua < ub, a < b );
+        BOOST_CHECK_EQUAL( (std::string) a, ua.str() );
+
+        const fc::int256_t sa = -to_fixed<fc::int256_t>( a );
+        const fc::bigint negative_a = fc::bigint( uint64_t(0) ) - a;
+        BOOST_CHECK( fc::to_bigint( sa ) == negative_a );
+        BOOST_CHECK( to_fixed<fc::int256_t>( negative_a ) == sa );
+        BOOST_CHECK( fc::to_bigint( sa + fc::int256_t( ub ) ) == negative_a + b );
+    }
+
+    // unsigned arithmetic wraps
+    BOOST_CHECK( fc::uint256_t(0) - 1 == ( fc::uint512_t(1) << 256 ) - 1 );
+    BOOST_CHECK( ( two_pow_200 << 56 ) == 0 );
+
+    fc::uint256_t too_small;
+    BOOST_CHECK_THROW( fc::from_bigint( random_bigint( 1, 264 ), too_small ), fc::exception );
+    BOOST_CHECK_THROW( fc::from_bigint( fc::bigint( uint64_t(0) ) - fc::bigint( uint64_t(1) ), too_small ), fc::exception );
+
+    // variant and raw serialization
+    const std::vector<fc::int256_t> values = { 0, 1, -1, fc::int256_t( two_pow_200 ), -fc::int256_t( two_pow_200 ),
+                                               ( fc::int256_t(1) << 255 ) - 1, -( fc::int256_t(1) << 255 ) };
+    for( const auto& v : values )
+    {
+        fc::variant var;
+        fc::to_variant( v, var );
+        fc::int256_t from_var;
+        fc::from_variant( var, from_var );
+        BOOST_CHECK( from_var == v );
+
+        const std::vector<char> packed = fc::raw::pack( v );
+        BOOST_CHECK_EQUAL( 32u, packed.size() );
+        BOOST_CHECK( fc::raw::unpack<fc::int256_t>( packed ) == v );
+    }
+    BOOST_CHECK_THROW( fc::raw::pack( fc::int256_t(1) << 255 ), fc::exception );
+
+    // non-negative values pack as the padded big endian bytes of bigint
+    const fc::bigint b = random_bigint( 7, 200 );
+    const std::vector<char> bytes = b;
+    const std::vector<char> packed = fc::raw::pack( to_fixed<fc::uint256_t>( b ) );
+    BOOST_CHECK( std::equal( bytes.begin(), bytes.end(), packed.end() - bytes.size() ) );
+    BOOST_CHECK( fc::raw::unpack<fc::uint512_t>( fc::raw::pack( fc::uint512_t( 0 ) - 1 ) ) == fc::uint512_t( 0 ) - 1 );
+
+    fc::uint256_t parsed;
+    fc::from_variant( fc::variant( uint64_t(12345) ), parsed );
+    BOOST_CHECK( parsed == 12345 );
+    fc::from_variant( fc::variant( "0x100000000000000000000" ), parsed );
+    BOOST_CHECK( parsed == fc::uint256_t(1) << 80 );
+    BOOST_CHECK_THROW( fc::from_variant( fc::variant( "12x" ), parsed ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE(uint256_benchmark)
+{
+    // share and price calculations: amount * numerator / denominator, summed up
+    const int rounds = 200000;
+    const fc::bigint numerator = random_bigint( 1, 100 ), denominator = random_bigint( 2, 120 );
+    const fc::bigint base = random_bigint( 3, 128 );
+
+    fc::time_point begin = fc::time_point::now();
+    fc::bigint bn_sum( uint64_t(0) ), bn_amount( base );
+    for( int i = 0; i < rounds; ++i )
+    {
+        bn_sum += bn_amount * numerator / denominator;
+        fc::bigint step = fc::bigint( uint64_t( i ) );
+        step <<= 64;
+        bn_amount += step;
+    }
+    const fc::microseconds bn_time = fc::time_point::now() - begin;
+
+    begin = fc::time_point::now();
+    const fc::uint256_t u_numerator = to_fixed<fc::uint256_t>( numerator );
+    const fc::uint256_t u_denominator = to_fixed<fc::uint256_t>( denominator );
+    fc::uint256_t u_sum( 0 ), u_amount = to_fixed<fc::uint256_t>( base );
+    for( int i = 0; i < rounds; ++i )
+    {
+        u_sum += u_amount * u_numerator / u_denominator;
+        u_amount += fc::uint256_t( i ) << 64;
+    }
+    const fc::microseconds u_time = fc::time_point::now() - begin;
+
+    BOOST_CHECK( fc::to_bigint( u_sum ) == bn_sum );
+    ilog( "${r} rounds of multiply, divide, shift and add: bigint ${b}µs, uint256_t ${u}µs",
+          ("r",rounds)("b",bn_time.count())("u",u_time.count()) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,115 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/crc32c.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+static uint32_t reference_crc32c( const char* data, size_t len, uint32_t crc = 0 )
+{
+   crc = ~crc;
+   for( size_t i = 0; i < len; ++i )
+   {
+      crc ^= uint8_t(data[i]);
+      for( int b = 0; b < 8; ++b )
+         crc = ( crc >> 1 ) ^ ( 0x82f63b78 & ( 0 - ( crc & 1 ) ) );
+   }
+   return ~crc;
+}
+
+static std::vector<char> test_data( size_t len )
+{
+   std::vector<char> data( len );
+   uint32_t x = 0x12345678;
+   for( auto& c : data )
+   {
+      x = x * 1664525 + 1013904223;
+      c = char( x >> 24 );
+   }
+   return data;
+}
+
+BOOST_AUTO_TEST_SUITE(fc_crypto)
+
+BOOST_AUTO_TEST_CASE(crc32c_test)
+{
+   // check values of RFC 3720
+   const std::string digits = "123456789";
+   BOOST_CHECK_EQUAL( 0xe3069283u, fc::crc32c( digits.data(), digits.size() ) );
+   std::vector<char> zeros( 32, 0 ), ones( 32, char(0xff) );
+   BOOST_CHECK_EQUAL( 0x8a9136aau, fc::crc32c( zeros.data(), zeros.size() ) );
+   BOOST_CHECK_EQUAL( 0x62a8ab43u, fc::crc32c( ones.data(), ones.size() ) );
+   BOOST_CHECK_EQUAL( 0u, fc::crc32c( nullptr, 0 ) );
+
+   // all lengths around the block sizes of the interleaved loops, at every alignment
+   const std::vector<char> data = test_data( 3 * 8192 * 2 + 64 );
+   for( size_t len : { 1, 7, 8, 9, 63, 767, 768, 769, 1000, 4096, 24575, 24576, 24577, 3 * 8192 * 2 } )
+      for( size_t offset = 0; offset < 8; ++offset )
+         BOOST_CHECK_EQUAL( reference_crc32c( data.data() + offset, len ),
+                            fc::crc32c( data.data() + offset, len ) );
+
+   // continued checksums equal the checksum of the concatenation
+   const uint32_t whole = fc::crc32c( data.data(), data.size() );
+   for( size_t split : { 0, 1, 13, 800, 10000, 30000 } )
+   {
+      const uint32_t first = fc::crc32c( data.data(), split );
+      BOOST_CHECK_EQUAL( whole, fc::crc32c( data.data() + split, data.size() - split, first ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(city_hash_crc_test)
+{
+   // city_hash_crc_128 is persisted by some users, the selected crc32 implementation must
+   // not change its value
+   std::vector<char> data( 5000 );
+   for( size_t i = 0; i < data.size(); ++i )
+      data[i] = char( i * 7 + 3 );
+   const struct { size_t len; uint64_t hi; uint64_t lo; } expected[] = {
+      {    0, 0xca2642970ae4f613ull, 0xa544c83f95b80960ull },
+      {  100, 0xef1a9ebbb4764853ull, 0x414b62ad90b3a62bull },
+      {  901, 0x64417e9949c586e9ull, 0x3bd06310d59937a5ull },
+      { 1000, 0xed6a1bcd7605a2caull, 0x30fec6a4954218b0ull },
+      { 4096, 0xbaaef4ff95392eb4ull, 0xf84c1a62825ca579ull },
+      { 5000, 0xf2272b0c69eac737ull, 0xb40194aadb46357cull },
+   };
+   for( const auto& e : expected )
+   {
+      const fc::uint128_t h = fc::city_hash_crc_128( data.data(), e.len );
+      BOOST_CHECK_EQUAL( e.hi, fc::uint128_hi64( h ) );
+      BOOST_CHECK_EQUAL( e.lo, fc::uint128_lo64( h ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_benchmark)
+{
+   const size_t total = 256 * 1024 * 1024;
+   for( size_t len : { 64, 4096, 1024 * 1024 } )
+   {
+      const std::vector<char> data = test_data( len );
+      const size_t rounds = total / len;
+      uint32_t crc = 0;
+      fc::time_point start = fc::time_point::now();
+      for( size_t i = 0; i < rounds; ++i )
+         crc = fc::crc32c( data.data(), len, crc );
+      fc::microseconds elapsed = fc::time_point::now() - start;
+      ilog( "crc32c of ${r} buffers of ${l} bytes in ${t}µs, ${m} MB/s",
+            ("r",rounds)("l",len)("t",elapsed.count())("m",total / std::max<int64_t>( elapsed.count(), 1 )) );
+      BOOST_CHECK_EQUAL( reference_crc32c( data.data(), len ), fc::crc32c( data.data(), len ) );
+   }
+
+   const std::vector<char> data = test_data( 1024 * 1024 );
+   fc::time_point start = fc::time_point::now();
+   uint64_t sum = 0;
+   for( size_t i = 0; i < total / data.size(); ++i )
+      sum += fc::uint128_lo64( fc::city_hash_crc_128( data.data(), data.size() ) );
+   fc::microseconds elapsed = fc::time_point::now() - start;
+   ilog( "city_hash_crc_128 of 256 MB in 1 MB buffers in ${t}µs, ${m} MB/s",
+         ("t",elapsed.count())("m",total / std::max<int64_t>( elapsed.count(), 1 )) );
+   BOOST_CHECK( sum != 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
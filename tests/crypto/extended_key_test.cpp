@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+BOOST_AUTO_TEST_SUITE(fc_crypto)
+
+BOOST_AUTO_TEST_CASE(derive_children_test)
+{ try {
+   const auto master = fc::ecc::extended_private_key::generate_master( "derive_children_test" );
+   const auto parent = master.get_extended_public_key();
+
+   const auto children = parent.derive_children( 10, 300 );
+   BOOST_REQUIRE_EQUAL( 300u, children.size() );
+   for( uint32_t n = 0; n < children.size(); ++n )
+      BOOST_CHECK_EQUAL( parent.derive_normal_child( 10 + n ).str(), children[n].str() );
+   // and match the public halves of the private derivation
+   BOOST_CHECK_EQUAL( master.derive_normal_child( 10 ).get_extended_public_key().str(), children[0].str() );
+
+   BOOST_CHECK( parent.derive_children( 0, 0 ).empty() );
+   BOOST_CHECK_EQUAL( 1u, parent.derive_children( 0x7fffffff, 1 ).size() );
+   BOOST_CHECK_THROW( parent.derive_children( 0x7fffffff, 2 ), fc::assert_exception );
+   BOOST_CHECK_THROW( parent.derive_children( -1, 1 ), fc::assert_exception );
+} FC_LOG_AND_RETHROW() }
+
+// public derivations from test vector 1 of BIP-0032, m/0H -> m/0H/1 and m/0H/1/2H/2 -> m/0H/1/2H/2/1000000000
+BOOST_AUTO_TEST_CASE(derive_children_bip32_test)
+{ try {
+   const auto m_0h = fc::ecc::extended_public_key::from_base58( "xpub68Gmy5EdvgibQVfPdqkBBCHxA5htiqg55crXYuXoQRKfDBFA1WEjWgP6LHhwBZeNK1VTsfTFUHCdrfp1bgwQ9xv5ski8PX9rL2dZXvgGDnw" );
+   const auto m_0h_1 = m_0h.derive_children( 0, 2 );
+   BOOST_REQUIRE_EQUAL( 2u, m_0h_1.size() );
+   BOOST_CHECK_EQUAL( "xpub6ASuArnXKPbfEwhqN6e3mwBcDTgzisQN1wXN9BJcM47sSikHjJf3UFHKkNAWbWMiGj7Wf5uMash7SyYq527Hqck2AxYysAA7xmALppuCkwQ",
+                      m_0h_1[1].str() );
+
+   const auto m_0h_1_2h_2 = fc::ecc::extended_public_key::from_base58( "xpub6FHa3pjLCk84BayeJxFW2SP4XRrFd1JYnxeLeU8EqN3vDfZmbqBqaGJAyiLjTAwm6ZLRQUMv1ZACTj37sR62cfN7fe5JnJ7dh8zL4fiyLHV" );
+   const auto children = m_0h_1_2h_2.derive_children( 1000000000 - 200, 201 );
+   BOOST_REQUIRE_EQUAL( 201u, children.size() );
+   BOOST_CHECK_EQUAL( "xpub6H1LXWLaKsWFhvm6RVpEL9P4KfRZSW7abD2ttkWP3SSQvnyA8FSVqNTEcYFgJS2UaFcxupHiYkro49S8yGasTvXEYBVPamhGW6cFJodrTHy",
+                      children.back().str() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(derive_children_benchmark)
+{ try {
+   const auto parent = fc::ecc::extended_private_key::generate_master( "derive_children_benchmark" )
+                          .get_extended_public_key();
+   const uint32_t count = 2000;
+
+   fc::time_point start = fc::time_point::now();
+   std::vector<fc::ecc::extended_public_key> looped;
+   for( uint32_t i = 0; i < count; ++i )
+      looped.push_back( parent.derive_normal_child( i ) );
+   fc::time_point end = fc::time_point::now();
+   ilog( "${c} derive_normal_child calls in ${t}µs", ("c",count)("t",end-start) );
+
+   start = fc::time_point::now();
+   const auto ranged = parent.derive_children( 0, count );
+   end = fc::time_point::now();
+   ilog( "derive_children of ${c} keys in ${t}µs", ("c",count)("t",end-start) );
+
+   BOOST_REQUIRE_EQUAL( looped.size(), ranged.size() );
+   BOOST_CHECK( looped.back().serialize_extended() == ranged.back().serialize_extended() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/key_map.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+using fc::ecc::public_key;
+using fc::ecc::public_key_data;
+
+namespace {
+   /** pseudo random key bytes, the map does not care whether they are on the curve */
+   std::vector<public_key_data> make_keys( size_t count, uint32_t seed )
+   {
+      std::vector<public_key_data> keys( count );
+      for( size_t i = 0; i < count; ++i )
+      {
+         const fc::sha256 h = fc::sha256::hash( std::to_string( seed ) + "/" + std::to_string( i ) );
+         keys[i][0] = 2 + ( h.data()[0] & 1 );
+         memcpy( keys[i].data() + 1, h.data(), 32 );
+      }
+      return keys;
+   }
+
+   /** counts the bytes held by a container */
+   size_t allocated_bytes = 0;
+
+   template<typename T>
+   struct counting_allocator : std::allocator<T>
+   {
+      template<typename U> struct rebind { typedef counting_allocator<U> other; };
+      counting_allocator() = default;
+      template<typename U> counting_allocator( const counting_allocator<U>& ) {}
+
+      T* allocate( size_t n )
+      {
+         allocated_bytes += n * sizeof(T);
+         return std::allocator<T>::allocate( n );
+      }
+      void deallocate( T* p, size_t n )
+      {
+         allocated_bytes -= n * sizeof(T);
+         std::allocator<T>::deallocate( p, n );
+      }
+   };
+}
+
+BOOST_AUTO_TEST_SUITE(fc_crypto)
+
+BOOST_AUTO_TEST_CASE(public_key_hash_test)
+{
+   const std::vector<public_key_data> keys = make_keys( 1000, 1 );
+   const public_key a( keys[0] ), a2( keys[0] ), b( keys[1] );
+
+   BOOST_CHECK( a == a2 );
+   BOOST_CHECK( a != b );
+   BOOST_CHECK( a.key_data() == keys[0] );
+
+   fc::ecc::public_key_hash h;
+   BOOST_CHECK_EQUAL( h( a ), h( keys[0] ) );
+   BOOST_CHECK_EQUAL( std::hash<public_key>()( a ), h( a ) );
+   BOOST_CHECK( fc::ecc::public_key_equal()( a, keys[0] ) );
+   BOOST_CHECK( !fc::ecc::public_key_equal()( keys[1], a ) );
+   BOOST_CHECK_EQUAL( fc::ecc::public_key_less()( a, b ), keys[0] < keys[1] );
+
+   // keys differing in a single byte hash differently
+   std::set<size_t> hashes;
+   for( size_t i = 0; i < keys[0].size(); ++i )
+   {
+      public_key_data k = keys[0];
+      k[i] ^= 1;
+      hashes.insert( h( k ) );
+   }
+   BOOST_CHECK_EQUAL( hashes.size(), keys[0].size() );
+
+   std::unordered_set<public_key> set;
+   for( const auto& k : keys )
+      set.insert( public_key( k ) );
+   BOOST_CHECK_EQUAL( set.size(), keys.size() );
+   BOOST_CHECK( set.count( b ) == 1 );
+
+   std::map<public_key, int, fc::ecc::public_key_less> ordered;
+   ordered[a] = 1;
+   ordered[b] = 2;
+   BOOST_CHECK_EQUAL( ordered.find( keys[1] )->second, 2 );
+}
+
+BOOST_AUTO_TEST_CASE(public_key_encodings_test)
+{
+   // keys made by secp256k1 compare, hash and look up the same whichever encoding they were read from
+   fc::ecc::public_key_hash h;
+   fc::key_map<uint32_t> map;
+   std::vector<public_key> keys;
+   for( uint32_t i = 0; i < 50; ++i )
+   {
+      keys.push_back( fc::ecc::private_key::regenerate( fc::sha256::hash( std::to_string( i ) ) ).get_public_key() );
+      map.insert( keys.back(), i );
+   }
+   for( uint32_t i = 0; i < keys.size(); ++i )
+   {
+      const public_key& k = keys[i];
+      const public_key from_point( k.serialize_ecc_point() );
+      const public_key from_base58 = public_key::from_base58( k.to_base58() );
+      BOOST_CHECK( k.key_data() == k.serialize() );
+      BOOST_CHECK( from_point == k );
+      BOOST_CHECK( from_base58 == k );
+      BOOST_CHECK_EQUAL( h( from_point ), h( k ) );
+      BOOST_CHECK_EQUAL( h( from_base58 ), h( k ) );
+      BOOST_REQUIRE( map.find( from_point ) != nullptr );
+      BOOST_CHECK_EQUAL( i, *map.find( from_point ) );
+      BOOST_CHECK( k != keys[ ( i + 1 ) % keys.size() ] );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(key_map_test)
+{
+   const std::vector<public_key_data> keys = make_keys( 20000, 2 );
+   fc::key_map<std::string> map;
+   std::map<public_key_data, std::string> reference;
+
+   for( size_t i = 0; i < keys.size(); ++i )
+   {
+      auto r = map.insert( keys[i], std::to_string( i ) );
+      BOOST_REQUIRE( r.second );
+      reference[keys[i]] = std::to_string( i );
+   }
+   BOOST_CHECK( !map.insert( keys[5], "x" ).second );
+   BOOST_CHECK_EQUAL( *map.insert( keys[5], "x" ).first, "5" );
+   BOOST_CHECK_EQUAL( map.size(), keys.size() );
+   BOOST_CHECK( map.size() <= map.capacity() - map.capacity() / 8 );
+
+   // erase every third key, some twice
+   for( size_t i = 0; i < keys.size(); i += 3 )
+   {
+      BOOST_CHECK( map.erase( keys[i] ) );
+      BOOST_CHECK( !map.erase( keys[i] ) );
+      reference.erase( keys[i] );
+   }
+   BOOST_CHECK_EQUAL( map.size(), reference.size() );
+   for( size_t i = 0; i < keys.size(); ++i )
+   {
+      const std::string* v = map.find( keys[i] );
+      auto itr = reference.find( keys[i] );
+      BOOST_REQUIRE_EQUAL( v != nullptr, itr != reference.end() );
+      if( v )
+         BOOST_CHECK_EQUAL( *v, itr->second );
+   }
+   for( const auto& k : make_keys( 1000, 3 ) )
+      BOOST_CHECK( !map.contains( k ) );
+   BOOST_CHECK_THROW( map.at( keys[0] ), fc::exception );
+
+   size_t visited = 0;
+   map.for_each( [&]( const public_key_data& k, std::string& v ) {
+      BOOST_CHECK_EQUAL( reference[k], v );
+      ++visited;
+   } );
+   BOOST_CHECK_EQUAL( visited, reference.size() );
+
+   map[ keys[0] ] = "zero";
+   map[ public_key( keys[1] ) ] += "!";
+   BOOST_CHECK_EQUAL( map.at( keys[0] ), "zero" );
+   BOOST_CHECK_EQUAL( *map.find( public_key( keys[1] ) ), "1!" );
+
+   fc::key_map<std::string> moved( std::move( map ) );
+   BOOST_CHECK( map.empty() );
+   BOOST_CHECK( !map.contains( keys[0] ) );
+   BOOST_CHECK( moved.contains( keys[0] ) );
+   map.insert( keys[0], "again" );
+   BOOST_CHECK_EQUAL( map.size(), 1u );
+
+   moved.clear();
+   BOOST_CHECK( moved.empty() );
+   BOOST_CHECK( !moved.contains( keys[1] ) );
+}
+
+BOOST_AUTO_TEST_CASE(key_map_benchmark)
+{
+   const std::vector<public_key_data> all_keys = make_keys( 2000000, 4 );
+   const std::vector<public_key_data> missing = make_keys( 2000000, 5 );
+
+   // the memory per entry of key_map depends on the load factor, which is highest right
+   // before the table doubles and lowest right after it
+   for( size_t count : { 1800000, 2000000 } )
+   {
+      const std::vector<public_key_data> keys( all_keys.begin(), all_keys.begin() + count );
+      auto measure = [&]( const std::string& name, size_t bytes, const std::function<size_t( const public_key_data& )>& find,
+                          fc::microseconds insert_time ) {
+         size_t found = 0;
+         fc::time_point start = fc::time_point::now();
+         for( size_t i = 0; i < count; ++i )
+            found += find( keys[ ( i * 7919 ) % count ] );
+         const fc::microseconds hit_time = fc::time_point::now() - start;
+         start = fc::time_point::now();
+         for( size_t i = 0; i < count; ++i )
+            found += find( missing[i] );
+         const fc::microseconds miss_time = fc::time_point::now() - start;
+         BOOST_CHECK_EQUAL( found, count );
+         ilog( "${n} with ${c} entries: ${b} bytes per entry, insert ${i} ns, hit ${h} ns, miss ${m} ns",
+               ("n",name)("c",count)("b",bytes / count)("i",insert_time.count() * 1000 / count)
+               ("h",hit_time.count() * 1000 / count)("m",miss_time.count() * 1000 / count) );
+      };
+
+      {
+         fc::time_point start = fc::time_point::now();
+         fc::key_map<uint64_t> map;
+         for( size_t i = 0; i < count; ++i )
+            map.insert( keys[i], i );
+         const fc::microseconds insert_time = fc::time_point::now() - start;
+         measure( "key_map", map.memory_usage(), [&map]( const public_key_data& k ) {
+            return size_t( map.find( k ) != nullptr );
+         }, insert_time );
+      }
+
+      {
+         allocated_bytes = 0;
+         fc::time_point start = fc::time_point::now();
+         std::unordered_map<public_key_data, uint64_t, fc::ecc::public_key_hash, fc::ecc::public_key_equal,
+                            counting_allocator<std::pair<const public_key_data, uint64_t>>> map;
+         for( size_t i = 0; i < count; ++i )
+            map.emplace( keys[i], i );
+         const fc::microseconds insert_time = fc::time_point::now() - start;
+         measure( "std::unordered_map", allocated_bytes, [&map]( const public_key_data& k ) {
+            return map.count( k );
+         }, insert_time );
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
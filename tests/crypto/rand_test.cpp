@@ -1,8 +1,20 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
 
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 static void check_randomness( const char* buffer, size_t len ) {
     if (len == 0) { return; }
@@ -29,4 +41,89 @@ BOOST_AUTO_TEST_CASE(rand_test)
     check_randomness( buffer, sizeof(buffer) );
 }
 
+BOOST_AUTO_TEST_CASE(rand_bytes_test)
+{ try {
+    // both the buffered and the direct path, and requests that span refills of the buffer
+    for( int size : { 0, 1, 31, 32, 255, 256, 1000, 5000 } )
+    {
+        std::vector<char> a( size + 1, 0 ), b( size + 1, 0 );
+        fc::rand_bytes( a.data(), size );
+        fc::rand_bytes( b.data(), size );
+        BOOST_CHECK_EQUAL( 0, a[size] );
+        check_randomness( a.data(), size );
+        if( size >= 16 )
+            BOOST_CHECK( memcmp( a.data(), b.data(), size ) != 0 );
+    }
+
+    std::vector<char> bulk( 3 * 1024 * 1024 + 7 );
+    fc::rand_fill( bulk.data(), bulk.size() );
+    check_randomness( bulk.data(), bulk.size() );
+    // passes the reseed interval
+    for( int i = 0; i < 5000; ++i )
+        fc::rand_bytes( bulk.data(), 300 );
+
+    BOOST_CHECK_THROW( fc::rand_bytes( bulk.data(), -1 ), fc::assert_exception );
+} FC_LOG_AND_RETHROW() }
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(rand_fork_test)
+{ try {
+    char warmup[16];
+    fc::rand_bytes( warmup, sizeof(warmup) );
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL( 0, pipe( fds ) );
+    const pid_t child = fork();
+    BOOST_REQUIRE( child >= 0 );
+    if( child == 0 )
+    {
+        char nonce[32];
+        fc::rand_bytes( nonce, sizeof(nonce) );
+        const bool written = write( fds[1], nonce, sizeof(nonce) ) == sizeof(nonce);
+        _exit( written ? 0 : 1 );
+    }
+    char parent_nonce[32], child_nonce[32];
+    fc::rand_bytes( parent_nonce, sizeof(parent_nonce) );
+    BOOST_CHECK_EQUAL( sizeof(child_nonce), size_t( read( fds[0], child_nonce, sizeof(child_nonce) ) ) );
+    int status;
+    waitpid( child, &status, 0 );
+    close( fds[0] );
+    close( fds[1] );
+    // the child reseeds instead of continuing with the state of its parent
+    BOOST_CHECK( memcmp( parent_nonce, child_nonce, sizeof(parent_nonce) ) != 0 );
+} FC_LOG_AND_RETHROW() }
+#endif
+
+BOOST_AUTO_TEST_CASE(rand_benchmark)
+{ try {
+    const int thread_count = 32;
+    const int nonces       = 20000;
+
+    std::vector<std::unique_ptr<fc::thread>> threads;
+    for( int i = 0; i < thread_count; ++i )
+        threads.emplace_back( new fc::thread( "rand" ) );
+
+    auto run = [&]( const std::string& name, void (*generate)( char*, int ) ) {
+        const fc::time_point start = fc::time_point::now();
+        std::vector<fc::future<void>> done;
+        for( auto& t : threads )
+            done.push_back( t->async( [generate,nonces] () {
+                char nonce[32];
+                for( int i = 0; i < nonces; ++i )
+                    generate( nonce, sizeof(nonce) );
+            } ) );
+        for( auto& d : done )
+            d.wait();
+        const fc::time_point end = fc::time_point::now();
+        ilog( "${n}: ${c} 32 byte nonces on ${t} threads in ${u}µs",
+              ("n",name)("c",thread_count * nonces)("t",thread_count)("u",end-start) );
+    };
+
+    run( "OpenSSL RAND_bytes", fc::rand_system_bytes );
+    run( "rand_bytes", fc::rand_bytes );
+
+    for( auto& t : threads )
+        t->quit();
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/crypto/recovery_cache.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+namespace fc { namespace test {
+
+   fc::ecc::compact_signature make_signature( uint32_t i )
+   {
+      fc::ecc::compact_signature sig;
+      memcpy( sig.data(), &i, sizeof(i) );
+      sig[64] = 27;
+      return sig;
+   }
+
+   fc::ecc::public_key_data make_key( uint32_t i )
+   {
+      fc::ecc::public_key_data key;
+      key[0] = 2;
+      memcpy( key.data() + 1, &i, sizeof(i) );
+      return key;
+   }
+
+} } // fc::test
+
+BOOST_AUTO_TEST_SUITE(fc_crypto)
+
+BOOST_AUTO_TEST_CASE(recovery_cache_test)
+{ try {
+   const fc::sha256 digest = fc::sha256::hash( "digest" );
+   fc::ecc::recovery_cache cache( 100, 1 );
+   fc::ecc::public_key_data key;
+
+   BOOST_CHECK( !cache.get( digest, fc::test::make_signature( 1 ), key ) );
+   cache.put( digest, fc::test::make_signature( 1 ), fc::test::make_key( 1 ) );
+   BOOST_CHECK( cache.get( digest, fc::test::make_signature( 1 ), key ) );
+   BOOST_CHECK( fc::test::make_key( 1 ) == key );
+   // both parts of the key have to match
+   BOOST_CHECK( !cache.get( fc::sha256::hash( "other" ), fc::test::make_signature( 1 ), key ) );
+   BOOST_CHECK( !cache.get( digest, fc::test::make_signature( 2 ), key ) );
+
+   auto stats = cache.get_stats();
+   BOOST_CHECK_EQUAL( 1u, stats.hits );
+   BOOST_CHECK_EQUAL( 3u, stats.misses );
+   BOOST_CHECK_EQUAL( 1u, stats.size );
+
+   // fill the cache and use the first half, the second half is evicted first
+   for( uint32_t i = 2; i <= 100; ++i )
+      cache.put( digest, fc::test::make_signature( i ), fc::test::make_key( i ) );
+   for( uint32_t i = 1; i <= 50; ++i )
+      BOOST_CHECK( cache.get( digest, fc::test::make_signature( i ), key ) );
+   for( uint32_t i = 101; i <= 140; ++i )
+      cache.put( digest, fc::test::make_signature( i ), fc::test::make_key( i ) );
+
+   stats = cache.get_stats();
+   BOOST_CHECK_EQUAL( 100u, stats.size );
+   BOOST_CHECK_EQUAL( 40u, stats.evictions );
+   for( uint32_t i = 1; i <= 50; ++i )
+   {
+      BOOST_CHECK( cache.get( digest, fc::test::make_signature( i ), key ) );
+      BOOST_CHECK( fc::test::make_key( i ) == key );
+   }
+   for( uint32_t i = 101; i <= 140; ++i )
+      BOOST_CHECK( cache.get( digest, fc::test::make_signature( i ), key ) );
+
+   cache.clear();
+   BOOST_CHECK_EQUAL( 0u, cache.get_stats().size );
+   BOOST_CHECK( !cache.get( digest, fc::test::make_signature( 1 ), key ) );
+
+   // capacity is shared between the shards
+   fc::ecc::recovery_cache sharded( 64, 8 );
+   for( uint32_t i = 0; i < 1000; ++i )
+      sharded.put( digest, fc::test::make_signature( i ), fc::test::make_key( i ) );
+   BOOST_CHECK_EQUAL( 64u, sharded.get_stats().size );
+   BOOST_CHECK_THROW( fc::ecc::recovery_cache( 0 ), fc::assert_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(recovery_cache_install_test)
+{ try {
+   const auto priv   = fc::ecc::private_key::generate();
+   const auto digest = fc::sha256::hash( "message" );
+   const auto sig    = priv.sign_compact( digest );
+
+   auto cache = std::make_shared<fc::ecc::recovery_cache>( 16 );
+   fc::ecc::recovery_cache::install( cache );
+   BOOST_CHECK( priv.get_public_key() == fc::ecc::public_key( sig, digest ) );
+   BOOST_CHECK( priv.get_public_key() == fc::ecc::public_key( sig, digest ) );
+   BOOST_CHECK_EQUAL( 1u, cache->get_stats().hits );
+   BOOST_CHECK_EQUAL( 1u, cache->get_stats().misses );
+
+   // the checks in front of the recovery still apply
+   fc::ecc::compact_signature bad = sig;
+   bad[0] = 0;
+   BOOST_CHECK_THROW( fc::ecc::public_key( bad, digest ), fc::exception );
+
+   fc::ecc::recovery_cache::install( nullptr );
+   BOOST_CHECK( priv.get_public_key() == fc::ecc::public_key( sig, digest ) );
+   BOOST_CHECK_EQUAL( 1u, cache->get_stats().hits );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(recovery_cache_benchmark)
+{ try {
+   // every transaction is seen a few times (mempool, block production and application) and
+   // verified as often, so most of the lookups of a busy node are hits
+   const uint32_t transactions = 2000;
+   const uint32_t verifications_per_transaction = 5;
+
+   std::vector<fc::sha256> digests;
+   std::vector<fc::ecc::compact_signature> signatures;
+   const auto priv = fc::ecc::private_key::generate();
+   for( uint32_t i = 0; i < transactions; ++i )
+   {
+      digests.push_back( fc::sha256::hash( i ) );
+      signatures.push_back( priv.sign_compact( digests.back() ) );
+   }
+
+   // each transaction is verified again while the following ones arrive
+   std::vector<uint32_t> order;
+   for( uint32_t i = 0; i < transactions; ++i )
+      for( uint32_t j = 0; j < verifications_per_transaction; ++j )
+         order.push_back( i + j * 100 < transactions ? i + j * 100 : i );
+
+   auto run = [&]( const std::string& name ) {
+      const fc::time_point start = fc::time_point::now();
+      for( uint32_t i : order )
+         const fc::ecc::public_key key( signatures[i], digests[i] );
+      const fc::time_point end = fc::time_point::now();
+      ilog( "${c} recoveries ${n} in ${t}µs", ("c",order.size())("n",name)("t",end-start) );
+   };
+
+   run( "without cache" );
+   auto cache = std::make_shared<fc::ecc::recovery_cache>( 1000 );
+   fc::ecc::recovery_cache::install( cache );
+   run( "with cache" );
+   fc::ecc::recovery_cache::install( nullptr );
+
+   const auto stats = cache->get_stats();
+   ilog( "hits: ${h}, misses: ${m}, evictions: ${e}", ("h",stats.hits)("m",stats.misses)("e",stats.evictions) );
+   BOOST_CHECK_EQUAL( order.size(), stats.hits + stats.misses );
+   BOOST_CHECK( stats.hits > stats.misses );
+
+   // hits must return the same keys as the recovery
+   fc::ecc::recovery_cache::install( cache );
+   uint32_t wrong = 0;
+   for( uint32_t i : order )
+      if( fc::ecc::public_key( signatures[i], digests[i] ) != priv.get_public_key() )
+         ++wrong;
+   fc::ecc::recovery_cache::install( nullptr );
+   BOOST_CHECK_EQUAL( 0u, wrong );
+   BOOST_CHECK( cache->get_stats().hits > stats.hits );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
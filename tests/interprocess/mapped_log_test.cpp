@@ -0,0 +1,258 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/interprocess/mapped_log.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <fstream>
+
+namespace fc { namespace test {
+
+   struct log_record
+   {
+      uint64_t               id = 0;
+      fc::sha256             digest;
+      std::string            memo;
+      std::vector<uint32_t>  amounts;
+   };
+
+   inline bool operator == ( const log_record& a, const log_record& b )
+   { return std::tie( a.id, a.digest, a.memo, a.amounts ) == std::tie( b.id, b.digest, b.memo, b.amounts ); }
+
+   log_record make_record( uint64_t i )
+   {
+      log_record r;
+      r.id = i;
+      r.digest = fc::sha256::hash( i );
+      r.memo = std::string( i % 50, 'a' + i % 26 );
+      r.amounts.assign( i % 7, uint32_t(i) );
+      return r;
+   }
+
+   // flips the first payload byte of record i, which must be in the first segment
+   void corrupt_record( const fc::path& dir, const fc::mapped_log_base& log, uint64_t i, uint32_t segment_size )
+   {
+      const auto r = log.view( i );
+      const char* base = log.view( 0 ).data - fc::mapped_log_base::header_size;
+      BOOST_REQUIRE( r.size > 0 );
+      const uint64_t offset = r.data - base;
+      BOOST_REQUIRE( offset < segment_size );
+      std::fstream f( ( dir / "00000000.seg" ).string(), std::ios::in | std::ios::out | std::ios::binary );
+      f.seekp( offset );
+      f.put( ~r.data[0] );
+   }
+
+} } // fc::test
+
+FC_REFLECT( fc::test::log_record, (id)(digest)(memo)(amounts) )
+
+BOOST_AUTO_TEST_SUITE(mapped_log_tests)
+
+BOOST_AUTO_TEST_CASE( append_and_reopen )
+{ try {
+   fc::temp_directory dir;
+   const uint32_t segment_size = 4096;
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      BOOST_CHECK( log.empty() );
+      BOOST_CHECK( !log.recovered() );
+      for( uint64_t i = 0; i < 500; ++i )
+         BOOST_CHECK_EQUAL( i, log.append( fc::test::make_record( i ) ) );
+      BOOST_CHECK_EQUAL( 500u, log.size() );
+      log.flush();
+   }
+   // 500 records of ~60 bytes need several 4k segments
+   BOOST_CHECK( fc::exists( dir.path() / "00000005.seg" ) );
+
+   fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+   BOOST_CHECK( !log.recovered() );
+   BOOST_REQUIRE_EQUAL( 500u, log.size() );
+   BOOST_CHECK( fc::test::make_record( 321 ) == log.at( 321 ) );
+   BOOST_CHECK( fc::test::make_record( 0 ) == log.at( 0 ) );
+   BOOST_CHECK( fc::test::make_record( 499 ) == log.at( 499 ) );
+   BOOST_CHECK_THROW( log.at( 500 ), fc::assert_exception );
+
+   uint64_t count = 0;
+   log.visit( [&count]( uint64_t index, const fc::test::log_record& r ) {
+      BOOST_CHECK_EQUAL( index, count++ );
+      BOOST_CHECK( fc::test::make_record( index ) == r );
+   });
+   BOOST_CHECK_EQUAL( 500u, count );
+
+   count = 0;
+   for( const auto& r : log )
+      BOOST_CHECK( fc::raw::pack( fc::test::make_record( count++ ) )
+                   == std::vector<char>( r.data, r.data + r.size ) );
+
+   BOOST_CHECK_EQUAL( 500u, log.append( fc::test::make_record( 500 ) ) );
+   BOOST_CHECK( fc::test::make_record( 500 ) == log.at( 500 ) );
+
+   // untyped records, including an empty one
+   BOOST_CHECK_EQUAL( 501u, log.append( "", 0 ) );
+   BOOST_CHECK_EQUAL( 0u, log.view( 501 ).size );
+   BOOST_CHECK_THROW( log.append( std::string( segment_size, 'x' ).data(), segment_size ), fc::assert_exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( crash_recovery )
+{ try {
+   fc::temp_directory dir;
+   const uint32_t segment_size = 64 * 1024;
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      for( uint64_t i = 0; i < 100; ++i )
+         log.append( fc::test::make_record( i ) );
+      // a record that was never committed is wiped, without losing the committed ones
+      memset( log.prepare( 100 ), 'x', 100 );
+   }
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      BOOST_CHECK( log.recovered() );
+      BOOST_REQUIRE_EQUAL( 100u, log.size() );
+      fc::test::corrupt_record( dir.path(), log, 60, segment_size );
+   }
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      BOOST_CHECK( log.recovered() );
+      BOOST_REQUIRE_EQUAL( 60u, log.size() );
+      BOOST_CHECK( fc::test::make_record( 59 ) == log.at( 59 ) );
+      BOOST_CHECK_EQUAL( 60u, log.append( fc::test::make_record( 1000 ) ) );
+      // an abandoned record is wiped when the next one is prepared
+      memset( log.prepare( 100 ), 'x', 100 );
+      log.append( fc::test::make_record( 1001 ) );
+   }
+   fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+   BOOST_CHECK( !log.recovered() );
+   BOOST_REQUIRE_EQUAL( 62u, log.size() );
+   BOOST_CHECK( fc::test::make_record( 1000 ) == log.at( 60 ) );
+   BOOST_CHECK( fc::test::make_record( 1001 ) == log.at( 61 ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( read_only_open )
+{ try {
+   fc::temp_directory dir;
+   const uint32_t segment_size = 4096;
+   BOOST_CHECK_THROW( fc::mapped_log_base( dir.path() / "missing", segment_size, fc::read_only ), fc::assert_exception );
+   BOOST_CHECK( !fc::exists( dir.path() / "missing" ) );
+
+   fc::mapped_log<fc::test::log_record> writer( dir.path(), segment_size );
+   for( uint64_t i = 0; i < 100; ++i )
+      writer.append( fc::test::make_record( i ) );
+   // prepared, but not yet committed by the writer
+   fc::datastream<char*> ds( writer.prepare( fc::raw::pack_size( fc::test::make_record( 100 ) ) ),
+                             fc::raw::pack_size( fc::test::make_record( 100 ) ) );
+   fc::raw::pack( ds, fc::test::make_record( 100 ) );
+   {
+      fc::mapped_log<fc::test::log_record> reader( dir.path(), segment_size, fc::read_only );
+      BOOST_CHECK( reader.recovered() );
+      BOOST_REQUIRE_EQUAL( 100u, reader.size() );
+      BOOST_CHECK( fc::test::make_record( 99 ) == reader.at( 99 ) );
+      BOOST_CHECK_THROW( reader.append( fc::test::make_record( 0 ) ), fc::assert_exception );
+   }
+   // the reader left the record of the writer alone
+   BOOST_CHECK_EQUAL( 100u, writer.commit() );
+   fc::mapped_log<fc::test::log_record> reader( dir.path(), segment_size, fc::read_only );
+   BOOST_CHECK( !reader.recovered() );
+   BOOST_REQUIRE_EQUAL( 101u, reader.size() );
+   BOOST_CHECK( fc::test::make_record( 100 ) == reader.at( 100 ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( empty_last_segment )
+{ try {
+   fc::temp_directory dir;
+   const uint32_t segment_size = 4096;
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      for( uint64_t i = 0; i < 10; ++i )
+         log.append( fc::test::make_record( i ) );
+   }
+   // a crash while a segment was created
+   { fc::ofstream touch( dir.path() / "00000001.seg" ); }
+
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      BOOST_CHECK( log.recovered() );
+      BOOST_CHECK_EQUAL( 10u, log.size() );
+      BOOST_CHECK( !fc::exists( dir.path() / "00000001.seg" ) );
+      for( uint64_t i = 10; i < 100; ++i )
+         log.append( fc::test::make_record( i ) );
+   }
+   fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+   BOOST_CHECK( !log.recovered() );
+   BOOST_REQUIRE_EQUAL( 100u, log.size() );
+   BOOST_CHECK( fc::test::make_record( 99 ) == log.at( 99 ) );
+   BOOST_CHECK( fc::exists( dir.path() / "00000001.seg" ) );
+   BOOST_CHECK( !fc::exists( dir.path() / "00000001.seg.tmp" ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( damaged_segment_drops_later_segments )
+{ try {
+   fc::temp_directory dir;
+   const uint32_t segment_size = 4096;
+   // records never span segments, so the first one holds as many as fit completely
+   uint64_t first_segment_records = 0;
+   for( uint64_t used = 0; ; ++first_segment_records )
+   {
+      used += fc::mapped_log_base::header_size + fc::raw::pack_size( fc::test::make_record( first_segment_records ) );
+      if( used > segment_size )
+         break;
+   }
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+      for( uint64_t i = 0; i < 300; ++i )
+         log.append( fc::test::make_record( i ) );
+      fc::test::corrupt_record( dir.path(), log, first_segment_records / 2, segment_size );
+   }
+   BOOST_REQUIRE( first_segment_records > 10 );
+   BOOST_REQUIRE( fc::exists( dir.path() / "00000002.seg" ) );
+
+   fc::mapped_log<fc::test::log_record> log( dir.path(), segment_size );
+   BOOST_CHECK( log.recovered() );
+   BOOST_CHECK_EQUAL( first_segment_records / 2, log.size() );
+   BOOST_CHECK( !fc::exists( dir.path() / "00000001.seg" ) );
+   BOOST_CHECK( !fc::exists( dir.path() / "00000002.seg" ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( append_performance )
+{ try {
+   fc::temp_directory dir;
+   const uint64_t count = 200000;
+
+   fc::time_point start = fc::time_point::now();
+   {
+      fc::ofstream out( dir.path() / "records.bin" );
+      for( uint64_t i = 0; i < count; ++i )
+      {
+         const auto packed = fc::raw::pack( fc::test::make_record( i ) );
+         fc::raw::pack( out, fc::unsigned_int( packed.size() ) );
+         out.write( packed.data(), packed.size() );
+      }
+      out.flush();
+   }
+   fc::time_point end = fc::time_point::now();
+   ilog( "${c} records written to ofstream in ${t}µs", ("c",count)("t",end-start) );
+
+   start = fc::time_point::now();
+   {
+      fc::mapped_log<fc::test::log_record> log( dir.path() / "log" );
+      for( uint64_t i = 0; i < count; ++i )
+         log.append( fc::test::make_record( i ) );
+      log.flush();
+   }
+   end = fc::time_point::now();
+   ilog( "${c} records appended to mapped_log in ${t}µs", ("c",count)("t",end-start) );
+
+   start = fc::time_point::now();
+   fc::mapped_log<fc::test::log_record> log( dir.path() / "log" );
+   uint64_t total = 0;
+   for( const auto& r : log )
+      total += r.size;
+   end = fc::time_point::now();
+   ilog( "${c} records (${b} bytes) reopened and scanned in ${t}µs", ("c",log.size())("b",total)("t",end-start) );
+   BOOST_CHECK_EQUAL( count, log.size() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
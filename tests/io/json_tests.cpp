@@ -332,6 +332,57 @@ BOOST_AUTO_TEST_CASE(recursion_test)
    BOOST_CHECK_THROW( fc::json::to_string( nested, fc::json::stringify_large_ints_and_doubles, 9 ), fc::assert_exception );
 }
 
+static void count_strings( const fc::variant& v, size_t& strings, size_t& short_strings )
+{
+   if( v.is_string() )
+   {
+      ++strings;
+      if( v.get_string_view().size() <= sizeof(fc::variant) - 2 )
+         ++short_strings;
+   }
+   else if( v.is_array() )
+      for( const auto& item : v.get_array() )
+         count_strings( item, strings, short_strings );
+   else if( v.is_object() )
+      for( const auto& item : v.get_object() )
+         count_strings( item.value(), strings, short_strings );
+}
+
+BOOST_AUTO_TEST_CASE(short_string_benchmark)
+{
+   // an RPC reply with the strings typical for it: object ids, amounts, asset symbols and keys
+   fc::variants ops;
+   for( int i = 0; i < 20000; ++i )
+      ops.push_back( fc::mutable_variant_object( "id", "1.11." + std::to_string( 1000000 + i ) )
+                        ( "from", "1.2." + std::to_string( i % 5000 ) )
+                        ( "to", "1.2." + std::to_string( i % 777 ) )
+                        ( "amount", fc::mutable_variant_object( "amount", std::to_string( i * 1000 ) )
+                                                              ( "asset_id", "1.3.0" ) )
+                        ( "symbol", i % 2 ? "BTS" : "USD" )
+                        ( "memo", "BTS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV" ) );
+   const std::string json = fc::json::to_string( fc::variant( ops ) );
+
+   fc::time_point start = fc::time_point::now();
+   fc::variant parsed = fc::json::from_string( json );
+   const fc::microseconds parse_time = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   const std::string back = fc::json::to_string( parsed );
+   const fc::microseconds print_time = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( back, json );
+
+   size_t strings = 0, short_strings = 0;
+   count_strings( parsed, strings, short_strings );
+
+   start = fc::time_point::now();
+   parsed.clear();
+   const fc::microseconds destroy_time = fc::time_point::now() - start;
+
+   ilog( "${s} of ${n} strings stored in the variant: parse ${p} us, to_string ${t} us, destroy ${d} us",
+         ("s",short_strings)("n",strings)("p",parse_time.count())("t",print_time.count())
+         ("d",destroy_time.count()) );
+}
+
 BOOST_AUTO_TEST_CASE(rethrow_test)
 {
    fc::variants biggie;
@@ -0,0 +1,126 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/io/varint.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+namespace fc { namespace test {
+
+   /** Behaves like datastream<const char*> but is not one, so raw::unpack takes the byte-wise path */
+   class bytewise_stream : public fc::datastream<const char*>
+   {
+      public:
+         using fc::datastream<const char*>::datastream;
+   };
+
+   /** Pre-kernel encoder, writes one byte at a time */
+   template<typename Stream>
+   void pack_bytewise( Stream& s, uint64_t val )
+   {
+      do {
+         uint8_t b = uint8_t(val) & 0x7f;
+         val >>= 7;
+         b |= ((val > 0) << 7);
+         s.write( (char*)&b, 1 );
+      } while( val );
+   }
+
+   const size_t VALUE_COUNT = 1000000;
+
+   std::vector<fc::unsigned_int> make_values( unsigned max_bits )
+   {
+      std::vector<fc::unsigned_int> values;
+      values.reserve( VALUE_COUNT );
+      uint64_t x = 0x9e3779b97f4a7c15ULL;
+      for( size_t i = 0; i < VALUE_COUNT; ++i )
+      {
+         x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+         values.push_back( x >> ( 64 - 1 - ( x % max_bits ) ) );
+      }
+      return values;
+   }
+
+   void run_benchmark( const std::string& name, unsigned max_bits )
+   {
+      const auto values = make_values( max_bits );
+      std::vector<char> buf( values.size() * fc::detail::max_packed_unsigned_int_size );
+
+      time_point start = time_point::now();
+      fc::datastream<char*> slow_out( buf.data(), buf.size() );
+      for( const auto& v : values )
+         pack_bytewise( slow_out, v.value );
+      time_point end = time_point::now();
+      ilog( "${n}: packed ${c} varints byte-wise in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+
+      start = time_point::now();
+      fc::datastream<char*> fast_out( buf.data(), buf.size() );
+      for( const auto& v : values )
+         fc::raw::pack( fast_out, v );
+      end = time_point::now();
+      ilog( "${n}: packed ${c} varints word-wise in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+      BOOST_CHECK_EQUAL( slow_out.tellp(), fast_out.tellp() );
+
+      fc::unsigned_int result;
+      uint64_t sum = 0;
+      start = time_point::now();
+      bytewise_stream slow_in( buf.data(), fast_out.tellp() );
+      for( size_t i = 0; i < values.size(); ++i )
+      {
+         fc::raw::unpack( slow_in, result );
+         sum += result.value;
+      }
+      end = time_point::now();
+      ilog( "${n}: unpacked ${c} varints byte-wise in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+
+      uint64_t fast_sum = 0;
+      start = time_point::now();
+      fc::datastream<const char*> fast_in( buf.data(), fast_out.tellp() );
+      for( size_t i = 0; i < values.size(); ++i )
+      {
+         fc::raw::unpack( fast_in, result );
+         fast_sum += result.value;
+      }
+      end = time_point::now();
+      ilog( "${n}: unpacked ${c} varints word-wise in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+      BOOST_CHECK_EQUAL( sum, fast_sum );
+
+      const std::vector<char> packed = fc::raw::pack( values );
+      std::vector<fc::unsigned_int> unpacked;
+      start = time_point::now();
+      bytewise_stream slow_vector_in( packed.data(), packed.size() );
+      fc::raw::unpack( slow_vector_in, unpacked );
+      end = time_point::now();
+      ilog( "${n}: unpacked vector of ${c} varints byte-wise in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+      BOOST_CHECK( values == unpacked );
+
+      unpacked.clear();
+      unpacked.shrink_to_fit();
+      start = time_point::now();
+      fc::datastream<const char*> batch_in( packed.data(), packed.size() );
+      fc::raw::unpack( batch_in, unpacked );
+      end = time_point::now();
+      ilog( "${n}: unpacked vector of ${c} varints batched in ${t}µs", ("n",name)("c",values.size())("t",end-start) );
+      BOOST_CHECK( values == unpacked );
+   }
+
+} } // fc::test
+
+BOOST_AUTO_TEST_SUITE(varint_benchmark)
+
+BOOST_AUTO_TEST_CASE( small_values )
+{
+   fc::test::run_benchmark( "7-bit", 7 );
+}
+
+BOOST_AUTO_TEST_CASE( medium_values )
+{
+   fc::test::run_benchmark( "32-bit", 32 );
+}
+
+BOOST_AUTO_TEST_CASE( large_values )
+{
+   fc::test::run_benchmark( "64-bit", 64 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -95,4 +95,70 @@ BOOST_AUTO_TEST_CASE( test_limits )
    BOOST_CHECK_THROW( fc::raw::unpack( std::vector<char>( overlong.begin(), overlong.end() ), dest, 3 ), fc::overflow_exception );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( test_word_kernels )
+{ try {
+   // every length from 1 to 10 bytes, both just below and at the length boundary
+   std::vector<uint64_t> values = { 0, 1, 0x7f, 0xffffffffffffffffULL };
+   for( unsigned bits = 7; bits < 64; bits += 7 )
+   {
+      values.push_back( (uint64_t(1) << bits) - 1 );
+      values.push_back( uint64_t(1) << bits );
+      values.push_back( (uint64_t(1) << bits) | 0x55 );
+   }
+
+   for( const uint64_t value : values )
+   {
+      // reference encoding, one byte at a time
+      std::string expected;
+      uint64_t val = value;
+      do {
+         uint8_t b = uint8_t(val) & 0x7f;
+         val >>= 7;
+         b |= ((val > 0) << 7);
+         expected.push_back( char(b) );
+      } while( val );
+
+      char buf[fc::detail::max_packed_unsigned_int_size + 8] = {};
+      const size_t len = fc::detail::encode_unsigned_int( value, buf );
+      BOOST_CHECK_EQUAL( expected, std::string( buf, len ) );
+
+      uint64_t decoded = 0;
+      const size_t used = fc::detail::decode_unsigned_int( buf, decoded );
+      if( len <= 8 )
+      {
+         BOOST_CHECK_EQUAL( len, used );
+         BOOST_CHECK_EQUAL( value, decoded );
+      }
+      else
+         BOOST_CHECK_EQUAL( 0u, used );
+
+      // the checked and the fast datastream paths must agree, whatever is left in the buffer
+      for( size_t padding = 0; padding <= 8; ++padding )
+      {
+         std::vector<char> packed( expected.begin(), expected.end() );
+         packed.resize( packed.size() + padding, '\377' );
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         fc::unsigned_int result;
+         fc::raw::unpack( ds, result );
+         BOOST_CHECK_EQUAL( value, result.value );
+         BOOST_CHECK_EQUAL( padding, ds.remaining() );
+      }
+   }
+
+   // batch decoding of arrays, mixing runs of small values with long ones
+   std::vector<fc::unsigned_int> mixed;
+   for( uint64_t i = 0; i < 1000; ++i )
+      mixed.push_back( i % 37 == 0 ? values[i % values.size()] : i % 100 );
+   std::vector<fc::unsigned_int> unpacked;
+   fc::raw::unpack<std::vector<fc::unsigned_int>>( fc::raw::pack( mixed ), unpacked, 3 );
+   BOOST_REQUIRE_EQUAL( mixed.size(), unpacked.size() );
+   for( size_t i = 0; i < mixed.size(); ++i )
+      BOOST_CHECK_EQUAL( mixed[i].value, unpacked[i].value );
+
+   static const std::string overflow = "\003\001\002\200\200\200\200\200\200\200\200\200\2";
+   BOOST_CHECK_THROW( fc::raw::unpack<std::vector<fc::unsigned_int>>( std::vector<char>( overflow.begin(), overflow.end() ),
+                                                                       unpacked, 3 ),
+                      fc::overflow_exception );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,17 +5,63 @@
 #include <fc/thread/thread.hpp>
 #include <fc/reflect/reflect.hpp>
 #include <fc/reflect/variant.hpp>
+#include <fc/log/binary_appender.hpp>
 #include <fc/log/file_appender.hpp>
+#include <fc/log/gelf_appender.hpp>
+#include <fc/log/log_dispatcher.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/variant.hpp>
 #include <fc/time.hpp>
 #include <fc/io/json.hpp>
 #include <fc/io/fstream.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/udp_socket.hpp>
 
 #include <thread>
 #include <iostream>
+#include <map>
 #include <fstream>
+#include <mutex>
+
+extern "C" char* tinfl_decompress_mem_to_heap( const void* pSrc_buf, size_t src_buf_len, size_t* pOut_len, int flags );
+
+namespace {
+   /** reads the context of each message like the console appender, without any output */
+   class counting_appender : public fc::appender
+   {
+      public:
+         virtual void log( const fc::log_message& m ) override
+         {
+            const fc::log_context context = m.get_context();
+            length += context.get_file().size() + context.get_method().size() + context.get_thread_name().size();
+            ++count;
+         }
+
+         size_t count  = 0;
+         size_t length = 0;
+   };
+
+   /** renders the messages behind a lock, like an appender writing to a shared stream */
+   class recording_appender : public fc::appender
+   {
+      public:
+         virtual void log( const fc::log_message& m ) override
+         {
+            const std::string text = m.get_message();
+            std::lock_guard<std::mutex> guard( lock );
+            length += text.size();
+            if( record )
+               messages.push_back( m );
+         }
+
+         std::mutex                    lock;
+         bool                          record = true;
+         size_t                        length = 0;
+         std::vector<fc::log_message>  messages;
+   };
+}
 
 BOOST_AUTO_TEST_SUITE(logging_tests)
 
@@ -79,4 +125,446 @@ BOOST_AUTO_TEST_CASE(log_reboot)
     BOOST_TEST_MESSAGE("Loop complete");
 }
 
+BOOST_AUTO_TEST_CASE(format_string_test)
+{
+    const fc::variant_object args = fc::mutable_variant_object( "a", "x" )( "n", 42 )( "list", fc::variants( 2, fc::variant( 1 ) ) )
+                                                              ( "empty", fc::variant() );
+    BOOST_CHECK_EQUAL( fc::format_string( "", args ), "" );
+    BOOST_CHECK_EQUAL( fc::format_string( "plain", args ), "plain" );
+    BOOST_CHECK_EQUAL( fc::format_string( "${a}", args ), "x" );
+    BOOST_CHECK_EQUAL( fc::format_string( "a=${a} n=${n}.", args ), "a=x n=42." );
+    BOOST_CHECK_EQUAL( fc::format_string( "${list}${empty}|", args ), "[1,1]|" );
+    BOOST_CHECK_EQUAL( fc::format_string( "${missing} ${a}", args ), "${missing} x" );
+    BOOST_CHECK_EQUAL( fc::format_string( "$a $$ $", args ), "$a $$ $" );
+    BOOST_CHECK_EQUAL( fc::format_string( "cost $5 ${a", args ), "cost $5 {a" );
+    BOOST_CHECK_EQUAL( fc::format_string( "${}", args ), "${}" );
+
+    std::string out = "> ";
+    fc::format_string( "${a}${n}", args, out );
+    fc::format_string( " ${a}", args, out );
+    BOOST_CHECK_EQUAL( out, "> x42 x" );
+
+    // formats built at runtime are rendered correctly after the cache is full
+    for( int i = 0; i < 2000; ++i )
+        BOOST_CHECK_EQUAL( fc::format_string( std::to_string( i ) + " ${n}", args ), std::to_string( i ) + " 42" );
+}
+
+BOOST_AUTO_TEST_CASE(format_string_benchmark)
+{
+    const int rounds = 200000;
+    std::vector<fc::log_message> messages;
+    fc::time_point start = fc::time_point::now();
+    for( int i = 0; i < rounds; ++i )
+        messages.push_back( FC_LOG_MESSAGE( info, "Account ${a} transferred ${amount} ${symbol} to ${b}, fee ${fee}",
+                                            ("a","1.2.345")("amount",i)("symbol","BTS")("b","1.2.678")("fee",20) ) );
+    const fc::microseconds create_time = fc::time_point::now() - start;
+
+    size_t length = 0;
+    start = fc::time_point::now();
+    for( const auto& m : messages )
+        length += m.get_message().size();
+    const fc::microseconds render_time = fc::time_point::now() - start;
+    BOOST_CHECK( length > 0 );
+    ilog( "FC_LOG_MESSAGE: create ${c} ns, get_message() ${r} ns",
+          ("c",create_time.count() * 1000 / rounds)("r",render_time.count() * 1000 / rounds) );
+}
+
+BOOST_AUTO_TEST_CASE(log_context_copies_strings)
+{
+    std::string file = "dir/temporary.cpp";
+    std::string method = "temporary_method";
+    const fc::log_context ctx( fc::log_level::info, file.c_str(), 7, method.c_str() );
+    file.assign( file.size(), 'x' );
+    method.assign( method.size(), 'x' );
+    BOOST_CHECK_EQUAL( "temporary.cpp", ctx.get_file() );
+    BOOST_CHECK_EQUAL( "temporary_method", ctx.get_method() );
+    BOOST_CHECK_EQUAL( std::string( "temporary.cpp" ), ctx.get_file_c_str() );
+
+    const fc::log_context copy = ctx;
+    BOOST_CHECK_EQUAL( "temporary_method", copy.get_method_c_str() );
+    BOOST_CHECK_EQUAL( "logging_tests.cpp", FC_LOG_CONTEXT( info ).get_file() );
+}
+
+BOOST_AUTO_TEST_CASE(log_context_benchmark)
+{
+    const int rounds = 500000;
+    uint64_t lines = 0;
+    fc::time_point start = fc::time_point::now();
+    for( int i = 0; i < rounds; ++i )
+        lines += FC_LOG_CONTEXT( info ).get_line_number();
+    const fc::microseconds context_time = fc::time_point::now() - start;
+    BOOST_CHECK( lines > 0 );
+
+    fc::log_context::set_coarse_timestamps( true );
+    start = fc::time_point::now();
+    for( int i = 0; i < rounds; ++i )
+        lines += FC_LOG_CONTEXT( info ).get_line_number();
+    const fc::microseconds coarse_time = fc::time_point::now() - start;
+    const fc::time_point coarse_stamp = FC_LOG_CONTEXT( info ).get_timestamp();
+    fc::log_context::set_coarse_timestamps( false );
+    BOOST_CHECK( coarse_stamp <= fc::time_point::now() );
+    BOOST_CHECK( coarse_stamp > fc::time_point::now() - fc::seconds( 1 ) );
+
+    fc::logger log( "log_context_benchmark" );
+    log.set_log_level( fc::log_level::debug );
+    auto counter = std::make_shared<counting_appender>();
+    log.add_appender( counter );
+    start = fc::time_point::now();
+    for( int i = 0; i < rounds; ++i )
+        fc_ilog( log, "block ${n}", ("n",i) );
+    const fc::microseconds log_time = fc::time_point::now() - start;
+    BOOST_CHECK_EQUAL( counter->count, size_t( rounds ) );
+    BOOST_CHECK( counter->length > 0 );
+
+    ilog( "FC_LOG_CONTEXT ${c} ns, with coarse timestamps ${k} ns, fc_ilog to an appender reading the context ${l} ns",
+          ("c",context_time.count() * 1000 / rounds)("k",coarse_time.count() * 1000 / rounds)
+          ("l",log_time.count() * 1000 / rounds) );
+}
+
+BOOST_AUTO_TEST_CASE(log_dispatcher_test)
+{
+    fc::logger log( "log_dispatcher_test" );
+    log.set_log_level( fc::log_level::debug );
+    auto recorder = std::make_shared<recording_appender>();
+    log.add_appender( recorder );
+
+    // a small buffer, so that the threads have to wait for the dispatcher
+    fc::log_dispatcher::start( 16 );
+    BOOST_CHECK( fc::log_dispatcher::is_running() );
+    const int threads = 4;
+    const int rounds = 1000;
+    std::vector<std::thread> workers;
+    for( int t = 0; t < threads; ++t )
+        workers.emplace_back( [&log, t]() {
+            for( int i = 0; i < rounds; ++i )
+                fc_ilog( log, "thread ${t} message ${i}", ("t",t)("i",i) );
+        } );
+    for( auto& w : workers )
+        w.join();
+    fc::log_dispatcher::flush();
+    {
+        std::lock_guard<std::mutex> guard( recorder->lock );
+        BOOST_REQUIRE_EQUAL( recorder->messages.size(), size_t( threads * rounds ) );
+        std::vector<int64_t> next( threads, 0 );
+        for( const auto& m : recorder->messages )
+        {
+            const int64_t t = m.get_data()["t"].as_int64();
+            BOOST_CHECK_EQUAL( m.get_data()["i"].as_int64(), next[t]++ );
+            BOOST_CHECK_EQUAL( m.get_context().get_context(), "log_dispatcher_test" );
+        }
+    }
+
+    // errors have been passed on when fc_elog returns
+    fc_ilog( log, "before" );
+    fc_elog( log, "failure" );
+    {
+        std::lock_guard<std::mutex> guard( recorder->lock );
+        BOOST_REQUIRE_EQUAL( recorder->messages.size(), size_t( threads * rounds + 2 ) );
+        BOOST_CHECK_EQUAL( recorder->messages.back().get_format(), "failure" );
+    }
+
+    fc_ilog( log, "queued" );
+    fc::log_dispatcher::stop();
+    BOOST_CHECK( !fc::log_dispatcher::is_running() );
+    BOOST_CHECK_EQUAL( recorder->messages.back().get_format(), "queued" );
+    fc_ilog( log, "synchronous" );
+    BOOST_CHECK_EQUAL( recorder->messages.back().get_format(), "synchronous" );
+}
+
+BOOST_AUTO_TEST_CASE(log_dispatcher_benchmark)
+{
+    const int threads = 32;
+    const int rounds = 2000;
+    for( bool dispatched : { false, true } )
+    {
+        fc::logger log( "log_dispatcher_benchmark" );
+        log.set_log_level( fc::log_level::debug );
+        auto recorder = std::make_shared<recording_appender>();
+        recorder->record = false;
+        log.add_appender( recorder );
+        if( dispatched )
+            fc::log_dispatcher::start();
+
+        const fc::time_point start = fc::time_point::now();
+        std::vector<std::thread> workers;
+        for( int t = 0; t < threads; ++t )
+            workers.emplace_back( [&log, t]() {
+                for( int i = 0; i < rounds; ++i )
+                    fc_ilog( log, "thread ${t} applied block ${i} with ${n} transactions", ("t",t)("i",i)("n",i % 100) );
+            } );
+        for( auto& w : workers )
+            w.join();
+        const fc::microseconds logged = fc::time_point::now() - start;
+        fc::log_dispatcher::stop();
+        const fc::microseconds written = fc::time_point::now() - start;
+        BOOST_CHECK( recorder->length > 0 );
+
+        ilog( "${m} with ${t} threads: ${l} ns per message until logged, ${w} ns until written",
+              ("m",dispatched ? "log_dispatcher" : "synchronous")("t",threads)
+              ("l",logged.count() * 1000 / ( threads * rounds ))("w",written.count() * 1000 / ( threads * rounds )) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(binary_appender_test)
+{
+    fc::temp_directory log_dir;
+    fc::binary_appender::config conf( log_dir.path() / "binary" );
+    // small segments, so that the records span several of them
+    conf.segment_size = 4096;
+    const int rounds = 500;
+    {
+        fc::logger log( "binary_appender_test" );
+        log.set_log_level( fc::log_level::debug );
+        log.add_appender( std::make_shared<fc::binary_appender>( conf ) );
+        for( int i = 0; i < rounds; ++i )
+        {
+            fc_ilog( log, "block ${n} produced by ${p}", ("n",i)("p","producer" + std::to_string( i % 3 )) );
+            if( i % 100 == 0 )
+                fc_wlog( log, "late by ${d} ms, ${ok}", ("d",i * 0.5)("ok",i % 200 == 0)("list",fc::variants{ i, "x" }) );
+        }
+        fc_elog( log, "no arguments" );
+    }
+
+    std::vector<fc::log_message> messages;
+    fc::binary_log::read( conf.directory, [&messages]( const fc::log_message& m ) { messages.push_back( m ); } );
+    BOOST_REQUIRE_EQUAL( messages.size(), size_t( rounds + rounds / 100 + 1 ) );
+
+    size_t index = 0;
+    for( int i = 0; i < rounds; ++i )
+    {
+        const fc::log_message& m = messages[index++];
+        const fc::log_context context = m.get_context();
+        BOOST_CHECK_EQUAL( m.get_message(), "block " + std::to_string( i ) + " produced by producer" + std::to_string( i % 3 ) );
+        BOOST_CHECK_EQUAL( m.get_format(), "block ${n} produced by ${p}" );
+        BOOST_CHECK( context.get_log_level() == fc::log_level::info );
+        BOOST_CHECK_EQUAL( context.get_context(), "binary_appender_test" );
+        BOOST_CHECK_EQUAL( context.get_file(), "logging_tests.cpp" );
+        BOOST_CHECK( context.get_line_number() > 0 );
+        BOOST_CHECK( !context.get_thread_name().empty() );
+        if( i % 100 == 0 )
+        {
+            const fc::log_message& w = messages[index++];
+            BOOST_CHECK( w.get_context().get_log_level() == fc::log_level::warn );
+            BOOST_CHECK_EQUAL( w.get_data()["d"].as_double(), i * 0.5 );
+            BOOST_CHECK_EQUAL( w.get_data()["ok"].as_bool(), i % 200 == 0 );
+            BOOST_REQUIRE_EQUAL( w.get_data()["list"].get_array().size(), 2u );
+            BOOST_CHECK_EQUAL( w.get_data()["list"].get_array()[0].as_int64(), i );
+            BOOST_CHECK( context.get_timestamp() <= w.get_context().get_timestamp() );
+        }
+    }
+    BOOST_CHECK_EQUAL( messages.back().get_message(), "no arguments" );
+    BOOST_CHECK( messages.back().get_context().get_log_level() == fc::log_level::error );
+
+    // a reopened log defines its ids again
+    {
+        fc::logger log( "binary_appender_test" );
+        log.set_log_level( fc::log_level::debug );
+        log.add_appender( std::make_shared<fc::binary_appender>( conf ) );
+        fc_ilog( log, "reopened ${n}", ("n",1) );
+    }
+    messages.clear();
+    fc::binary_log::read( conf.directory, [&messages]( const fc::log_message& m ) { messages.push_back( m ); } );
+    BOOST_REQUIRE_EQUAL( messages.size(), size_t( rounds + rounds / 100 + 2 ) );
+    BOOST_CHECK_EQUAL( messages.back().get_message(), "reopened 1" );
+}
+
+BOOST_AUTO_TEST_CASE(binary_appender_live_read)
+{
+    fc::temp_directory log_dir;
+    fc::binary_appender::config conf( log_dir.path() / "binary" );
+    conf.segment_size = 4096;
+    auto read_count = [&conf]() {
+        size_t count = 0;
+        fc::binary_log::read( conf.directory, [&count]( const fc::log_message& ) { ++count; } );
+        return count;
+    };
+
+    fc::logger log( "binary_appender_live_read" );
+    log.set_log_level( fc::log_level::debug );
+    auto appender = std::make_shared<fc::binary_appender>( conf );
+    log.add_appender( appender );
+    for( int i = 0; i < 100; ++i )
+        fc_ilog( log, "message ${i}", ("i",i) );
+    // reading must not disturb the log which is still being written
+    BOOST_CHECK_EQUAL( read_count(), 100u );
+    for( int i = 100; i < 200; ++i )
+        fc_ilog( log, "message ${i} of ${n}", ("i",i)("n",200) );
+    BOOST_CHECK_EQUAL( read_count(), 200u );
+
+    log.remove_appender( appender );
+    appender.reset();
+    std::vector<fc::log_message> messages;
+    fc::binary_log::read( conf.directory, [&messages]( const fc::log_message& m ) { messages.push_back( m ); } );
+    BOOST_REQUIRE_EQUAL( messages.size(), 200u );
+    BOOST_CHECK_EQUAL( messages[99].get_message(), "message 99" );
+    BOOST_CHECK_EQUAL( messages[199].get_message(), "message 199 of 200" );
+}
+
+BOOST_AUTO_TEST_CASE(binary_appender_rotation)
+{
+    fc::temp_directory log_dir;
+    fc::binary_appender::config conf( log_dir.path() / "binary" );
+    conf.segment_size = 4096;
+    conf.rotate = true;
+    conf.rotation_interval = fc::seconds( 1 );
+    conf.rotation_limit = fc::seconds( 60 );
+
+    // a log of an interval past the rotation limit
+    const fc::path old_log = conf.directory / fc::time_point_sec( fc::time_point::now() - fc::seconds( 3600 ) ).to_non_delimited_iso_string();
+    fc::create_directories( old_log );
+
+    fc::logger log( "binary_appender_rotation" );
+    log.set_log_level( fc::log_level::debug );
+    auto appender = std::make_shared<fc::binary_appender>( conf );
+    log.add_appender( appender );
+    BOOST_CHECK( !fc::exists( old_log ) );
+
+    fc::time_point now = fc::time_point::now();
+    fc_ilog( log, "first ${n}", ("n",1) );
+    const fc::path first_log = conf.directory / fc::time_point_sec( uint32_t( now.sec_since_epoch() ) ).to_non_delimited_iso_string();
+    // the start of the next interval
+    fc::usleep( fc::seconds( now.sec_since_epoch() + 1 ) - now.time_since_epoch() + fc::milliseconds( 10 ) );
+    now = fc::time_point::now();
+    fc_ilog( log, "second ${n}", ("n",2) );
+    const fc::path second_log = conf.directory / fc::time_point_sec( uint32_t( now.sec_since_epoch() ) ).to_non_delimited_iso_string();
+    BOOST_CHECK( first_log != second_log );
+    BOOST_CHECK( fc::is_directory( first_log ) );
+    BOOST_CHECK( fc::is_directory( second_log ) );
+
+    // every log defines its own ids, the logs are read in order
+    log.remove_appender( appender );
+    appender.reset();
+    std::vector<fc::log_message> messages;
+    fc::binary_log::read( conf.directory, [&messages]( const fc::log_message& m ) { messages.push_back( m ); } );
+    BOOST_REQUIRE_EQUAL( messages.size(), 2u );
+    BOOST_CHECK_EQUAL( messages[0].get_message(), "first 1" );
+    BOOST_CHECK_EQUAL( messages[1].get_message(), "second 2" );
+}
+
+BOOST_AUTO_TEST_CASE(binary_appender_benchmark)
+{
+    const int rounds = 200000;
+    fc::temp_directory log_dir;
+    fc::file_appender::config file_conf;
+    file_conf.filename = log_dir.path() / "text.log";
+    file_conf.format = "${timestamp} ${thread_name} ${context} ${file}:${line} ${method} ${level}]  ${message}";
+    const std::vector<std::pair<std::string, fc::appender::ptr>> appenders = {
+        { "file_appender",   std::make_shared<fc::file_appender>( fc::variant( file_conf, 10 ) ) },
+        { "binary_appender", std::make_shared<fc::binary_appender>( fc::binary_appender::config( log_dir.path() / "binary" ) ) }
+    };
+    for( const auto& a : appenders )
+    {
+        fc::logger log( "binary_appender_benchmark" );
+        log.set_log_level( fc::log_level::debug );
+        log.add_appender( a.second );
+        const fc::time_point start = fc::time_point::now();
+        for( int i = 0; i < rounds; ++i )
+            fc_ilog( log, "applied block ${n} with ${t} transactions from ${p}", ("n",i)("t",i % 100)("p","producer") );
+        const fc::microseconds elapsed = fc::time_point::now() - start;
+        ilog( "${a}: ${ns} ns per message", ("a",a.first)("ns",elapsed.count() * 1000 / rounds) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(gelf_appender_test)
+{
+    fc::udp_socket sink;
+    sink.open();
+    sink.set_receive_buffer_size( 4 * 1024 * 1024 );
+    sink.bind( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+
+    fc::gelf_appender::config conf;
+    conf.endpoint = std::string( sink.local_endpoint() );
+    conf.batch = true;
+    conf.batch_size = 8;
+    const int rounds = 100;
+    fc::gelf_appender::statistics stats;
+    {
+        auto gelf = std::make_shared<fc::gelf_appender>( fc::variant( conf, 10 ) );
+        fc::logger log( "gelf_appender_test" );
+        log.set_log_level( fc::log_level::debug );
+        log.add_appender( gelf );
+        for( int i = 0; i < rounds; ++i )
+            fc_ilog( log, "message ${i}", ("i",i) );
+        // random text does not compress, so that the message has to be split into chunks
+        std::string large;
+        for( uint64_t i = 0; large.size() < 2000; ++i )
+            large += std::to_string( fc::city_hash64( (const char*)&i, sizeof(i) ) );
+        fc_wlog( log, "${large}", ("large",large) );
+        // the appender sends the queued messages before it is destroyed, with the logger
+    }
+
+    std::vector<char> buffer( 65536 );
+    fc::ip::endpoint from;
+    std::map<uint64_t, std::map<int, std::string>> chunked;
+    std::vector<std::string> messages;
+    while( messages.size() < size_t( rounds + 1 ) )
+    {
+        const size_t size = sink.receive_from( buffer.data(), buffer.size(), from );
+        std::string compressed;
+        if( (unsigned char)buffer[0] == 0x1e && (unsigned char)buffer[1] == 0x0f )
+        {
+            BOOST_REQUIRE( size > 12 );
+            uint64_t id;
+            memcpy( &id, buffer.data() + 2, sizeof(id) );
+            auto& chunks = chunked[id];
+            chunks[(unsigned char)buffer[10]] = std::string( buffer.data() + 12, size - 12 );
+            if( chunks.size() < (unsigned char)buffer[11] )
+                continue;
+            for( const auto& c : chunks )
+                compressed += c.second;
+        }
+        else
+            compressed.assign( buffer.data(), size );
+        BOOST_REQUIRE_EQUAL( (unsigned char)compressed[0], 0x78 );
+        BOOST_REQUIRE_EQUAL( (unsigned char)compressed[1], 0x9c );
+        size_t length = 0;
+        char* json = tinfl_decompress_mem_to_heap( compressed.data(), compressed.size(), &length, 1 /* TINFL_FLAG_PARSE_ZLIB_HEADER */ );
+        BOOST_REQUIRE( json );
+        messages.emplace_back( json, length );
+        free( json );
+    }
+    for( int i = 0; i < rounds; ++i )
+    {
+        const fc::variant_object m = fc::json::from_string( messages[i] ).get_object();
+        BOOST_CHECK_EQUAL( m["short_message"].as_string(), "message " + std::to_string( i ) );
+        BOOST_CHECK_EQUAL( m["level"].as_int64(), 6 );
+        BOOST_CHECK_EQUAL( m["context"].as_string(), "gelf_appender_test" );
+    }
+    BOOST_CHECK_EQUAL( fc::json::from_string( messages.back() )["level"].as_int64(), 4 );
+    BOOST_CHECK_EQUAL( chunked.size(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE(gelf_appender_statistics)
+{
+    fc::udp_socket sink;
+    sink.open();
+    sink.bind( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+    const int rounds = 20000;
+    for( bool batch : { false, true } )
+    {
+        fc::gelf_appender::config conf;
+        conf.endpoint = std::string( sink.local_endpoint() );
+        conf.batch = batch;
+        conf.queue_size = 256;
+        auto gelf = std::make_shared<fc::gelf_appender>( fc::variant( conf, 10 ) );
+        fc::logger log( "gelf_appender_statistics" );
+        log.set_log_level( fc::log_level::debug );
+        log.add_appender( gelf );
+
+        const fc::time_point start = fc::time_point::now();
+        for( int i = 0; i < rounds; ++i )
+            fc_ilog( log, "applied block ${n} with ${t} transactions", ("n",i)("t",i % 100) );
+        const fc::microseconds elapsed = fc::time_point::now() - start;
+        log.remove_appender( gelf );
+
+        const fc::gelf_appender::statistics queued = gelf->get_statistics();
+        BOOST_CHECK_EQUAL( queued.sent + queued.dropped + queued.backlog, uint64_t( rounds ) );
+        if( !batch )
+            BOOST_CHECK_EQUAL( queued.sent, uint64_t( rounds ) );
+        gelf.reset();
+        ilog( "gelf_appender ${m}: ${ns} ns per message, ${s}", ("m",batch ? "batched" : "synchronous")
+              ("ns",elapsed.count() * 1000 / rounds)("s",queued) );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,8 @@
 #include <fc/log/logger.hpp>
 
 #include <fc/container/flat.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/crypto/sha256.hpp>
 #include <fc/io/raw.hpp>
 
 namespace fc { namespace test {
@@ -40,8 +42,72 @@ namespace fc { namespace test {
 FC_REFLECT( fc::test::item_wrapper, (v) );
 FC_REFLECT( fc::test::item, (level)(w) );
 
+namespace fc { namespace test {
+
+   // packs a vector the slow way, one element at a time
+   template<typename T>
+   std::vector<char> pack_elementwise( const std::vector<T>& v )
+   {
+      std::vector<char> result;
+      result.resize( fc::raw::pack_size( fc::unsigned_int( v.size() ) ) + v.size() * fc::raw::pack_size( T() ) );
+      fc::datastream<char*> ds( result.data(), result.size() );
+      fc::raw::pack( ds, fc::unsigned_int( v.size() ) );
+      for( const auto& e : v )
+         fc::raw::pack( ds, e );
+      BOOST_CHECK_EQUAL( 0u, ds.remaining() );
+      return result;
+   }
+
+   template<typename T>
+   void check_trivially_packable( const std::vector<T>& v )
+   {
+      BOOST_CHECK( fc::raw::is_trivially_packable<T>::value );
+      const std::vector<char> packed = fc::raw::pack( v );
+      BOOST_CHECK( pack_elementwise( v ) == packed );
+
+      std::vector<T> unpacked;
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::raw::unpack( ds, unpacked );
+      BOOST_CHECK( v == unpacked );
+      BOOST_CHECK_EQUAL( 0u, ds.remaining() );
+
+      if( !v.empty() )
+      {
+         fc::datastream<const char*> truncated( packed.data(), packed.size() - 1 );
+         BOOST_CHECK_THROW( fc::raw::unpack( truncated, unpacked ), fc::out_of_range_exception );
+      }
+   }
+
+} } // namespace fc::test
+
 BOOST_AUTO_TEST_SUITE(fc_serialization)
 
+BOOST_AUTO_TEST_CASE( trivially_packable_vector_test )
+{ try {
+   BOOST_CHECK( !fc::raw::is_trivially_packable<bool>::value );
+   BOOST_CHECK( !fc::raw::is_trivially_packable<fc::test::item>::value );
+
+   std::vector<uint64_t> ints;
+   std::vector<int16_t> shorts;
+   std::vector<fc::sha256> hashes;
+   std::vector<fc::ripemd160> ids;
+   fc::test::check_trivially_packable( ints );
+   fc::test::check_trivially_packable( hashes );
+
+   // more than FC_MAX_PREALLOC_SIZE elements, so that unpacking has to grow the vector
+   for( uint64_t i = 0; i < 1000; i++ )
+   {
+      ints.push_back( i * 0x0101010101010101ULL );
+      shorts.push_back( int16_t(i) - 500 );
+      hashes.push_back( fc::sha256::hash( i ) );
+      ids.push_back( fc::ripemd160::hash( i ) );
+   }
+   fc::test::check_trivially_packable( ints );
+   fc::test::check_trivially_packable( shorts );
+   fc::test::check_trivially_packable( hashes );
+   fc::test::check_trivially_packable( ids );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( nested_objects_test )
 { try {
 
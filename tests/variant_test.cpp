@@ -2,6 +2,7 @@
 #include <fc/log/logger.hpp>
 
 #include <fc/container/flat.hpp>
+#include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/static_variant.hpp>
@@ -39,10 +40,41 @@ namespace fc { namespace test {
    { return ( std::tie( a.level, a.w ) < std::tie( b.level, b.w ) ); }
 
 
+   /** a struct with as many members as the larger operations and objects */
+   struct wide
+   {
+      uint64_t      f00, f02, f04, f06, f08, f10, f12, f14, f16, f18;
+      uint64_t      f20, f22, f24, f26, f28, f30, f32, f34, f36, f38;
+      uint64_t      f40, f42, f44, f46, f48;
+      std::string   f01, f03, f05, f07, f09, f11, f13, f15, f17, f19;
+      std::string   f21, f23, f25, f27, f29, f31, f33, f35, f37, f39;
+      std::string   f41, f43, f45, f47, f49;
+   };
+
 } } // namespace fc::test
 
 FC_REFLECT( fc::test::item_wrapper, (v) );
 FC_REFLECT( fc::test::item, (level)(w) );
+FC_REFLECT( fc::test::wide, (f00)(f01)(f02)(f03)(f04)(f05)(f06)(f07)(f08)(f09)
+                            (f10)(f11)(f12)(f13)(f14)(f15)(f16)(f17)(f18)(f19)
+                            (f20)(f21)(f22)(f23)(f24)(f25)(f26)(f27)(f28)(f29)
+                            (f30)(f31)(f32)(f33)(f34)(f35)(f36)(f37)(f38)(f39)
+                            (f40)(f41)(f42)(f43)(f44)(f45)(f46)(f47)(f48)(f49) );
+
+namespace {
+   void validate( const fc::test::wide& w )
+   {
+      FC_ASSERT( w.f00 == 0, "f00 must be zero, not ${v}", ("v",w.f00) );
+   }
+   void evaluate( const fc::test::wide& w )
+   { try {
+      validate( w );
+   } FC_CAPTURE_AND_RETHROW( (w) ) }
+   void apply( const fc::test::wide& w, int i )
+   { try {
+      evaluate( w );
+   } FC_CAPTURE_AND_RETHROW( (i) ) }
+}
 
 BOOST_AUTO_TEST_SUITE(fc_variant_and_log)
 
@@ -230,4 +262,282 @@ BOOST_AUTO_TEST_CASE( nested_objects_test )
 
 } FC_CAPTURE_LOG_AND_RETHROW ( (0) ) }
 
+BOOST_AUTO_TEST_CASE( short_strings_test )
+{
+   const std::string chars = "0123456789abcdefghijklmnopqrstuvwxyz";
+   for( size_t len = 0; len <= 20; ++len )
+   {
+      const std::string str = chars.substr( 0, len );
+      fc::variant v( str );
+      BOOST_CHECK_EQUAL( v.get_type(), fc::variant::string_type );
+      BOOST_CHECK( v.is_string() );
+      BOOST_CHECK_EQUAL( v.get_string(), str );
+      BOOST_CHECK_EQUAL( v.as_string(), str );
+      BOOST_CHECK( v.get_string_view() == str );
+      BOOST_CHECK( fc::variant( str.c_str() ) == v );
+
+      fc::variant copy( v );
+      fc::variant assigned = fc::variant( 1 );
+      assigned = v;
+      fc::variant moved( std::move( copy ) );
+      BOOST_CHECK( copy.is_null() );
+      BOOST_CHECK_EQUAL( moved.get_string(), str );
+      BOOST_CHECK_EQUAL( assigned.get_string(), str );
+      BOOST_CHECK_EQUAL( assigned.get_type(), fc::variant::string_type );
+      assigned = fc::variant( chars );
+      BOOST_CHECK_EQUAL( assigned.get_string(), chars );
+      BOOST_CHECK_EQUAL( v.get_string(), str );
+
+      BOOST_CHECK_EQUAL( fc::json::to_string( v ), "\"" + str + "\"" );
+      BOOST_CHECK_EQUAL( fc::json::from_string( fc::json::to_string( v ) ).get_string(), str );
+      BOOST_CHECK_EQUAL( fc::raw::unpack<fc::variant>( fc::raw::pack( v ) ).get_string(), str );
+      BOOST_CHECK_EQUAL( v.as<std::string>( 1 ), str );
+   }
+
+   BOOST_CHECK_EQUAL( fc::variant( "-12345" ).as_int64(), -12345 );
+   BOOST_CHECK_EQUAL( fc::variant( "12345" ).as_uint64(), 12345u );
+   BOOST_CHECK_EQUAL( fc::variant( "1.5" ).as_double(), 1.5 );
+   BOOST_CHECK( fc::variant( "true" ).as_bool() );
+   BOOST_CHECK( !fc::variant( "false" ).as_bool() );
+   BOOST_CHECK_THROW( fc::variant( "yes" ).as_bool(), fc::bad_cast_exception );
+   BOOST_CHECK_THROW( fc::variant( 1 ).get_string_view(), fc::bad_cast_exception );
+   BOOST_CHECK( fc::variant( "a" ) < fc::variant( "abcdefghijklmnopqrstuvwxyz" ) );
+   BOOST_CHECK( fc::variant( "1.2.345" ).as_blob().data == std::vector<char>( { '1', '.', '2', '.', '3', '4', '5' } ) );
+
+   // embedded zeros are kept
+   const std::string zeros( "a\0b\0", 4 );
+   BOOST_CHECK_EQUAL( fc::variant( zeros ).get_string(), zeros );
+}
+
+BOOST_AUTO_TEST_CASE( object_index_test )
+{
+   const size_t count = 100;
+   fc::mutable_variant_object mvo;
+   for( size_t i = 0; i < count; ++i )
+      mvo( "key" + std::to_string( i ), i );
+   // duplicates are found like by a linear search
+   mvo( "key7", 1000 );
+   BOOST_CHECK_EQUAL( mvo["key7"].as_uint64(), 7u );
+   mvo.set( "key7", 8 );
+   mvo.set( "new", 9 );
+   mvo["newer"] = 10;
+   BOOST_CHECK_EQUAL( mvo["key7"].as_uint64(), 8u );
+   BOOST_CHECK_EQUAL( mvo["new"].as_uint64(), 9u );
+   BOOST_CHECK_EQUAL( mvo["newer"].as_uint64(), 10u );
+   mvo.erase( "key0" );
+   BOOST_CHECK( mvo.find( "key0" ) == mvo.end() );
+   BOOST_CHECK_EQUAL( mvo["key1"].as_uint64(), 1u );
+   mvo.set( "key0", 11 );
+   BOOST_CHECK_EQUAL( ( mvo.end() - 1 )->key(), "key0" );
+
+   fc::variant_object vo( std::move( mvo ) );
+   for( size_t i = 1; i < count; ++i )
+   {
+      const std::string key = "key" + std::to_string( i );
+      BOOST_REQUIRE( vo.find( key ) != vo.end() );
+      BOOST_CHECK_EQUAL( vo.find( key )->key(), key );
+   }
+   BOOST_CHECK_EQUAL( vo["key0"].as_uint64(), 11u );
+   BOOST_CHECK_EQUAL( vo["key7"].as_uint64(), 8u );
+   BOOST_CHECK( vo.find( "key" ) == vo.end() );
+   BOOST_CHECK( vo.find( "key100" ) == vo.end() );
+   BOOST_CHECK_THROW( vo["missing"], fc::key_not_found_exception );
+
+   // copies and moves keep finding the right entries
+   fc::variant_object copy( vo );
+   fc::variant_object moved( std::move( vo ) );
+   BOOST_CHECK( vo.find( "key1" ) == vo.end() );
+   BOOST_CHECK_EQUAL( copy["key50"].as_uint64(), 50u );
+   BOOST_CHECK_EQUAL( moved["key50"].as_uint64(), 50u );
+   vo = std::move( moved );
+   BOOST_CHECK( moved.find( "key1" ) == moved.end() );
+   BOOST_CHECK_EQUAL( vo["key99"].as_uint64(), 99u );
+   vo = fc::mutable_variant_object( "key1", 1 );
+   BOOST_CHECK( vo.find( "key50" ) == vo.end() );
+   BOOST_CHECK_EQUAL( copy["key99"].as_uint64(), 99u );
+
+   // a struct is found in any order, and with unknown or duplicate keys
+   fc::variant v( fc::mutable_variant_object( "f00", 1 )( "f01", "a" )( "f02", 2 )( "f03", "b" ) );
+   fc::test::wide w = v.as<fc::test::wide>( 2 );
+   BOOST_CHECK_EQUAL( w.f00, 1u );
+   BOOST_CHECK_EQUAL( w.f03, "b" );
+   fc::mutable_variant_object shuffled;
+   shuffled( "f01", "x" )( "f00", 3 )( "unknown", 4 )( "f00", 5 )( "f02", 6 )( "f49", "y" );
+   w = fc::variant( shuffled ).as<fc::test::wide>( 2 );
+   BOOST_CHECK_EQUAL( w.f00, 3u );
+   BOOST_CHECK_EQUAL( w.f01, "x" );
+   BOOST_CHECK_EQUAL( w.f02, 6u );
+   BOOST_CHECK_EQUAL( w.f49, "y" );
+}
+
+BOOST_AUTO_TEST_CASE( object_index_benchmark )
+{
+   fc::test::wide w = fc::test::wide();
+   uint64_t* ints[] = { &w.f00, &w.f02, &w.f04, &w.f06, &w.f08, &w.f10, &w.f12, &w.f14, &w.f16, &w.f18,
+                        &w.f20, &w.f22, &w.f24, &w.f26, &w.f28, &w.f30, &w.f32, &w.f34, &w.f36, &w.f38,
+                        &w.f40, &w.f42, &w.f44, &w.f46, &w.f48 };
+   for( size_t i = 0; i < 25; ++i )
+      *ints[i] = i * 1000;
+   w.f49 = "last";
+   const fc::variant in_order( w, 2 );
+   fc::mutable_variant_object reversed;
+   const fc::variant_object& obj = in_order.get_object();
+   for( auto itr = obj.end(); itr != obj.begin(); --itr )
+      reversed( ( itr - 1 )->key(), ( itr - 1 )->value() );
+   const fc::variant out_of_order( reversed );
+
+   const size_t rounds = 20000;
+   for( const auto& input : { std::make_pair( "in member order", &in_order ),
+                              std::make_pair( "in reversed order", &out_of_order ) } )
+   {
+      uint64_t sum = 0;
+      const fc::time_point start = fc::time_point::now();
+      for( size_t i = 0; i < rounds; ++i )
+         sum += input.second->as<fc::test::wide>( 2 ).f48;
+      const fc::microseconds elapsed = fc::time_point::now() - start;
+      BOOST_CHECK_EQUAL( sum, rounds * 24000 );
+      ilog( "from_variant of 50 members ${o}: ${t} ns", ("o",input.first)("t",elapsed.count() * 1000 / rounds) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( shared_array_test )
+{
+   fc::variants items;
+   for( int i = 0; i < 10; ++i )
+      items.push_back( fc::variant( i ) );
+   const fc::variant original( items );
+   fc::variant copy( original );
+   fc::variant assigned;
+   assigned = original;
+   BOOST_CHECK( &static_cast<const fc::variant&>( copy ).get_array() == &original.get_array() );
+   BOOST_CHECK( &static_cast<const fc::variant&>( assigned ).get_array() == &original.get_array() );
+
+   // mutable access copies a shared array first
+   copy.get_array().push_back( fc::variant( 10 ) );
+   BOOST_CHECK_EQUAL( copy.size(), 11u );
+   BOOST_CHECK_EQUAL( original.size(), 10u );
+   BOOST_CHECK_EQUAL( assigned.size(), 10u );
+   assigned.get_array()[0] = fc::variant( "changed" );
+   BOOST_CHECK_EQUAL( original[size_t(0)].as_int64(), 0 );
+
+   // an array which can be changed through a reference is not shared
+   fc::variant unique( items );
+   fc::variants& ref = unique.get_array();
+   fc::variant copy_of_unique( unique );
+   ref.push_back( fc::variant( 10 ) );
+   BOOST_CHECK_EQUAL( unique.size(), 11u );
+   BOOST_CHECK_EQUAL( copy_of_unique.size(), 10u );
+
+   fc::variant moved( std::move( copy ) );
+   BOOST_CHECK( copy.is_null() );
+   BOOST_CHECK_EQUAL( moved.size(), 11u );
+   copy = moved;
+   moved.clear();
+   BOOST_CHECK_EQUAL( copy.size(), 11u );
+
+   const fc::blob data{ std::vector<char>( 100, 'x' ) };
+   const fc::variant b( data );
+   fc::variant b2( b );
+   BOOST_CHECK( &b2.get_blob() != &b.get_blob() );
+   BOOST_CHECK( b2.get_blob().data == data.data );
+   b2.get_blob().data[0] = 'y';
+   BOOST_CHECK_EQUAL( b.get_blob().data[0], 'x' );
+   BOOST_CHECK_EQUAL( b2.as_blob().data[0], 'y' );
+   fc::variant b3;
+   b3 = b;
+   BOOST_CHECK( &static_cast<const fc::variant&>( b3 ).get_blob() == &b.get_blob() );
+   BOOST_CHECK( b3.as_blob().data == data.data );
+}
+
+BOOST_AUTO_TEST_CASE( shared_array_benchmark )
+{
+   // a get_objects style response, which the api layers pass on by value
+   fc::variants objects;
+   for( int i = 0; i < 10000; ++i )
+      objects.push_back( fc::mutable_variant_object( "id", "1.2." + std::to_string( i ) )
+                            ( "balances", fc::variants( 20, fc::variant( i ) ) )
+                            ( "name", "account-" + std::to_string( i ) ) );
+   const fc::variant response( objects );
+
+   const size_t layers = 5;
+   const fc::time_point start = fc::time_point::now();
+   std::vector<fc::variant> copies( 1, response );
+   for( size_t i = 1; i < layers; ++i )
+      copies.push_back( copies.back() );
+   const fc::microseconds copy_time = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( copies.back().size(), objects.size() );
+
+   const fc::time_point json_start = fc::time_point::now();
+   const std::string json = fc::json::to_string( copies.back() );
+   const fc::microseconds json_time = fc::time_point::now() - json_start;
+   ilog( "${l} copies of ${n} objects: ${c} us, to_string afterwards ${j} us",
+         ("l",layers)("n",objects.size())("c",copy_time.count())("j",json_time.count()) );
+}
+
+BOOST_AUTO_TEST_CASE( lazy_log_args_test )
+{
+   char buffer[16] = "before";
+   std::vector<int> values{ 1, 2 };
+   auto shared = std::make_shared<std::string>( "before" );
+   const fc::log_message m = FC_LAZY_LOG_MESSAGE( error, "${b} ${v} ${s}",
+                                                  ("b",buffer)("v",values)("s",shared)("p",(const char*)buffer) );
+   // values are copied when the message is created, except for those which only refer to them
+   strcpy( buffer, "after" );
+   values.push_back( 3 );
+   *shared = "after";
+   BOOST_CHECK_EQUAL( m.get_message(), "before [1,2] before" );
+   BOOST_CHECK_EQUAL( m.get_data()["p"].as_string(), "before" );
+   BOOST_CHECK_EQUAL( m.get_data().size(), 4u );
+
+   const fc::log_message eager = FC_LOG_MESSAGE( error, "${b} ${v} ${s}", ("b",buffer)("v",values)("s",shared) );
+   const fc::log_message lazy = FC_LAZY_LOG_MESSAGE( error, "${b} ${v} ${s}", ("b",buffer)("v",values)("s",shared) );
+   BOOST_CHECK_EQUAL( fc::json::to_string( lazy.get_data() ), fc::json::to_string( eager.get_data() ) );
+   BOOST_CHECK_EQUAL( fc::json::to_string( fc::variant( lazy, 10 )["data"] ),
+                      fc::json::to_string( fc::variant( eager, 10 )["data"] ) );
+}
+
+BOOST_AUTO_TEST_CASE( exception_benchmark )
+{
+   fc::test::wide w = fc::test::wide();
+   w.f00 = 1;
+   w.f49 = "last";
+
+   const int rounds = 20000;
+   int caught = 0;
+   const fc::time_point start = fc::time_point::now();
+   for( int i = 0; i < rounds; ++i )
+   {
+      try
+      {
+         apply( w, i );
+      }
+      catch( const fc::assert_exception& )
+      {
+         ++caught;
+      }
+   }
+   const fc::microseconds elapsed = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( caught, rounds );
+   ilog( "throw and catch through two FC_CAPTURE_AND_RETHROW: ${t} ns", ("t",elapsed.count() * 1000 / rounds) );
+
+   // the captured values are converted when the exception is reported
+   try
+   {
+      apply( w, 7 );
+   }
+   catch( const fc::exception& e )
+   {
+      BOOST_REQUIRE_EQUAL( e.get_log().size(), 3u );
+      BOOST_CHECK_EQUAL( e.get_log()[0].get_message(), "w.f00 == 0: f00 must be zero, not 1" );
+      BOOST_CHECK_EQUAL( e.get_log()[1].get_data()["w"]["f49"].as_string(), "last" );
+      BOOST_CHECK_EQUAL( e.get_log()[2].get_data()["i"].as_int64(), 7 );
+      const std::string details = e.to_detail_string();
+      BOOST_CHECK( details.find( "f00 must be zero, not 1" ) != std::string::npos );
+      BOOST_CHECK( details.find( "\"f49\":\"last\"" ) != std::string::npos );
+      const fc::exception copy = fc::variant( e, 10 ).as<fc::exception>( 10 );
+      BOOST_CHECK_EQUAL( copy.get_log()[1].get_data()["w"]["f49"].as_string(), "last" );
+      BOOST_CHECK_EQUAL( copy.to_detail_string(), details );
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()